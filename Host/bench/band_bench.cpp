@@ -0,0 +1,161 @@
+/*
+ *	"band_bench.cpp"
+ *
+ *	Benchmark for "FindBand()" (see "bands.cpp"), which "CheckFreq()" uses to find
+ *	the band a CAT frequency is in. For band tables of several sizes up to the 255
+ *	entries "bandData" can have, it looks up the same random frequencies (in the
+ *	bands, between them and outside all of them) by looking through the table the
+ *	old way and with the index "IndexBands()" makes, and reports the time per
+ *	lookup for each. Both ways have to find the same band every time.
+ *
+ *	It also checks that "IndexBands()" turns down tables with overlapping bands or
+ *	a band with its edges the wrong way round.
+ *
+ *	Usage:	band_bench [--lookups n]
+ *
+ *	The times are host times; the ESP32 is a lot slower.
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "config.h"
+#include "bands.h"
+
+void setup ( void ) {}						// The sketch isn't part of this
+void loop ( void ) {}
+
+typedef std::chrono::steady_clock Clock;
+
+static int	bad = 0;
+
+
+/*
+ *	"MakeBands()" makes a table of "count" bands 20KHz to 500KHz wide with gaps of up
+ *	to 1MHz between them, in a shuffled order.
+ */
+
+static std::vector<band_data> MakeBands ( int count )
+{
+	std::vector<band_data>	bands ( count );
+	uint32_t				freq = 1800000;
+
+	for ( int ix = 0; ix < count; ix++ )
+	{
+		memset ( &bands[ix], 0, sizeof ( band_data ));
+
+		bands[ix].lowLimit = freq;
+		bands[ix].topLimit = freq + 20000 + rand () % 480000;
+		freq = bands[ix].topLimit + 1 + rand () % 1000000;
+	}
+
+	for ( int ix = count - 1; ix > 0; ix-- )
+		std::swap ( bands[ix], bands[rand () % ( ix + 1 )] );
+
+	return bands;
+}
+
+
+/*
+ *	"Time()" does all the lookups and returns the time per lookup in nanoseconds.
+ *	The answers are added up so the compiler can't skip them.
+ */
+
+static double Time ( const std::vector<band_data>& bands, const uint8_t* order,
+						const std::vector<uint32_t>& freqs, std::vector<int>& found )
+{
+	Clock::time_point	start = Clock::now ();
+
+	for ( size_t ix = 0; ix < freqs.size (); ix++ )
+		found[ix] = FindBand ( bands.data (), order, bands.size (), freqs[ix] );
+
+	double	ns = std::chrono::duration<double, std::nano> ( Clock::now () - start ).count ();
+
+	return ns / freqs.size ();
+}
+
+
+int main ( int argc, char* argv[] )
+{
+	int		lookups = 2000000;
+
+	for ( int ix = 1; ix < argc; ix++ )
+	{
+		if (( strcmp ( argv[ix], "--lookups" ) == 0 ) && ( ix + 1 < argc ))
+			lookups = atoi ( argv[++ix] );
+
+		else
+		{
+			fprintf ( stderr, "Usage: %s [--lookups n]\n", argv[0] );
+			return 2;
+		}
+	}
+
+	HostSerialQuiet ( true );
+	srand ( 1 );
+
+	static const int	sizes[] = { 1, 8, 32, 128, 255 };
+
+	printf ( "%6s %12s %12s %8s\n", "Bands", "Linear ns", "Indexed ns", "In band" );
+
+	for ( int count : sizes )
+	{
+		std::vector<band_data>	bands = MakeBands ( count );
+		std::vector<uint8_t>	order ( count );
+		std::vector<uint32_t>	freqs ( lookups );
+		std::vector<int>		linear ( lookups ), indexed ( lookups );
+		uint32_t				top = 0;
+		int						inBand = 0;
+
+		for ( const band_data& b : bands )
+			top = max ( top, b.topLimit );
+
+		for ( int ix = 0; ix < lookups; ix++ )
+			freqs[ix] = 1000000 + (uint32_t) ((( (uint64_t) rand () << 16 ) ^ rand ()) % ( top + 1000000 ));
+
+		if ( !IndexBands ( bands.data (), count, order.data ()) && bad++ < 10 )
+			printf ( "%d bands that don't overlap were turned down\n", count );
+
+		double	linearNs  = Time ( bands, NULL,         freqs, linear );
+		double	indexedNs = Time ( bands, order.data (), freqs, indexed );
+
+		for ( int ix = 0; ix < lookups; ix++ )
+		{
+			if ( linear[ix] >= 0 )
+				inBand++;
+
+			if (( linear[ix] != indexed[ix] ) && bad++ < 10 )
+				printf ( "%u: band %d looking through them, %d with the index\n",
+							freqs[ix], linear[ix], indexed[ix] );
+		}
+
+		printf ( "%6d %12.1f %12.1f %7.1f%%\n", count, linearNs, indexedNs, 100.0 * inBand / lookups );
+	}
+
+
+/*
+ *	Tables that "IndexBands()" has to turn down:
+ */
+
+	std::vector<band_data>	bands = MakeBands ( 10 );
+	std::vector<uint8_t>	order ( 10 );
+
+	bands[3].topLimit = bands[3].lowLimit - 1;				// Edges the wrong way round
+
+	if ( IndexBands ( bands.data (), 10, order.data ()) && bad++ < 10 )
+		printf ( "A band with its edges the wrong way round wasn't noticed\n" );
+
+	bands = MakeBands ( 10 );
+	bands[7] = bands[2];									// The same band twice
+	bands[7].lowLimit += 1000;
+
+	if ( IndexBands ( bands.data (), 10, order.data ()) && bad++ < 10 )
+		printf ( "Overlapping bands weren't noticed\n" );
+
+	if ( FindBand ( bands.data (), NULL, 10, bands[7].lowLimit ) != 2 && bad++ < 10 )
+		printf ( "Overlapping bands should find the first one\n" );
+
+	printf ( "\n%d problems\n", bad );
+
+	return bad ? 1 : 0;
+}
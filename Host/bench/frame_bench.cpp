@@ -0,0 +1,340 @@
+/*
+ *	"frame_bench.cpp"
+ *
+ *	Benchmark for the complete frame painting sequence that "loop()" goes through
+ *	every time "changed.Disp" is set:
+ *
+ *		Clear			Clear the screen around the text that stays the same
+ *						("TextClear()")
+ *		Dial			Paint the dial for "rxFreq"
+ *		Overlay			"StartDamage()", "SetOverlay()" and "PaintOverlay()"; box,
+ *						VFO-A/VFO-B, mode, split, etc. and "EndDamage()"
+ *		Transfer		"Transfer_Image()" and "Transfer_Done()"; the time core 0
+ *						spends sending it to the (host) display
+ *
+ *	It sweeps the frequency up from the bottom of the active band by "--step" Hz per
+ *	frame and reports the time for each stage, the frame rate and the number of
+ *	memory allocations. The program is built once for each "DISP_SIZE" (see
+ *	"CMakeLists.txt"), so the profile being measured is the one it was compiled with.
+ *
+ *	Usage:	frame_bench_<size> [--frames n] [--step hz] [--xmit] [--paint-us n] [--ppm file]
+ *								[--no-dma-memory]
+ *
+ *	"--xmit" flips the TX/RX indicator every frame; with "--step 0" that shows how much
+ *	gets sent to the display for a change that doesn't involve the dial.
+ *
+ *	"--no-dma-memory" makes "heap_caps_malloc()" fail, so "InitDisplay()" can't get the
+ *	DMA buffers and the screens are sent the way they are without "DISPLAY_DMA". The
+ *	checksum has to be the same.
+ *
+ *	The "Frame checksum" is a hash of what ended up on the display after every frame;
+ *	rendering changes that aren't supposed to change the picture must not change it.
+ *
+ *	The frames go through the same two copies of the screen image as they do in the
+ *	VFO; while one frame is being sent, the next one is painted. "Transfer_Done()" is
+ *	called once every simulated millisecond, the way "task0()" does it. The host
+ *	display takes as long to send things as a real one would (in simulated time),
+ *	and "--paint-us" says how long painting a frame takes in simulated time, so the
+ *	simulated frame time shows how well painting and sending overlap. Compare
+ *	"frame_bench_large" with "frame_bench_large_sync", which is built without the DMA.
+ *
+ *	Note that the stage times are host times; the ESP32 is a lot slower, but the relative
+ *	cost of each stage is what we're usually after.
+ */
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <esp_heap_caps.h>
+#include <chrono>
+#include <new>
+#include "config.h"
+#include "display.h"
+#include "graph.h"
+#include "dial.h"
+#include "damage.h"
+#include "text.h"
+
+
+/*
+ *	Things in the VFO program we need:
+ */
+
+extern band_data	bandData[];
+extern uint8_t		activeBand;
+extern uint32_t		rxFreq;
+extern ctl_flags	changed;
+extern volatile uint8_t	xmitStatus;
+extern TFT_eSPI		tft;
+
+void SetOverlay ( float battVolts );
+void PaintOverlay ();
+
+extern uint32_t		textKept;
+extern uint32_t		textPainted;
+
+#if DIAL_CACHE
+	extern uint32_t	dialCacheHits;
+	extern uint32_t	dialCacheMisses;
+
+	#if DIAL_SCROLL
+		extern uint32_t	dialScrolls;
+	#endif
+#endif
+
+
+/*
+ *	Count every "new" as well as the "ps_malloc()" calls the shim already counts:
+ */
+
+static uint32_t newCount = 0;
+
+void* operator new ( size_t size )
+{
+	newCount++;
+
+	void* p = malloc ( size ? size : 1 );
+
+	if ( !p )
+		throw std::bad_alloc ();
+
+	return p;
+}
+
+void operator delete ( void* p ) noexcept { free ( p ); }
+void operator delete ( void* p, size_t ) noexcept { free ( p ); }
+
+
+/*
+ *	Stage timing:
+ */
+
+enum { ST_FILL, ST_DIAL, ST_OVERLAY, ST_TRANSFER, NBR_STAGES };
+
+static const char* stageName[NBR_STAGES] =
+	{ "Clear", "Dial", "Overlay", "Transfer" };
+
+struct StageTime
+{
+	double	total;						// Microseconds
+	double	min;
+	double	max;
+};
+
+static StageTime	stage[NBR_STAGES];
+static double		xferUs;				// Core 0 time in the current frame
+
+typedef std::chrono::steady_clock Clock;
+
+static inline double Since ( Clock::time_point& t )
+{
+	Clock::time_point now = Clock::now ();
+	double us = std::chrono::duration<double, std::micro> ( now - t ).count ();
+
+	t = now;
+	return us;
+}
+
+static void Record ( int s, double us )
+{
+	stage[s].total += us;
+
+	if ( us < stage[s].min )  stage[s].min = us;
+	if ( us > stage[s].max )  stage[s].max = us;
+}
+
+
+/*
+ *	"Pump()" is what "task0()" does to keep the display going. "Core0()" lets "us"
+ *	microseconds of simulated time go by with "Pump()" being called every millisecond.
+ */
+
+static bool Pump ( void )
+{
+	Clock::time_point t = Clock::now ();
+	bool done = Transfer_Done ();
+
+	xferUs += Since ( t );
+	return done;
+}
+
+static void Core0 ( uint32_t us )
+{
+	while ( us >= 1000 )
+	{
+		Pump ();
+		HostAdvanceUs ( 1000 );
+		us -= 1000;
+	}
+
+	HostAdvanceUs ( us );
+}
+
+static void WaitForDisplay ( void )
+{
+	while ( !Pump ())
+		HostAdvanceUs ( 1000 );
+}
+
+
+static const char* ProfileName ( void )
+{
+	switch ( DISP_SIZE )
+	{
+		case SMALL_DISP:	return "SMALL_DISP";
+		case LARGE_DISP:	return "LARGE_DISP";
+		case CUSTOM_DISP:	return "CUSTOM_DISP";
+		case FT7_DISP:		return "FT7_DISP";
+	}
+
+	return "?";
+}
+
+
+int main ( int argc, char* argv[] )
+{
+	int			frames  = 500;
+	int32_t		step    = 100;
+	const char*	ppmFile = NULL;
+	bool		xmit    = false;
+	uint32_t	paintUs = 0;
+	bool		noDmaMem = false;
+
+	for ( int ix = 1; ix < argc; ix++ )
+	{
+		if (( strcmp ( argv[ix], "--frames" ) == 0 ) && ( ix + 1 < argc ))
+			frames = atoi ( argv[++ix] );
+
+		else if (( strcmp ( argv[ix], "--step" ) == 0 ) && ( ix + 1 < argc ))
+			step = atol ( argv[++ix] );
+
+		else if ( strcmp ( argv[ix], "--xmit" ) == 0 )
+			xmit = true;
+
+		else if (( strcmp ( argv[ix], "--paint-us" ) == 0 ) && ( ix + 1 < argc ))
+			paintUs = atol ( argv[++ix] );
+
+		else if (( strcmp ( argv[ix], "--ppm" ) == 0 ) && ( ix + 1 < argc ))
+			ppmFile = argv[++ix];
+
+		else if ( strcmp ( argv[ix], "--no-dma-memory" ) == 0 )
+			noDmaMem = true;
+
+		else
+		{
+			fprintf ( stderr, "Usage: %s [--frames n] [--step hz] [--xmit] [--paint-us n] [--ppm file]"
+								" [--no-dma-memory]\n", argv[0] );
+			return 2;
+		}
+	}
+
+	if ( frames <= 0 )
+		frames = 1;
+
+	HostSerialQuiet ( true );
+	HostDmaMemoryFull ( noDmaMem );
+	setup ();
+
+	HostAllocStats	setupAlloc = hostAlloc;
+	uint32_t		setupNew   = newCount;
+	uint32_t		checksum   = 0;
+	uint64_t		setupPixels = tft.stats.pixels;
+	uint64_t		setupBusy   = tft.stats.busyNs;
+	uint64_t		setupWait   = tft.stats.waitNs;
+	uint64_t		setupNs     = HostNowNs ();
+
+	for ( int s = 0; s < NBR_STAGES; s++ )
+	{
+		stage[s].total = 0;
+		stage[s].min   = 1e30;
+		stage[s].max   = 0;
+	}
+
+	uint32_t	low  = bandData[activeBand].lowLimit;
+	uint32_t	span = bandData[activeBand].topLimit - low;
+	Clock::time_point	start = Clock::now ();
+
+	for ( int f = 0; f < frames; f++ )
+	{
+		rxFreq = low + (uint32_t) (( (uint64_t) f * step ) % span );
+		bandData[activeBand].vfoA = rxFreq;
+
+		if ( xmit )
+			xmitStatus = f & 1;
+
+		Clock::time_point t = Clock::now ();
+
+		StartDamage ();
+		SetOverlay ( 0.0 );								double setUs = Since ( t );
+		TextClear ( CL_BG );							Record ( ST_FILL,     Since ( t ));
+		Dial ( rxFreq );								Record ( ST_DIAL,     Since ( t ));
+		PaintOverlay ();
+		EndDamage ();									Record ( ST_OVERLAY,  setUs + Since ( t ));
+
+		xferUs = 0;
+		Core0 ( paintUs );								// Last frame goes out meanwhile
+		WaitForDisplay ();
+
+		if ( f > 0 )									// Last frame is all there now
+			checksum = ( checksum * 31 ) ^ HostTftChecksum ( tft, DISP_W, DISP_H );
+
+		t = Clock::now ();
+		Transfer_Image ();
+		xferUs += Since ( t );							Record ( ST_TRANSFER, xferUs );
+	}
+
+	WaitForDisplay ();
+	checksum = ( checksum * 31 ) ^ HostTftChecksum ( tft, DISP_W, DISP_H );
+
+	double	wall = Since ( start );
+	double	sum  = 0;
+
+	for ( int s = 0; s < NBR_STAGES; s++ )
+		sum += stage[s].total;
+
+	printf ( "Profile %s (%dx%d), %d frames, %d Hz per frame\n\n",
+				ProfileName (), DISP_W, DISP_H, frames, step );
+
+	printf ( "  %-10s %10s %10s %10s %7s\n", "Stage", "avg us", "min us", "max us", "share" );
+
+	for ( int s = 0; s < NBR_STAGES; s++ )
+		printf ( "  %-10s %10.1f %10.1f %10.1f %6.1f%%\n", stageName[s],
+					stage[s].total / frames, stage[s].min, stage[s].max,
+					100.0 * stage[s].total / sum );
+
+	printf ( "  %-10s %10.1f\n\n", "Frame", sum / frames );
+	printf ( "  Frames/second:        %.1f\n", 1e6 * frames / sum );
+	printf ( "  Pixels sent:          %llu (%.0f per frame)\n",
+				(unsigned long long) tft.stats.pixels,
+				(double) ( tft.stats.pixels - setupPixels ) / frames );
+	printf ( "  SPI busy:             %.1f us per frame (simulated)\n",
+				( tft.stats.busyNs - setupBusy ) / 1e3 / frames );
+	printf ( "  Core 0 waiting:       %.1f us per frame (simulated)\n",
+				( tft.stats.waitNs - setupWait ) / 1e3 / frames );
+	printf ( "  Frame time:           %.1f us (simulated, painting %u us)\n",
+				( HostNowNs () - setupNs ) / 1e3 / frames, paintUs );
+	printf ( "  Setup allocations:    %u ps_malloc (%zu bytes), %u new\n",
+				setupAlloc.count, setupAlloc.bytes, setupNew );
+	printf ( "  Sweep allocations:    %u ps_malloc, %u new\n",
+				hostAlloc.count - setupAlloc.count, newCount - setupNew );
+
+	#if DIAL_CACHE
+		printf ( "  Dial cache:           %u hits, %u misses\n", dialCacheHits, dialCacheMisses );
+
+		#if DIAL_SCROLL
+			printf ( "  Dial scrolls:         %u\n", dialScrolls );
+		#endif
+	#endif
+
+	printf ( "  Text characters:      %u kept, %u painted\n", textKept, textPainted );
+	printf ( "  Frame checksum:       %08x\n", checksum );
+
+	printf ( "  Wall time:            %.1f ms\n", wall / 1000 );
+
+	if ( ppmFile && !HostTftSavePPM ( tft, ppmFile, DISP_W, DISP_H ))
+	{
+		fprintf ( stderr, "Can't write %s\n", ppmFile );
+		return 1;
+	}
+
+	return 0;
+}
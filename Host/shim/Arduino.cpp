@@ -0,0 +1,617 @@
+/*
+ *	"Arduino.cpp" (host shim)
+ *
+ *	Implementation of the host stand-ins for the Arduino core, the ESP32 PSRAM
+ *	allocator and the little bit of FreeRTOS the VFO program uses. See "Arduino.h"
+ *	for the general idea.
+ */
+
+#include <Arduino.h>
+#include <soc/gpio_struct.h>
+#include <esp_heap_caps.h>
+#include <stdarg.h>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+/*
+ *	The simulated clock:
+ */
+
+static uint64_t	nowNs = 0;					// Simulated time in nanoseconds
+
+uint64_t HostNowNs ( void ) { return nowNs; }
+void HostAdvanceNs ( uint64_t ns ) { nowNs += ns; }
+void HostAdvanceUs ( uint64_t us ) { nowNs += us * 1000ULL; }
+
+uint32_t millis ( void )
+{
+	nowNs += HOST_CLOCK_READ_NS;
+	return (uint32_t) ( nowNs / 1000000ULL );
+}
+
+uint32_t micros ( void )
+{
+	nowNs += HOST_CLOCK_READ_NS;
+	return (uint32_t) ( nowNs / 1000ULL );
+}
+
+void delayMicroseconds ( uint32_t us ) { nowNs += us * 1000ULL; }
+void yield ( void ) {}
+
+
+/*
+ *	Tasks. Each task gets a real thread, but a "baton" makes sure only one thread
+ *	(the main thread or one task) runs at any time. "running" points to the task
+ *	holding the baton; NULL means the main thread has it.
+ */
+
+struct HostTask
+{
+	TaskFunction_t	code;
+	void*			params;
+	const char*		name;
+	uint64_t		wakeNs;					// Simulated time it wants to run again
+	bool			finished;				// Task function returned
+	uint32_t		notify;					// Notification count
+	bool			notifyWait;				// Waiting in "ulTaskNotifyTake()"
+	std::thread		thread;
+};
+
+/*
+ *	The lock and condition variable are never destroyed; tasks are still waiting on
+ *	them when the program exits, and destroying them would hang.
+ */
+
+static std::mutex&					batonLock = *new std::mutex;
+static std::condition_variable&		batonCV   = *new std::condition_variable;
+static HostTask*					running = NULL;
+static thread_local HostTask*		self    = NULL;
+static std::vector<HostTask*>		tasks;
+
+/*
+ *	"mainTask" stands for the task that runs "loop()" (the main thread), so it can
+ *	sleep in "ulTaskNotifyTake()" and be woken up like the others. It isn't in
+ *	"tasks".
+ */
+
+static HostTask						mainTask;
+
+
+/*
+ *	"TaskBody()" is the thread function for every task. It waits for the baton
+ *	before calling the real task function.
+ */
+
+static void TaskBody ( HostTask* t )
+{
+	self = t;
+
+	{
+		std::unique_lock<std::mutex> lk ( batonLock );
+		batonCV.wait ( lk, [t] { return running == t; });
+	}
+
+	t->code ( t->params );
+
+	std::lock_guard<std::mutex> lk ( batonLock );	// Task function returned
+	t->finished = true;
+	running = NULL;
+	batonCV.notify_all ();
+}
+
+
+/*
+ *	"TaskBlock()" is called from a task's own thread to give the baton back to the
+ *	main thread until the simulated clock reaches "wakeNs".
+ */
+
+static void TaskBlock ( uint64_t wakeNs )
+{
+	std::unique_lock<std::mutex> lk ( batonLock );
+
+	self->wakeNs = wakeNs;
+	running = NULL;
+	batonCV.notify_all ();
+	batonCV.wait ( lk, [] { return running == self; });
+}
+
+
+/*
+ *	"RunTask()" is called from the main thread to hand the baton to a task and
+ *	wait for it to come back.
+ */
+
+static void RunTask ( HostTask* t )
+{
+	std::unique_lock<std::mutex> lk ( batonLock );
+
+	running = t;
+	batonCV.notify_all ();
+	batonCV.wait ( lk, [] { return running == NULL; });
+}
+
+
+BaseType_t xTaskCreatePinnedToCore ( TaskFunction_t code, const char* name,
+									 uint32_t stackDepth, void* params,
+									 UBaseType_t priority, TaskHandle_t* handle,
+									 BaseType_t coreID )
+{
+	HostTask* t = new HostTask;
+
+	(void) stackDepth;						// One thread per task does for
+	(void) priority;						// all of these
+	(void) coreID;
+
+	t->code     = code;
+	t->params   = params;
+	t->name     = name;
+	t->wakeNs   = nowNs;					// Ready to run now
+	t->finished = false;
+	t->notify   = 0;
+	t->notifyWait = false;
+	t->thread   = std::thread ( TaskBody, t );
+	t->thread.detach ();					// Never joined; blocked tasks die with the process
+
+	tasks.push_back ( t );
+
+	if ( handle )
+		*handle = t;
+
+	return pdPASS;
+}
+
+
+int HostRunTasks ( void )
+{
+	int count = 0;
+
+	if ( self )								// Tasks don't run other tasks
+		return 0;
+
+	for ( size_t ix = 0; ix < tasks.size (); ix++ )
+	{
+		HostTask* t = tasks[ix];
+
+		if ( !t->finished && ( t->wakeNs <= nowNs ))
+		{
+			RunTask ( t );
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
+/*
+ *	"NextWake()" returns the earliest wake-up time of any task, or "UINT64_MAX" if
+ *	there aren't any.
+ */
+
+static uint64_t NextWake ( void )
+{
+	uint64_t next = UINT64_MAX;
+
+	for ( size_t ix = 0; ix < tasks.size (); ix++ )
+		if ( !tasks[ix]->finished && ( tasks[ix]->wakeNs < next ))
+			next = tasks[ix]->wakeNs;
+
+	return next;
+}
+
+
+/*
+ *	"AdvanceTo()" moves the main thread's clock to "targetNs", running any tasks
+ *	that become due along the way.
+ */
+
+static void AdvanceTo ( uint64_t targetNs )
+{
+	HostRunTasks ();
+
+	while ( nowNs < targetNs )
+	{
+		uint64_t next = NextWake ();
+
+		if ( next > targetNs )
+			nowNs = targetNs;
+
+		else if ( next > nowNs )
+			nowNs = next;
+
+		HostRunTasks ();
+	}
+}
+
+
+/*
+ *	"delay()" from a task blocks the task; from the main thread it lets the tasks
+ *	run while the simulated time passes.
+ */
+
+void delay ( uint32_t ms )
+{
+	uint64_t target = nowNs + ms * 1000000ULL;
+
+	if ( self )
+		TaskBlock ( target );
+	else
+		AdvanceTo ( target );
+}
+
+void vTaskDelay ( TickType_t ticks ) { delay ( ticks * portTICK_PERIOD_MS ); }
+
+
+/*
+ *	Task notifications. Only the count ("ulTaskNotifyTake()" and the "Give"
+ *	functions) is done. A task waiting for one gives the baton back like "delay()"
+ *	does; a notification moves its wake-up time to now so it runs the next time the
+ *	main thread lets the tasks run.
+ */
+
+TaskHandle_t xTaskGetCurrentTaskHandle ( void ) { return self ? self : &mainTask; }
+
+/*
+ *	The main thread can't block in the middle of "loop()", so when "loop()" waits for
+ *	a notification it returns straight away, and "HostStep()" doesn't call "loop()"
+ *	again until the wait would have ended or a notification comes.
+ */
+
+uint32_t ulTaskNotifyTake ( BaseType_t clearOnExit, TickType_t ticks )
+{
+	uint32_t value;
+	uint64_t wakeNs = ( ticks == portMAX_DELAY ) ? UINT64_MAX
+						: nowNs + ticks * portTICK_PERIOD_MS * 1000000ULL;
+
+	if ( self && ( self->notify == 0 ) && ( ticks > 0 ))
+	{
+		self->notifyWait = true;
+		TaskBlock ( wakeNs );
+		self->notifyWait = false;
+	}
+
+	if ( !self && ( mainTask.notify == 0 ) && ( ticks > 0 ))
+	{
+		mainTask.notifyWait = true;
+		mainTask.wakeNs     = wakeNs;
+		return 0;
+	}
+
+	HostTask* t = self ? self : &mainTask;
+
+	value = t->notify;
+
+	if ( clearOnExit )
+		t->notify = 0;
+
+	else if ( value )
+		t->notify--;
+
+	return value;
+}
+
+BaseType_t xTaskNotifyGive ( TaskHandle_t task )
+{
+	task->notify++;
+
+	if ( task->notifyWait && ( task->wakeNs > nowNs ))
+		task->wakeNs = nowNs;
+
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR ( TaskHandle_t task, BaseType_t* woken )
+{
+	xTaskNotifyGive ( task );
+
+	if ( woken )
+		*woken = pdTRUE;
+}
+
+TickType_t xTaskGetTickCount ( void ) { return (TickType_t) ( nowNs / 1000000ULL ); }
+BaseType_t xPortGetCoreID ( void ) { return self ? 0 : 1; }
+
+
+/*
+ *	"HostStep()" is one pass through "loop()" followed by "us" microseconds of
+ *	simulated time, during which the tasks run as they fall due. If "loop()" is
+ *	sleeping, the pass is skipped.
+ */
+
+void HostStep ( uint32_t us )
+{
+	if ( mainTask.wakeNs <= nowNs )
+	{
+		mainTask.notifyWait = false;
+		loop ();
+	}
+
+
+	AdvanceTo ( nowNs + us * 1000ULL );
+}
+
+void HostRunFor ( uint32_t us )
+{
+	uint64_t end = nowNs + us * 1000ULL;
+
+	while ( nowNs < end )
+	{
+		uint64_t left = ( end - nowNs ) / 1000ULL;
+		HostStep ( left > 1000 ? 1000 : (uint32_t) left );
+
+		if ( left == 0 )
+			break;
+	}
+}
+
+
+/*
+ *	GPIO pins and interrupts:
+ */
+
+static uint8_t			pinLevel[HOST_NUM_PINS];
+static uint16_t			pinAnalog[HOST_NUM_PINS];
+static void				( *pinISR[HOST_NUM_PINS] )( void );
+static int				pinISRMode[HOST_NUM_PINS];
+static HostPinObserver	pinObserver = NULL;
+
+static struct PinInit					// Pins float high and read mid-scale
+{
+	PinInit ()
+	{
+		for ( int ix = 0; ix < HOST_NUM_PINS; ix++ )
+		{
+			pinLevel[ix]  = HIGH;
+			pinAnalog[ix] = 2048;
+		}
+	}
+} pinInit;
+
+
+void pinMode ( uint8_t, uint8_t ) {}
+
+void digitalWrite ( uint8_t pin, uint8_t val )
+{
+	if ( pin >= HOST_NUM_PINS )
+		return;
+
+	pinLevel[pin] = val ? HIGH : LOW;
+
+	if ( pinObserver )
+		pinObserver ( pin, pinLevel[pin], nowNs );
+}
+
+int digitalRead ( uint8_t pin )
+{
+	return ( pin < HOST_NUM_PINS ) ? pinLevel[pin] : LOW;
+}
+
+uint16_t analogRead ( uint8_t pin )
+{
+	return ( pin < HOST_NUM_PINS ) ? pinAnalog[pin] : 0;
+}
+
+void attachInterrupt ( uint8_t pin, void ( *isr )( void ), int mode )
+{
+	if ( pin >= HOST_NUM_PINS )
+		return;
+
+	pinISR[pin]     = isr;
+	pinISRMode[pin] = mode;
+}
+
+void detachInterrupt ( uint8_t pin )
+{
+	if ( pin < HOST_NUM_PINS )
+		pinISR[pin] = NULL;
+}
+
+void HostPinWrite ( uint8_t pin, uint8_t val )
+{
+	if ( pin >= HOST_NUM_PINS )
+		return;
+
+	uint8_t old = pinLevel[pin];
+
+	pinLevel[pin] = val ? HIGH : LOW;
+
+	if ( !pinISR[pin] || ( old == pinLevel[pin] ))
+		return;
+
+	if (( pinISRMode[pin] == CHANGE )
+			|| (( pinISRMode[pin] == RISING )  && pinLevel[pin] )
+			|| (( pinISRMode[pin] == FALLING ) && !pinLevel[pin] ))
+		pinISR[pin] ();
+}
+
+void HostAnalogSet ( uint8_t pin, uint16_t val )
+{
+	if ( pin < HOST_NUM_PINS )
+		pinAnalog[pin] = val;
+}
+
+uint8_t HostPinLevel ( uint8_t pin )
+{
+	return ( pin < HOST_NUM_PINS ) ? pinLevel[pin] : LOW;
+}
+
+void HostSetPinObserver ( HostPinObserver obs ) { pinObserver = obs; }
+
+
+/*
+ *	The GPIO registers just turn into "digitalWrite()"s:
+ */
+
+gpio_dev_t GPIO;
+
+HostGpioReg& HostGpioReg::operator= ( uint32_t mask )
+{
+	for ( int bit = 0; bit < 32; bit++ )
+		if ( mask & ( 1UL << bit ))
+			digitalWrite ( first + bit, level );
+
+	return *this;
+}
+
+
+/*
+ *	The cycle counter:
+ */
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount ( void )
+{
+	nowNs += HOST_CYCLE_READ_NS;
+	return (uint32_t) ( nowNs * HOST_CPU_MHZ / 1000 );
+}
+
+
+/*
+ *	"HostEncoderStep()" generates one full quadrature cycle on an encoder's pins.
+ *	With both pins idling high, clockwise ("dir" > 0) drops "B" first and counter-
+ *	clockwise drops "A" first. "edgeUs" is the simulated time between edges.
+ */
+
+void HostEncoderStep ( uint8_t pinA, uint8_t pinB, int dir, uint32_t edgeUs )
+{
+	uint8_t first  = ( dir > 0 ) ? pinB : pinA;
+	uint8_t second = ( dir > 0 ) ? pinA : pinB;
+
+	HostPinWrite ( first,  LOW );	HostAdvanceUs ( edgeUs );
+	HostPinWrite ( second, LOW );	HostAdvanceUs ( edgeUs );
+	HostPinWrite ( first,  HIGH );	HostAdvanceUs ( edgeUs );
+	HostPinWrite ( second, HIGH );	HostAdvanceUs ( edgeUs );
+}
+
+
+/*
+ *	PSRAM allocation:
+ */
+
+HostAllocStats hostAlloc = { 0, 0 };
+
+static bool		psramFull = false;
+
+void HostPsramFull ( bool full )
+{
+	psramFull = full;
+}
+
+void* ps_malloc ( size_t size )
+{
+	if ( psramFull )
+		return NULL;
+
+	hostAlloc.count++;
+	hostAlloc.bytes += size;
+	return malloc ( size );
+}
+
+void* ps_calloc ( size_t n, size_t size )
+{
+	if ( psramFull )
+		return NULL;
+
+	hostAlloc.count++;
+	hostAlloc.bytes += n * size;
+	return calloc ( n, size );
+}
+
+
+/*
+ *	Internal memory (see "esp_heap_caps.h"):
+ */
+
+static bool		dmaMemoryFull = false;
+
+void HostDmaMemoryFull ( bool full )
+{
+	dmaMemoryFull = full;
+}
+
+void* heap_caps_malloc ( size_t size, uint32_t caps )
+{
+	(void) caps;								// Any memory will do
+
+	if ( dmaMemoryFull )
+		return NULL;
+
+	return malloc ( size );
+}
+
+
+/*
+ *	The "Serial" object:
+ */
+
+HostSerial			Serial;
+static std::deque<char>	serialIn;
+static bool			serialQuiet = false;
+static FILE*		serialCapture = NULL;
+
+void HostSerialFeed ( const char* s ) { while ( *s ) serialIn.push_back ( *s++ ); }
+void HostSerialQuiet ( bool quiet ) { serialQuiet = quiet; }
+void HostSerialCapture ( FILE* f ) { serialCapture = f; }
+
+void HostSerial::begin ( uint32_t ) {}
+
+int HostSerial::available ( void ) { return (int) serialIn.size (); }
+
+int HostSerial::peek ( void )
+{
+	return serialIn.empty () ? -1 : (uint8_t) serialIn.front ();
+}
+
+int HostSerial::read ( void )
+{
+	if ( serialIn.empty ())
+		return -1;
+
+	int c = (uint8_t) serialIn.front ();
+	serialIn.pop_front ();
+	return c;
+}
+
+size_t HostSerial::printf ( const char* fmt, ... )
+{
+	char	buf[512];
+	va_list	args;
+
+	va_start ( args, fmt );
+	int n = vsnprintf ( buf, sizeof ( buf ), fmt, args );
+	va_end ( args );
+
+	if ( !serialQuiet )
+		fputs ( buf, stdout );
+
+	if ( serialCapture )
+		fputs ( buf, serialCapture );
+
+
+	return n < 0 ? 0 : n;
+}
+
+size_t HostSerial::write ( uint8_t c )       { return printf ( "%c", c ); }
+size_t HostSerial::write ( const char* s )   { return printf ( "%s", s ); }
+
+size_t HostSerial::print ( const char* s )   { return printf ( "%s", s ); }
+size_t HostSerial::print ( char c )          { return printf ( "%c", c ); }
+size_t HostSerial::print ( int n )           { return printf ( "%d", n ); }
+size_t HostSerial::print ( unsigned int n )  { return printf ( "%u", n ); }
+size_t HostSerial::print ( long n )          { return printf ( "%ld", n ); }
+size_t HostSerial::print ( unsigned long n ) { return printf ( "%lu", n ); }
+size_t HostSerial::print ( double n, int d ) { return printf ( "%.*f", d, n ); }
+
+size_t HostSerial::println ( void )                 { return printf ( "\n" ); }
+size_t HostSerial::println ( const char* s )        { return printf ( "%s\n", s ); }
+size_t HostSerial::println ( char c )               { return printf ( "%c\n", c ); }
+size_t HostSerial::println ( int n )                { return printf ( "%d\n", n ); }
+size_t HostSerial::println ( unsigned int n )       { return printf ( "%u\n", n ); }
+size_t HostSerial::println ( long n )               { return printf ( "%ld\n", n ); }
+size_t HostSerial::println ( unsigned long n )      { return printf ( "%lu\n", n ); }
+size_t HostSerial::println ( double n, int d )      { return printf ( "%.*f\n", d, n ); }
@@ -0,0 +1,196 @@
+/*
+ *	"Arduino.h" (host shim)
+ *
+ *	This is NOT the Arduino core! It is a stand-in that lets the VFO sources in the
+ *	"NJAD_VFO_V1.1" directory compile and run on an x86 Linux machine so that things
+ *	like "Dial()", "Transfer_Image()" and "DoTheMath()" can be run under a profiler or in a
+ *	benchmark loop.
+ *
+ *	The shim provides:
+ *
+ *		A virtual clock. "millis()" and "micros()" return simulated time. Each read of
+ *		the clock costs "HOST_CLOCK_READ_NS" nanoseconds of simulated time so busy-wait
+ *		loops like "Delay()" in the main program eventually finish. "delayMicroseconds()"
+ *		simply advances the clock, which means the time the bit-banged Si5351 code spends
+ *		waiting shows up in the simulated time but not in the real time.
+ *
+ *		Simulated GPIO pins. Output pins remember what was written to them, input pins
+ *		read HIGH unless the host program changes them with "HostPinWrite()" which also
+ *		runs any interrupt handler attached to the pin.
+ *		The GPIO set and clear registers ("soc/gpio_struct.h") drive the same pins.
+ *
+ *		The "ESP" object's cycle counter (see "Esp.h"), which also runs off the
+ *		simulated clock.
+ *
+ *		"ps_malloc()" and "ps_calloc()" which count the allocations so the benchmarks
+ *		can report them. "HostPsramFull()" makes them fail, as if the PSRAM had run out.
+ *
+ *		A "Serial" object that writes to stdout and reads from a buffer the host program
+ *		fills with "HostSerialFeed()".
+ *
+ *		Just enough FreeRTOS (see "freertos/task.h") to run "task0()".
+ */
+
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "Esp.h"
+
+
+/*
+ *	Basic Arduino definitions:
+ */
+
+#define	HIGH			0x1
+#define	LOW				0x0
+
+#define	INPUT			0x01
+#define	OUTPUT			0x02
+#define	INPUT_PULLUP	0x05
+
+#define	RISING			0x01
+#define	FALLING			0x02
+#define	CHANGE			0x03
+
+#define	IRAM_ATTR						// Nothing to put in IRAM on a PC!
+
+#define	HOST_NUM_PINS	40				// Same as the ESP32
+
+typedef bool		boolean;
+typedef uint8_t		byte;
+
+using std::abs;
+using std::min;
+using std::max;
+
+
+/*
+ *	Time related functions. All operate on the simulated clock:
+ */
+
+#define	HOST_CLOCK_READ_NS	100			// Simulated cost of reading the clock
+
+uint32_t	millis ( void );
+uint32_t	micros ( void );
+void		delay ( uint32_t ms );
+void		delayMicroseconds ( uint32_t us );
+void		yield ( void );
+
+
+/*
+ *	GPIO and interrupt functions:
+ */
+
+void	pinMode ( uint8_t pin, uint8_t mode );
+void	digitalWrite ( uint8_t pin, uint8_t val );
+int		digitalRead ( uint8_t pin );
+uint16_t analogRead ( uint8_t pin );
+
+#define	digitalPinToInterrupt(p)	( p )
+
+void	attachInterrupt ( uint8_t pin, void ( *isr )( void ), int mode );
+void	detachInterrupt ( uint8_t pin );
+
+
+/*
+ *	PSRAM allocation (the ESP32 versions put the memory in the external PSRAM):
+ */
+
+void*	ps_malloc ( size_t size );
+void*	ps_calloc ( size_t n, size_t size );
+
+
+/*
+ *	The "Serial" object:
+ */
+
+class HostSerial
+{
+	public:
+
+		void	begin ( uint32_t baud );
+		int		available ( void );
+		int		read ( void );
+		int		peek ( void );
+		size_t	write ( uint8_t c );
+		size_t	write ( const char* s );
+		void	flush ( void ) {}
+
+		size_t	print ( const char* s );
+		size_t	print ( char c );
+		size_t	print ( int n );
+		size_t	print ( unsigned int n );
+		size_t	print ( long n );
+		size_t	print ( unsigned long n );
+		size_t	print ( double n, int digits = 2 );
+
+		size_t	println ( void );
+		size_t	println ( const char* s );
+		size_t	println ( char c );
+		size_t	println ( int n );
+		size_t	println ( unsigned int n );
+		size_t	println ( long n );
+		size_t	println ( unsigned long n );
+		size_t	println ( double n, int digits = 2 );
+
+		size_t	printf ( const char* fmt, ... );
+};
+
+extern HostSerial Serial;
+
+
+/*
+ *	The sketch entry points (defined in the ".ino" file):
+ */
+
+void setup ( void );
+void loop ( void );
+
+
+/*
+ *	Everything below here is only for the host programs and does not exist on
+ *	the real hardware.
+ */
+
+uint64_t	HostNowNs ( void );						// Simulated time in nanoseconds
+void		HostAdvanceNs ( uint64_t ns );			// Move the simulated clock forward
+void		HostAdvanceUs ( uint64_t us );
+
+void		HostPinWrite ( uint8_t pin, uint8_t val );	// Drive an input pin (runs ISRs)
+void		HostAnalogSet ( uint8_t pin, uint16_t val );	// Value "analogRead()" returns
+uint8_t		HostPinLevel ( uint8_t pin );			// Current level of any pin
+
+typedef void ( *HostPinObserver )( uint8_t pin, uint8_t val, uint64_t ns );
+void		HostSetPinObserver ( HostPinObserver obs );	// Called for every "digitalWrite()"
+
+void		HostEncoderStep ( uint8_t pinA, uint8_t pinB, int dir, uint32_t edgeUs = 50 );
+
+void		HostSerialFeed ( const char* s );		// Queue input for "Serial.read()"
+void		HostSerialQuiet ( bool quiet );			// Suppress "Serial" output
+void		HostSerialCapture ( FILE* f );			// Copy "Serial" output to a file too
+
+
+struct HostAllocStats
+{
+	uint32_t	count;								// Number of "ps_malloc()/ps_calloc()" calls
+	size_t		bytes;								// Total bytes requested
+};
+
+extern HostAllocStats hostAlloc;
+
+void		HostPsramFull ( bool full );			// "ps_malloc()" and "ps_calloc()" fail
+
+void		HostStep ( uint32_t us );				// A pass of "loop()" (if awake) plus due tasks
+void		HostRunFor ( uint32_t us );				// Repeated "HostStep()"s
+
+#endif
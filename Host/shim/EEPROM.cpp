@@ -0,0 +1,60 @@
+/*
+ *	"EEPROM.cpp" (host shim)
+ */
+
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass ( void )
+{
+	memset ( data, 0xFF, sizeof ( data ));
+	size    = 0;
+	commits = 0;
+}
+
+bool EEPROMClass::begin ( size_t sz )
+{
+	if ( sz > HOST_EEPROM_MAX )
+		return false;
+
+	size = sz;
+	return true;
+}
+
+bool EEPROMClass::commit ( void )
+{
+	commits++;
+	return true;
+}
+
+uint8_t EEPROMClass::read ( int address )
+{
+	return (( address >= 0 ) && ( (size_t) address < size )) ? data[address] : 0;
+}
+
+void EEPROMClass::write ( int address, uint8_t val )
+{
+	if (( address >= 0 ) && ( (size_t) address < size ))
+		data[address] = val;
+}
+
+int32_t EEPROMClass::readLong ( int address )
+{
+	int32_t value = 0;
+
+	if (( address < 0 ) || ( address + sizeof ( value ) > size ))
+		return 0;
+
+	memcpy ( &value, &data[address], sizeof ( value ));
+	return value;
+}
+
+size_t EEPROMClass::writeLong ( int address, int32_t value )
+{
+	if (( address < 0 ) || ( address + sizeof ( value ) > size ))
+		return 0;
+
+	memcpy ( &data[address], &value, sizeof ( value ));
+	return sizeof ( value );
+}
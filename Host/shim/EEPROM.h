@@ -0,0 +1,40 @@
+/*
+ *	"EEPROM.h" (host shim)
+ *
+ *	The ESP32 "EEPROM" library is really a block of flash; here it's a block of RAM
+ *	that starts out erased (all 0xFF) and counts the "commit()" calls.
+ */
+
+#ifndef _HOST_EEPROM_H_
+#define _HOST_EEPROM_H_
+
+#include <Arduino.h>
+
+#define	HOST_EEPROM_MAX	4096
+
+class EEPROMClass
+{
+	public:
+
+		EEPROMClass ( void );
+
+		bool		begin ( size_t size );
+		bool		commit ( void );
+
+		uint8_t		read ( int address );
+		void		write ( int address, uint8_t val );
+
+		int32_t		readLong ( int address );
+		size_t		writeLong ( int address, int32_t value );
+
+		uint32_t	commits;					// Host only: number of "commit()" calls
+
+	private:
+
+		uint8_t		data[HOST_EEPROM_MAX];
+		size_t		size;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
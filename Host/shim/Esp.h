@@ -0,0 +1,27 @@
+/*
+ *	"Esp.h" (host shim)
+ *
+ *	The parts of the ESP32 "ESP" object the VFO program uses. The cycle counter runs
+ *	off the simulated clock at "HOST_CPU_MHZ", and reading it costs "HOST_CYCLE_READ_NS"
+ *	of simulated time so that loops waiting for it to reach some value finish.
+ */
+
+#ifndef _HOST_ESP_H_
+#define _HOST_ESP_H_
+
+#include <stdint.h>
+
+#define	HOST_CPU_MHZ		240					// Same as the ESP32's default
+#define	HOST_CYCLE_READ_NS	10					// Simulated cost of reading the cycle counter
+
+class EspClass
+{
+	public:
+
+		uint32_t	getCycleCount ( void );
+		uint32_t	getCpuFreqMHz ( void ) { return HOST_CPU_MHZ; }
+};
+
+extern EspClass ESP;
+
+#endif
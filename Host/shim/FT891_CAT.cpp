@@ -0,0 +1,122 @@
+/*
+ *	"FT891_CAT.cpp" (host shim)
+ */
+
+#include "FT891_CAT.h"
+
+FT891_CAT::FT891_CAT ( void )
+{
+	fa = fb  = 0;
+	mda = mdb = 0;
+	txStatus = TX_OFF;
+	st       = false;
+	msgLen   = 0;
+}
+
+void FT891_CAT::begin ( void ) {}
+
+
+/*
+ *	"CheckCAT()" reads whatever is waiting on "Serial" and returns "true" if any
+ *	complete message changed one of the settings.
+ */
+
+bool FT891_CAT::CheckCAT ( bool xmit )
+{
+	bool changed = false;
+
+	(void) xmit;								// The host has no real radio
+
+	while ( Serial.available ())
+	{
+		char c = Serial.read ();
+
+		if (( c == '\r' ) || ( c == '\n' ))
+			continue;
+
+		if ( c != ';' )
+		{
+			if ( msgLen < CAT_MSG_MAX )
+				msg[msgLen++] = c;
+			continue;
+		}
+
+		msg[msgLen] = '\0';
+
+		if ( ProcessMessage ())
+			changed = true;
+
+		msgLen = 0;
+	}
+
+	return changed;
+}
+
+
+/*
+ *	"ProcessMessage()" handles one complete message (without the ';'). Reads are
+ *	answered on "Serial"; sets return "true".
+ */
+
+bool FT891_CAT::ProcessMessage ( void )
+{
+	if ( msgLen < 2 )
+		return false;
+
+	const char*	arg = &msg[2];
+	int			len = msgLen - 2;
+
+	if (( msg[0] == 'F' ) && (( msg[1] == 'A' ) || ( msg[1] == 'B' )))
+	{
+		uint32_t* f = ( msg[1] == 'A' ) ? &fa : &fb;
+
+		if ( len == 0 )
+		{
+			Serial.printf ( "F%c%09u;", msg[1], *f );
+			return false;
+		}
+
+		*f = strtoul ( arg, NULL, 10 );
+		return true;
+	}
+
+	if (( msg[0] == 'M' ) && ( msg[1] == 'D' ) && ( len >= 1 ))
+	{
+		uint8_t* m = ( arg[0] == '0' ) ? &mda : &mdb;
+
+		if ( len == 1 )
+		{
+			Serial.printf ( "MD%c%X;", arg[0], *m );
+			return false;
+		}
+
+		*m = (uint8_t) strtoul ( &arg[1], NULL, 16 );
+		return true;
+	}
+
+	if (( msg[0] == 'T' ) && ( msg[1] == 'X' ))
+	{
+		if ( len == 0 )
+		{
+			Serial.printf ( "TX%u;", txStatus );
+			return false;
+		}
+
+		txStatus = arg[0] - '0';
+		return true;
+	}
+
+	if (( msg[0] == 'S' ) && ( msg[1] == 'T' ))
+	{
+		if ( len == 0 )
+		{
+			Serial.printf ( "ST%u;", st );
+			return false;
+		}
+
+		st = ( arg[0] != '0' );
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,69 @@
+/*
+ *	"FT891_CAT.h" (host shim)
+ *
+ *	Stand-in for the FT-891 CAT control emulator library
+ *	(https://github.com/WA2FZW/An-FT-891-CAT-Control-Emulator-Library-by-WA2FZW).
+ *
+ *	It handles the handful of CAT commands the VFO program cares about, taking its
+ *	input from the "Serial" object (fed by the host program with "HostSerialFeed()"):
+ *
+ *		FA;  FAnnnnnnnnn;		Read/set VFO-A frequency
+ *		FB;  FBnnnnnnnnn;		Read/set VFO-B frequency
+ *		MD0; MD0m;				Read/set mode for VFO-A ("m" is hex)
+ *		MD1; MD1m;				Read/set mode for VFO-B
+ *		TX;  TXn;				Read/set transmit status
+ *		ST;  STn;				Read/set split status
+ *
+ *	Anything else is ignored.
+ */
+
+#ifndef _HOST_FT891_CAT_H_
+#define _HOST_FT891_CAT_H_
+
+#include <Arduino.h>
+
+#define	TX_OFF		0						// Receiving
+#define	TX_MAN		1						// Transmitting (mic PTT)
+#define	TX_CAT		2						// Transmitting (CAT command)
+
+#define	XMIT_ON		HIGH					// Level on "XMIT_PIN" to transmit
+#define	XMIT_OFF	LOW
+
+#define	CAT_MSG_MAX	40						// Longest message we'll buffer
+
+class FT891_CAT
+{
+	public:
+
+		FT891_CAT ( void );
+
+		void		begin ( void );
+		bool		CheckCAT ( bool xmit = true );
+
+		void		SetFA  ( uint32_t freq ) { fa = freq; }
+		uint32_t	GetFA  ( void ) { return fa; }
+		void		SetFB  ( uint32_t freq ) { fb = freq; }
+		uint32_t	GetFB  ( void ) { return fb; }
+		void		SetMDA ( uint8_t mode ) { mda = mode; }
+		uint8_t		GetMDA ( void ) { return mda; }
+		void		SetMDB ( uint8_t mode ) { mdb = mode; }
+		uint8_t		GetMDB ( void ) { return mdb; }
+		void		SetTX  ( uint8_t tx ) { txStatus = tx; }
+		uint8_t		GetTX  ( void ) { return txStatus; }
+		void		SetST  ( bool split ) { st = split; }
+		bool		GetST  ( void ) { return st; }
+
+	private:
+
+		bool		ProcessMessage ( void );
+
+		uint32_t	fa, fb;
+		uint8_t		mda, mdb;
+		uint8_t		txStatus;
+		bool		st;
+
+		char		msg[CAT_MSG_MAX + 1];
+		int			msgLen;
+};
+
+#endif
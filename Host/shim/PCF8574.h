@@ -0,0 +1,40 @@
+/*
+ *	"PCF8574.h" (host shim)
+ *
+ *	Stand-in for Rob Tillaart's PCF8574 library. The host program can set what the
+ *	chip's pins read with "HostSet()"; they read all high (no switch closed) until
+ *	it does.
+ */
+
+#ifndef _HOST_PCF8574_H_
+#define _HOST_PCF8574_H_
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class PCF8574
+{
+	public:
+
+		PCF8574 ( uint8_t deviceAddress ) : addr ( deviceAddress ), pins ( 0xFF ) {}
+
+		void	begin ( uint8_t value = 0xFF ) { pins = value; }
+		uint8_t	read8 ( void ) { return pins; }
+		uint8_t	read ( uint8_t pin ) { return ( pin < 8 ) ? (( pins >> pin ) & 1 ) : 0; }
+		void	write8 ( uint8_t value ) { pins = value; }
+		void	write ( uint8_t pin, uint8_t value )
+		{
+			if ( pin < 8 )
+				pins = value ? ( pins | ( 1 << pin )) : ( pins & ~( 1 << pin ));
+		}
+		int		lastError ( void ) { return 0; }
+
+		void	HostSet ( uint8_t value ) { pins = value; }		// Host only
+
+	private:
+
+		uint8_t	addr;
+		uint8_t	pins;
+};
+
+#endif
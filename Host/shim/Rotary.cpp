@@ -0,0 +1,44 @@
+/*
+ *	"Rotary.cpp" (host shim)
+ *
+ *	The state table is the full-step one from the real library.
+ */
+
+#include "Rotary.h"
+
+#define	R_START			0x0
+#define	R_CW_FINAL		0x1
+#define	R_CW_BEGIN		0x2
+#define	R_CW_NEXT		0x3
+#define	R_CCW_BEGIN		0x4
+#define	R_CCW_FINAL		0x5
+#define	R_CCW_NEXT		0x6
+
+static const unsigned char ttable[7][4] =
+{
+	{ R_START,    R_CW_BEGIN,  R_CCW_BEGIN, R_START },				// R_START
+	{ R_CW_NEXT,  R_START,     R_CW_FINAL,  R_START | DIR_CW },		// R_CW_FINAL
+	{ R_CW_NEXT,  R_CW_BEGIN,  R_START,     R_START },				// R_CW_BEGIN
+	{ R_CW_NEXT,  R_CW_BEGIN,  R_CW_FINAL,  R_START },				// R_CW_NEXT
+	{ R_CCW_NEXT, R_START,     R_CCW_BEGIN, R_START },				// R_CCW_BEGIN
+	{ R_CCW_NEXT, R_CCW_FINAL, R_START,     R_START | DIR_CCW },	// R_CCW_FINAL
+	{ R_CCW_NEXT, R_CCW_FINAL, R_CCW_BEGIN, R_START }				// R_CCW_NEXT
+};
+
+Rotary::Rotary ( char _pin1, char _pin2 )
+{
+	pin1  = _pin1;
+	pin2  = _pin2;
+	state = R_START;
+
+	pinMode ( pin1, INPUT );
+	pinMode ( pin2, INPUT );
+}
+
+unsigned char Rotary::process ( void )
+{
+	unsigned char pinstate = ( digitalRead ( pin2 ) << 1 ) | digitalRead ( pin1 );
+
+	state = ttable[state & 0xf][pinstate];
+	return state & 0x30;
+}
@@ -0,0 +1,33 @@
+/*
+ *	"Rotary.h" (host shim)
+ *
+ *	Host version of Ben Buxton's full-step rotary encoder state machine as packaged
+ *	in https://github.com/brianlow/Rotary. It reads the simulated pins, so the
+ *	"HostEncoderStep()" function in the Arduino shim can be used to turn the knob.
+ */
+
+#ifndef _HOST_ROTARY_H_
+#define _HOST_ROTARY_H_
+
+#include <Arduino.h>
+
+#define	DIR_NONE	0x00				// No complete step yet
+#define	DIR_CW		0x10				// Clockwise step
+#define	DIR_CCW		0x20				// Counter-clockwise step
+
+class Rotary
+{
+	public:
+
+		Rotary ( char _pin1, char _pin2 );
+
+		unsigned char process ( void );
+
+	private:
+
+		unsigned char state;
+		unsigned char pin1;
+		unsigned char pin2;
+};
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ *	"TFT_eSPI.cpp" (host shim)
+ */
+
+#include "TFT_eSPI.h"
+
+TFT_eSPI::TFT_eSPI ( void )
+{
+	memset ( panel, 0, sizeof ( panel ));
+	memset ( &stats, 0, sizeof ( stats ));
+	winX = winY = winW = winH = winPos = 0;
+	writeStart = 0;
+	inWrite = false;
+	dmaX = dmaY = dmaW = dmaH = 0;
+	dmaData = NULL;
+	dmaDoneNs = 0;
+	dmaPending = false;
+}
+
+void TFT_eSPI::begin ( void ) {}
+void TFT_eSPI::setRotation ( uint8_t ) {}
+
+
+/*
+ *	The real "fillScreen()" takes a 16 bit color; the VFO passes its 24 bit colors
+ *	which get truncated the same way here.
+ */
+
+void TFT_eSPI::fillScreen ( uint32_t color )
+{
+	uint16_t c = (uint16_t) color;
+
+	c = ( c << 8 ) | ( c >> 8 );				// Store swapped, same as pushed images
+
+	for ( int r = 0; r < HOST_TFT_MAX; r++ )
+		for ( int col = 0; col < HOST_TFT_MAX; col++ )
+			panel[r][col] = c;
+}
+
+/*
+ *	"SpiNs()" is how long it takes to send "pixels" 16 bit pixels (and set the address
+ *	window first if "window" is "true"). "Send()" is for the normal functions; it waits
+ *	for any DMA that's still going, then keeps the caller waiting while the pixels go
+ *	out.
+ */
+
+uint64_t TFT_eSPI::SpiNs ( uint64_t pixels, bool window )
+{
+	uint64_t bits = pixels * 16 + ( window ? HOST_SPI_WINDOW_BITS : 0 );
+
+	return bits * 1000000000ULL / HOST_SPI_HZ;
+}
+
+void TFT_eSPI::Send ( uint64_t pixels, bool window )
+{
+	uint64_t ns = SpiNs ( pixels, window );
+
+	dmaWait ();
+
+	stats.busyNs += ns;
+	stats.waitNs += ns;
+	HostAdvanceNs ( ns );
+}
+
+void TFT_eSPI::Store ( int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data )
+{
+	for ( int32_t r = 0; r < h; r++ )
+		for ( int32_t c = 0; c < w; c++ )
+		{
+			int32_t pr = y + r;
+			int32_t pc = x + c;
+
+			if (( pr >= 0 ) && ( pr < HOST_TFT_MAX ) && ( pc >= 0 ) && ( pc < HOST_TFT_MAX ))
+				panel[pr][pc] = data[r * w + c];
+		}
+}
+
+void TFT_eSPI::pushRect ( int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data )
+{
+	pushImage ( x, y, w, h, data );
+}
+
+void TFT_eSPI::pushImage ( int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data )
+{
+	Send ( (uint64_t) w * h, true );
+
+	stats.pushes++;
+
+	if ( !inWrite )
+		stats.frames++;
+
+	Store ( x, y, w, h, data );
+
+	stats.pixels += (uint64_t) w * h;
+}
+
+void TFT_eSPI::startWrite ( void )
+{
+	writeStart = stats.pixels;
+	inWrite = true;
+}
+
+void TFT_eSPI::endWrite ( void )
+{
+	dmaWait ();
+
+	if ( inWrite && stats.pixels != writeStart )
+		stats.frames++;
+
+	inWrite = false;
+}
+
+void TFT_eSPI::setAddrWindow ( int32_t x, int32_t y, int32_t w, int32_t h )
+{
+	Send ( 0, true );
+
+	winX = x;  winY = y;  winW = w;  winH = h;
+	winPos = 0;
+}
+
+void TFT_eSPI::pushPixels ( const void* data, uint32_t len )
+{
+	const uint16_t* p = (const uint16_t*) data;
+
+	Send ( len, false );
+
+	stats.pushes++;
+	stats.pixels += len;
+
+	for ( uint32_t ix = 0; ix < len; ix++, winPos++ )
+	{
+		if ( winW <= 0 || winPos >= winW * winH )
+			break;
+
+		int32_t pr = winY + winPos / winW;
+		int32_t pc = winX + winPos % winW;
+
+		if (( pr >= 0 ) && ( pr < HOST_TFT_MAX ) && ( pc >= 0 ) && ( pc < HOST_TFT_MAX ))
+			panel[pr][pc] = p[ix];
+	}
+}
+
+/*
+ *	DMA. Only one transfer can be going at a time; like the real library,
+ *	"pushImageDMA()" waits for the last one to finish if it has to. Without a
+ *	"buffer", "data" has to stay put until the transfer is done.
+ */
+
+bool TFT_eSPI::initDMA ( bool ) { return true; }
+
+void TFT_eSPI::pushImageDMA ( int32_t x, int32_t y, int32_t w, int32_t h,
+							  uint16_t const* data, uint16_t* buffer )
+{
+	uint64_t ns = SpiNs ( (uint64_t) w * h, true );
+
+	dmaWait ();
+
+	if ( buffer )
+	{
+		memcpy ( buffer, data, (size_t) w * h * sizeof ( uint16_t ));
+		data = buffer;
+	}
+
+	dmaX = x;  dmaY = y;  dmaW = w;  dmaH = h;
+	dmaData    = data;
+	dmaDoneNs  = HostNowNs () + ns;
+	dmaPending = true;
+
+	stats.pushes++;
+	stats.pixels += (uint64_t) w * h;
+	stats.busyNs += ns;
+
+	if ( !inWrite )
+		stats.frames++;
+}
+
+void TFT_eSPI::DmaFinish ( void )
+{
+	Store ( dmaX, dmaY, dmaW, dmaH, dmaData );
+	dmaPending = false;
+}
+
+bool TFT_eSPI::dmaBusy ( void )
+{
+	if ( dmaPending && ( HostNowNs () >= dmaDoneNs ))
+		DmaFinish ();
+
+	return dmaPending;
+}
+
+void TFT_eSPI::dmaWait ( void )
+{
+	if ( !dmaPending )
+		return;
+
+	if ( HostNowNs () < dmaDoneNs )
+	{
+		stats.waitNs += dmaDoneNs - HostNowNs ();
+		HostAdvanceNs ( dmaDoneNs - HostNowNs ());
+	}
+
+	DmaFinish ();
+}
+
+uint16_t TFT_eSPI::Pixel ( int32_t col, int32_t row ) const
+{
+	if (( row < 0 ) || ( row >= HOST_TFT_MAX ) || ( col < 0 ) || ( col >= HOST_TFT_MAX ))
+		return 0;
+
+	return panel[row][col];
+}
+
+
+/*
+ *	The VFO image is pushed as "DISP_H" wide by "DISP_W" high with the dial's "y"
+ *	coordinate going across the panel, so the panel row is the screen "x" and the
+ *	panel column is the screen "y" counted up from the bottom.
+ */
+
+static uint16_t ScreenPixel ( const TFT_eSPI& t, int32_t x, int32_t y, int32_t height )
+{
+	uint16_t c = t.Pixel ( height - 1 - y, x );
+	return ( c << 8 ) | ( c >> 8 );				// Undo the byte swap
+}
+
+bool HostTftSavePPM ( const TFT_eSPI& t, const char* fileName, int32_t width, int32_t height )
+{
+	FILE* f = fopen ( fileName, "wb" );
+
+	if ( !f )
+		return false;
+
+	fprintf ( f, "P6\n%d %d\n255\n", width, height );
+
+	for ( int32_t y = 0; y < height; y++ )
+		for ( int32_t x = 0; x < width; x++ )
+		{
+			uint16_t c = ScreenPixel ( t, x, y, height );
+			uint8_t  rgb[3];
+
+			rgb[0] = (( c >> 11 ) & 0x1F ) << 3;
+			rgb[1] = (( c >> 5 )  & 0x3F ) << 2;
+			rgb[2] = ( c & 0x1F ) << 3;
+			fwrite ( rgb, 1, 3, f );
+		}
+
+	fclose ( f );
+	return true;
+}
+
+uint32_t HostTftChecksum ( const TFT_eSPI& t, int32_t width, int32_t height )
+{
+	uint32_t h = 2166136261UL;					// FNV-1a
+
+	for ( int32_t y = 0; y < height; y++ )
+		for ( int32_t x = 0; x < width; x++ )
+		{
+			uint16_t c = ScreenPixel ( t, x, y, height );
+			h = ( h ^ ( c & 0xFF )) * 16777619UL;
+			h = ( h ^ ( c >> 8 ))   * 16777619UL;
+		}
+
+	return h;
+}
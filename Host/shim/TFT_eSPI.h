@@ -0,0 +1,103 @@
+/*
+ *	"TFT_eSPI.h" (host shim)
+ *
+ *	Stand-in for Bodmer's TFT_eSPI library (https://github.com/Bodmer/TFT_eSPI). It
+ *	only implements what the VFO program uses. Instead of sending pixels to a real
+ *	display over SPI, it copies them into an in-memory copy of the panel and keeps
+ *	some statistics the benchmarks can report. The panel can be saved as a ".ppm"
+ *	file to see what the VFO would have displayed.
+ *
+ *	Sending takes simulated time, as if the pixels went out over an SPI bus running at
+ *	"HOST_SPI_HZ". The normal functions move the simulated clock on by that much before
+ *	they return, the same way the real ones keep the processor waiting. The DMA ones
+ *	("pushImageDMA()") return right away; the pixels land on the panel when the time is
+ *	up, and until then "dmaBusy()" returns "true". Reading the DMA buffer at the end
+ *	rather than the start catches anything that changes it too soon.
+ */
+
+#ifndef _HOST_TFT_ESPI_H_
+#define _HOST_TFT_ESPI_H_
+
+#include <Arduino.h>
+
+#define	HOST_TFT_MAX	320					// Largest panel dimension we support
+
+#define	HOST_SPI_HZ				40000000	// SPI clock ("SPI_FREQUENCY" in "User_Setup.h")
+#define	HOST_SPI_WINDOW_BITS	88			// Commands to set an address window
+
+struct HostTftStats
+{
+	uint32_t	pushes;						// Number of "pushRect()"/"pushImage()"/"pushPixels()" calls
+	uint64_t	pixels;						// Total pixels sent to the panel
+	uint32_t	frames;						// Images sent; a "pushRect()" or "startWrite()" to
+											// "endWrite()" with anything pushed in between
+	uint64_t	busyNs;						// Simulated time the SPI bus was busy
+	uint64_t	waitNs;						// Simulated time the caller spent waiting for it
+};
+
+class TFT_eSPI
+{
+	public:
+
+		TFT_eSPI ( void );
+
+		void	begin ( void );
+		void	init ( void ) { begin (); }
+		void	setRotation ( uint8_t r );
+		void	fillScreen ( uint32_t color );
+
+		void	pushRect ( int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data );
+		void	pushImage ( int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data );
+
+		void	startWrite ( void );
+		void	endWrite ( void );
+		void	setAddrWindow ( int32_t x, int32_t y, int32_t w, int32_t h );
+		void	pushPixels ( const void* data, uint32_t len );
+
+		bool	initDMA ( bool ctrl_cs = false );
+		void	pushImageDMA ( int32_t x, int32_t y, int32_t w, int32_t h,
+							   uint16_t const* data, uint16_t* buffer = nullptr );
+		bool	dmaBusy ( void );
+		void	dmaWait ( void );
+
+
+/*
+ *	Host only. "panel" is stored exactly as the panel would see it in its native
+ *	orientation; "Pixel()" returns the byte-swapped RGB565 value at "col", "row".
+ */
+
+		uint16_t		Pixel ( int32_t col, int32_t row ) const;
+		HostTftStats	stats;
+
+	private:
+
+		uint16_t	panel[HOST_TFT_MAX][HOST_TFT_MAX];
+		int32_t		winX, winY, winW, winH;		// Current address window
+		int32_t		winPos;						// Next pixel in the window
+		uint64_t	writeStart;					// "stats.pixels" at "startWrite()"
+		bool		inWrite;
+
+		int32_t			dmaX, dmaY, dmaW, dmaH;	// DMA transfer in progress
+		const uint16_t*	dmaData;
+		uint64_t		dmaDoneNs;				// When it will be finished
+		bool			dmaPending;
+
+		void		Store ( int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data );
+		uint64_t	SpiNs ( uint64_t pixels, bool window );
+		void		Send ( uint64_t pixels, bool window );
+		void		DmaFinish ( void );
+
+};
+
+
+/*
+ *	Host helpers that work on the VFO's "tft" object. "HostTftSavePPM()" writes the
+ *	panel as the user would see it on a "width" x "height" landscape display.
+ *	"HostTftChecksum()" is a simple hash of the same area.
+ */
+
+bool		HostTftSavePPM ( const TFT_eSPI& t, const char* fileName,
+							 int32_t width, int32_t height );
+uint32_t	HostTftChecksum ( const TFT_eSPI& t, int32_t width, int32_t height );
+
+#endif
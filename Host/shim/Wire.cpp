@@ -0,0 +1,7 @@
+/*
+ *	"Wire.cpp" (host shim)
+ */
+
+#include "Wire.h"
+
+TwoWire Wire;
@@ -0,0 +1,31 @@
+/*
+ *	"Wire.h" (host shim)
+ *
+ *	The VFO program includes "Wire.h" but only uses it indirectly through the
+ *	"PCF8574" library (the Si5351 has its own bit-banged bus), so there's nothing
+ *	here but an object that accepts and ignores everything.
+ */
+
+#ifndef _HOST_WIRE_H_
+#define _HOST_WIRE_H_
+
+#include <Arduino.h>
+
+class TwoWire
+{
+	public:
+
+		bool	begin ( void ) { return true; }
+		bool	begin ( int, int, uint32_t = 0 ) { return true; }
+		void	setClock ( uint32_t ) {}
+		void	beginTransmission ( uint8_t ) {}
+		uint8_t	endTransmission ( bool = true ) { return 0; }
+		size_t	write ( uint8_t ) { return 1; }
+		uint8_t	requestFrom ( uint8_t, uint8_t ) { return 0; }
+		int		available ( void ) { return 0; }
+		int		read ( void ) { return -1; }
+};
+
+extern TwoWire Wire;
+
+#endif
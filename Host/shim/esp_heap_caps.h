@@ -0,0 +1,24 @@
+/*
+ *	"esp_heap_caps.h" (host shim)
+ *
+ *	On the ESP32, "heap_caps_malloc()" gets memory with particular capabilities, like
+ *	internal memory the DMA hardware can read. On the host, any memory will do, and
+ *	"HostDmaMemoryFull()" makes it fail, as if there wasn't any left.
+ */
+
+#ifndef _HOST_ESP_HEAP_CAPS_H_
+#define _HOST_ESP_HEAP_CAPS_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define	MALLOC_CAP_DMA			( 1 << 3 )
+#define	MALLOC_CAP_8BIT			( 1 << 2 )
+#define	MALLOC_CAP_INTERNAL		( 1 << 11 )
+
+void*	heap_caps_malloc ( size_t size, uint32_t caps );
+inline void  heap_caps_free ( void* p ) { free ( p ); }
+
+void	HostDmaMemoryFull ( bool full );			// "heap_caps_malloc()" fails
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ *	"esp_partition.cpp" (host shim)
+ */
+
+#include <string.h>
+#include "esp_partition.h"
+
+HostFlashStats	hostFlash;
+uint8_t			hostFlashData[HOST_FLASH_SIZE];
+
+static const esp_partition_t	spiffs =
+	{ ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0x290000, HOST_FLASH_SIZE, "spiffs", false };
+
+static int32_t	cutAfter = -1;					// Bytes until the power goes off (-1 = never)
+static bool		eraseFails = false;				// Erasing doesn't work
+
+static struct FlashInit							// It starts out erased
+{
+	FlashInit () { HostFlashErase (); }
+} flashInit;
+
+void HostFlashErase ( void )
+{
+	memset ( hostFlashData, 0xFF, sizeof ( hostFlashData ));
+}
+
+void HostFlashCutAfter ( int32_t bytes )
+{
+	cutAfter = bytes;
+}
+
+void HostFlashEraseFails ( bool fails )
+{
+	eraseFails = fails;
+}
+
+const esp_partition_t* esp_partition_find_first ( esp_partition_type_t type,
+							esp_partition_subtype_t subtype, const char* label )
+{
+	if ( type != spiffs.type )
+		return NULL;
+
+	if (( subtype != ESP_PARTITION_SUBTYPE_ANY ) && ( subtype != spiffs.subtype ))
+		return NULL;
+
+	if ( label && strcmp ( label, spiffs.label ))
+		return NULL;
+
+	return &spiffs;
+}
+
+esp_err_t esp_partition_read ( const esp_partition_t* part, size_t offset, void* dst, size_t size )
+{
+	if (( part != &spiffs ) || ( offset + size > HOST_FLASH_SIZE ))
+		return ESP_ERR_INVALID_SIZE;
+
+	memcpy ( dst, hostFlashData + offset, size );
+	hostFlash.reads++;
+	return ESP_OK;
+}
+
+
+/*
+ *	Writing ANDs the new data with what's there, like NOR flash. If the power is
+ *	"cut", only some of the bytes get written and nothing after that does.
+ */
+
+esp_err_t esp_partition_write ( const esp_partition_t* part, size_t offset, const void* src, size_t size )
+{
+	if (( part != &spiffs ) || ( offset + size > HOST_FLASH_SIZE ))
+		return ESP_ERR_INVALID_SIZE;
+
+	const uint8_t*	s = (const uint8_t*) src;
+
+	for ( size_t ix = 0; ix < size; ix++ )
+	{
+		if ( cutAfter == 0 )
+			return ESP_OK;
+
+		if ( cutAfter > 0 )
+			cutAfter--;
+
+		hostFlashData[offset + ix] &= s[ix];
+	}
+
+	hostFlash.writes++;
+	hostFlash.bytesWritten += size;
+	return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range ( const esp_partition_t* part, size_t offset, size_t size )
+{
+	if (( part != &spiffs ) || ( offset + size > HOST_FLASH_SIZE ))
+		return ESP_ERR_INVALID_SIZE;
+
+	if (( offset % SPI_FLASH_SEC_SIZE ) || ( size % SPI_FLASH_SEC_SIZE ))
+		return ESP_ERR_INVALID_ARG;
+
+	if ( eraseFails )
+		return ESP_FAIL;
+
+	if ( cutAfter == 0 )
+		return ESP_OK;
+
+	memset ( hostFlashData + offset, 0xFF, size );
+
+	for ( size_t ix = offset / SPI_FLASH_SEC_SIZE; ix < ( offset + size ) / SPI_FLASH_SEC_SIZE; ix++ )
+		hostFlash.erases[ix]++;
+
+	return ESP_OK;
+}
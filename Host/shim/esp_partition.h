@@ -0,0 +1,76 @@
+/*
+ *	"esp_partition.h" (host shim)
+ *
+ *	On the ESP32, the flash is divided into partitions and "esp_partition_read()",
+ *	"esp_partition_write()" and "esp_partition_erase_range()" work on one of them.
+ *	Here there is one data partition ("spiffs") held in RAM, which behaves like NOR
+ *	flash: erasing sets a whole 4K sector to 0xFF and writing can only turn bits from
+ *	1 to 0. Every erase is counted for each sector so the wear can be measured.
+ */
+
+#ifndef _HOST_ESP_PARTITION_H_
+#define _HOST_ESP_PARTITION_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define	SPI_FLASH_SEC_SIZE		4096				// Erase size
+#define	HOST_FLASH_SIZE			( 64 * 1024 )		// Size of the "spiffs" partition
+
+typedef int esp_err_t;
+
+#define	ESP_OK					0
+#define	ESP_FAIL				-1
+#define	ESP_ERR_INVALID_ARG		0x102
+#define	ESP_ERR_INVALID_SIZE	0x104
+
+typedef enum
+{
+	ESP_PARTITION_TYPE_APP  = 0x00,
+	ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef enum
+{
+	ESP_PARTITION_SUBTYPE_DATA_SPIFFS = 0x82,
+	ESP_PARTITION_SUBTYPE_ANY         = 0xFF
+} esp_partition_subtype_t;
+
+typedef struct
+{
+	esp_partition_type_t	type;
+	esp_partition_subtype_t	subtype;
+	uint32_t				address;
+	uint32_t				size;
+	char					label[17];
+	bool					encrypted;
+} esp_partition_t;
+
+const esp_partition_t*	esp_partition_find_first ( esp_partition_type_t type,
+								esp_partition_subtype_t subtype, const char* label );
+
+esp_err_t	esp_partition_read ( const esp_partition_t* part, size_t offset, void* dst, size_t size );
+esp_err_t	esp_partition_write ( const esp_partition_t* part, size_t offset, const void* src, size_t size );
+esp_err_t	esp_partition_erase_range ( const esp_partition_t* part, size_t offset, size_t size );
+
+
+/*
+ *	Host only:
+ */
+
+struct HostFlashStats
+{
+	uint32_t	erases[HOST_FLASH_SIZE / SPI_FLASH_SEC_SIZE];	// Per sector
+	uint32_t	writes;											// "esp_partition_write()" calls
+	uint32_t	bytesWritten;
+	uint32_t	reads;
+};
+
+extern HostFlashStats	hostFlash;
+extern uint8_t			hostFlashData[HOST_FLASH_SIZE];			// What's in the partition
+
+void	HostFlashErase ( void );							// Erase all of it (a new chip)
+void	HostFlashCutAfter ( int32_t bytes );				// Lose power part way through a write
+void	HostFlashEraseFails ( bool fails );					// Make erasing return an error
+
+#endif
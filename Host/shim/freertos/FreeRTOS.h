@@ -0,0 +1,27 @@
+/*
+ *	"freertos/FreeRTOS.h" (host shim)
+ *
+ *	Basic FreeRTOS types. Only what the VFO program uses is here.
+ */
+
+#ifndef _HOST_FREERTOS_H_
+#define _HOST_FREERTOS_H_
+
+#include <stdint.h>
+
+typedef int32_t		BaseType_t;
+typedef uint32_t	UBaseType_t;
+typedef uint32_t	TickType_t;
+
+#define	pdFALSE				0
+#define	pdTRUE				1
+#define	pdPASS				pdTRUE
+#define	pdFAIL				pdFALSE
+
+#define	portMAX_DELAY		( TickType_t ) 0xFFFFFFFFUL
+#define	portTICK_PERIOD_MS	1
+#define	pdMS_TO_TICKS(ms)	(( TickType_t )( ms ) / portTICK_PERIOD_MS )
+
+#define	portYIELD_FROM_ISR(...)	(( void ) 0 )
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ *	"freertos/task.h" (host shim)
+ *
+ *	Tasks created with "xTaskCreatePinnedToCore()" run on their own thread, but only
+ *	one thread (the main thread running "setup()" and "loop()" or one of the tasks)
+ *	is ever allowed to run at a time. A task runs until it calls "delay()",
+ *	"vTaskDelay()" or "ulTaskNotifyTake()", at which point control goes back to the
+ *	main thread. The task runs again the next time the main thread finds the
+ *	simulated clock has passed the task's wake-up time. Giving a task that's waiting
+ *	in "ulTaskNotifyTake()" a notification makes its wake-up time "now".
+ *
+ *	That makes the host runs completely repeatable, which is what we want for
+ *	benchmarks and tests, even though it isn't how the real dual core ESP32 works.
+ */
+
+#ifndef _HOST_FREERTOS_TASK_H_
+#define _HOST_FREERTOS_TASK_H_
+
+#include "FreeRTOS.h"
+
+typedef void ( *TaskFunction_t )( void* );
+typedef struct HostTask* TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore ( TaskFunction_t code, const char* name,
+									 uint32_t stackDepth, void* params,
+									 UBaseType_t priority, TaskHandle_t* handle,
+									 BaseType_t coreID );
+
+void		vTaskDelay ( TickType_t ticks );
+TickType_t	xTaskGetTickCount ( void );
+BaseType_t	xPortGetCoreID ( void );
+
+TaskHandle_t xTaskGetCurrentTaskHandle ( void );
+uint32_t	ulTaskNotifyTake ( BaseType_t clearOnExit, TickType_t ticks );
+BaseType_t	xTaskNotifyGive ( TaskHandle_t task );
+void		vTaskNotifyGiveFromISR ( TaskHandle_t task, BaseType_t* woken );
+
+
+
+/*
+ *	Host only. Runs each task whose wake-up time has passed until it blocks again.
+ *	Returns the number of tasks that ran.
+ */
+
+int		HostRunTasks ( void );
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ *	"soc/gpio_struct.h" (host shim)
+ *
+ *	The ESP32's GPIO registers. Only the "write 1 to set" and "write 1 to clear"
+ *	output registers are here. Writing one of them does a "digitalWrite()" for each
+ *	pin whose bit is set, so the simulated pins (and any pin observer) see exactly
+ *	the same thing as when the program uses "digitalWrite()".
+ */
+
+#ifndef _HOST_GPIO_STRUCT_H_
+#define _HOST_GPIO_STRUCT_H_
+
+#include <stdint.h>
+
+struct HostGpioReg
+{
+	uint8_t	level;								// What writing a 1 bit does
+	uint8_t	first;								// Pin number of bit 0
+
+	HostGpioReg ( uint8_t lvl, uint8_t pin ) : level ( lvl ), first ( pin ) {}
+	HostGpioReg& operator= ( uint32_t mask );
+};
+
+struct HostGpioReg1								// The GPIO 32 - 39 registers are unions
+{
+	HostGpioReg	val;
+
+	HostGpioReg1 ( uint8_t lvl ) : val ( lvl, 32 ) {}
+};
+
+struct gpio_dev_t
+{
+	HostGpioReg		out_w1ts;
+	HostGpioReg		out_w1tc;
+	HostGpioReg1	out1_w1ts;
+	HostGpioReg1	out1_w1tc;
+
+	gpio_dev_t ( void ) : out_w1ts ( 1, 0 ), out_w1tc ( 0, 0 ), out1_w1ts ( 1 ), out1_w1tc ( 0 ) {}
+};
+
+extern gpio_dev_t GPIO;
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ *	"sketch.cpp"
+ *
+ *	The Arduino IDE turns "NJAD_VFO_V1.1.ino" into a C++ file by adding the function
+ *	prototypes in front of it so that functions can be used before they are defined.
+ *	This file does the same thing for the host build so the ".ino" file can be
+ *	compiled without any changes.
+ *
+ *	If functions are added to the ".ino" file that get called before the place they
+ *	are defined, their prototypes need to be added here.
+ */
+
+#include <Arduino.h>
+
+struct	journal_state;
+
+void	task0 ( void* arg );
+
+bool	ReadBandSwitch ();
+bool	ReadModeSwitch ();
+void	CheckModeButton ();
+float	ReadBattery ();
+bool	CheckCAT ();
+void	CheckLocal ();
+void	StartTrace ();
+void	GetState ( journal_state* st );
+void	RestoreState ();
+void	SaveState ();
+
+
+void	SetOverlay ( float battVolts );
+void	PaintOverlay ();
+void	PaintScreen ();
+void	BandSwitchJob ();
+void	ModeSwitchJob ();
+void	CatJob ();
+void	BatteryJob ();
+
+
+bool	CheckFreq ( uint32_t newFreq, uint8_t whichOne );
+void	FrequencyISR ();
+void	PTT_ISR ();
+void	InitClarifier ();
+void	ReadClarifier ();
+void	ClarifierISR ();
+void	CheckFcnButton ();
+void	CheckIncrButton ();
+void	CheckClarSwitch ();
+void	SwapVFOs ();
+uint32_t BandVFOFreq ( uint8_t band, uint32_t freq );
+void	PlanBand ( uint8_t band );
+
+void	Delay ( uint32_t timeOut );
+void	printBandData ( char* str );
+
+#include "../NJAD_VFO_V1.1/NJAD_VFO_V1.1.ino"
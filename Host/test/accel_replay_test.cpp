@@ -0,0 +1,174 @@
+/*
+ *	"accel_replay_test.cpp"
+ *
+ *	Checks that the tuning accelerator only depends on how fast the knob turns, not
+ *	on how often "task0()" gets to run. The same recorded knob movement (speeding
+ *	up from a slow turn to a fast spin and slowing down again) is played into the
+ *	frequency encoder pins several times. The first time, "task0()" and "loop()" run
+ *	all the time; after that, they only get a millisecond every so often, the way
+ *	they would if something else (sending the screen, say) was keeping them busy (up
+ *	to 25mS, which is about as long as "EVENT_QUEUE" can cover at full speed). The
+ *	frequency has to end up in exactly the same place every time, and further than
+ *	it would have gone without the accelerator.
+ *
+ *	Usage:	accel_replay_test
+ */
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+#include "accel.h"
+#include "events.h"
+
+
+extern band_data	bandData[];
+extern uint8_t		activeBand;
+extern uint32_t		rxFreq;
+
+extern volatile int16_t	incrList[];
+extern volatile uint8_t	incrCount;
+
+#define	START_FREQ	52000000UL				// Middle of 6 meters
+#define	WINDOW_US	1000					// How long the tasks get each time
+
+
+/*
+ *	"RunUntil()" lets the tasks and "loop()" run up to a little before "ns"; they can
+ *	go a little past where they're told to stop.
+ */
+
+#define	SPARE_US	20
+
+static int	bad = 0;
+
+static void RunUntil ( uint64_t ns )
+{
+	if ( ns > HostNowNs () + SPARE_US * 1000 )
+		HostRunFor (( ns - HostNowNs ()) / 1000 - SPARE_US );
+}
+
+
+/*
+ *	"StepAt()" turns the knob one step at "ns". If the tasks ran past that, the step
+ *	times would be different from one run to the next, so that's an error.
+ */
+
+static void StepAt ( uint64_t ns )
+{
+	if ( HostNowNs () > ns )
+	{
+		if ( bad++ < 10 )
+			printf ( "Ran %llu ns past where the next step should be\n",
+						(unsigned long long) ( HostNowNs () - ns ));
+	}
+
+	else
+		HostAdvanceNs ( ns - HostNowNs ());
+
+	HostEncoderStep ( FREQ_ENCDR_A, FREQ_ENCDR_B, -1, 50 );
+}
+
+
+/*
+ *	"Replay()" plays the steps in "trace" (microseconds from the start) and returns
+ *	where the frequency ended up. With "serviceUs" zero, the tasks run between every
+ *	step; otherwise they only get "WINDOW_US" every "serviceUs".
+ */
+
+static uint32_t Replay ( const std::vector<uint32_t>& trace, uint32_t serviceUs )
+{
+	bandData[activeBand].vfoA = START_FREQ;
+	AccelReset ();
+	HostRunFor ( 200000 );							// Let everything catch up
+
+	uint64_t	base        = HostNowNs ();
+	uint64_t	nextService = base;
+
+	for ( uint32_t us : trace )
+	{
+		uint64_t	t = base + us * 1000ULL;
+
+		if ( serviceUs == 0 )
+			RunUntil ( t );
+
+		else
+		{
+			while ( nextService + WINDOW_US * 1000ULL <= t )
+			{
+				if ( nextService > HostNowNs ())
+					HostAdvanceNs ( nextService - HostNowNs ());
+
+				RunUntil ( nextService + WINDOW_US * 1000ULL );
+				nextService += serviceUs * 1000ULL;
+			}
+		}
+
+		StepAt ( t );
+	}
+
+
+	HostRunFor ( 200000 );							// Use up the last steps
+
+	return rxFreq;
+}
+
+
+int main ( void )
+{
+	static const uint32_t	service[] = { 0, 3000, 10000, 25000 };
+
+	std::vector<uint32_t>	trace;
+	uint32_t				us = 0;
+	double					gap = 120000;			// Slow to start with
+
+	for ( int ix = 0; ix < 400; ix++ )				// Speed up, keep going, slow down
+	{
+		trace.push_back ( us );
+
+		if ( ix < 150 )			gap *= 0.97;
+		else if ( ix >= 250 )	gap /= 0.97;
+
+		us += (uint32_t) gap;
+	}
+
+	HostSerialQuiet ( true );
+
+	setup ();
+
+	uint32_t	lclIncr = max ( (int) incrList[incrCount], F_STEP );
+
+	uint32_t	plain   = trace.size () / ENCDR_FCTR * lclIncr;		// Unaccelerated
+	uint32_t	first   = 0;
+
+	printf ( "%zu encoder steps over %.2f s, %u Hz without the accelerator\n\n",
+				trace.size (), trace.back () / 1e6, plain );
+
+	for ( uint32_t s : service )
+	{
+		uint32_t	freq = Replay ( trace, s );
+		int32_t		moved = (int32_t) ( freq - START_FREQ );
+
+		if ( s == 0 )
+		{
+			printf ( "  Tasks always running:         moved %+d Hz\n", moved );
+			first = freq;
+		}
+
+		else
+			printf ( "  Tasks run 1 ms every %2u ms:   moved %+d Hz\n", s / 1000, moved );
+
+		if ( freq != first && bad++ < 10 )
+			printf ( "  Different from when the tasks were always running!\n" );
+
+		if (( abs ( moved ) <= (int32_t) plain ) && bad++ < 10 )
+			printf ( "  Didn't accelerate\n" );
+	}
+
+	if ( EventsLost () && bad++ < 10 )				// Longer stalls than "EVENT_QUEUE" can cover
+		printf ( "\n%u events were lost\n", EventsLost ());
+
+	printf ( "\n%d problems\n", bad );
+
+
+	return bad ? 1 : 0;
+}
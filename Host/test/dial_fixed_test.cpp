@@ -0,0 +1,122 @@
+/*
+ *	"dial_fixed_test.cpp"
+ *
+ *	Checks that the fixed point dial ("DIAL_FIXED_POINT" set to "true") paints the
+ *	same picture as the floating point version. The program is built twice (see
+ *	"CMakeLists.txt"); the floating point copy paints a set of dials and saves the
+ *	16 bit image to a file, then the fixed
+ *	point copy paints the same dials and compares them with what's in the file. The
+ *	red, green and blue parts of every pixel have to be within 1 of the floating
+ *	point ones.
+ *
+ *	Usage:	dial_fixed_test_<size> --dump file
+ *			dial_fixed_test_<size>_fixed --compare file
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "display.h"
+#include "dial.h"
+
+
+extern band_data	bandData[];
+extern uint8_t		activeBand;
+
+extern uint16_t*	GRAM65k;
+
+#define	NBR_FRAMES		48				// Dials spread over the band
+#define	NBR_STEPS		16				// Followed by some 10Hz steps
+#define	MAX_DIFF		1				// Allowed difference per color component
+
+
+/*
+ *	"FrameFreq()" returns the frequency for frame number "f"; the first ones jump
+ *	around the band and the rest tune up in 10Hz steps from the last of those.
+ */
+
+static uint32_t FrameFreq ( int f )
+{
+	uint32_t	low  = bandData[activeBand].lowLimit;
+	uint32_t	span = bandData[activeBand].topLimit - low;
+
+	if ( f < NBR_FRAMES )
+		return low + (uint32_t) (( (uint64_t) f * 7919 ) % span );
+
+	return FrameFreq ( NBR_FRAMES - 1 ) + ( f - NBR_FRAMES + 1 ) * 10;
+}
+
+
+int main ( int argc, char* argv[] )
+{
+	bool		dump;
+	FILE*		file;
+	int			bad  = 0;
+	int			most = 0;
+
+	if ( argc != 3 || ( strcmp ( argv[1], "--dump" ) && strcmp ( argv[1], "--compare" )))
+	{
+		fprintf ( stderr, "Usage: %s --dump|--compare file\n", argv[0] );
+		return 2;
+	}
+
+	dump = strcmp ( argv[1], "--dump" ) == 0;
+	file = fopen ( argv[2], dump ? "wb" : "rb" );
+
+	if ( !file )
+	{
+		fprintf ( stderr, "Can't open %s\n", argv[2] );
+		return 2;
+	}
+
+	HostSerialQuiet ( true );
+	setup ();
+
+	uint16_t	image[DISP_W * DISP_H];
+	int			shift[3] = { 11, 5, 0 };			// Red, green and blue fields
+	int			mask[3]  = { 0x1F, 0x3F, 0x1F };
+
+	for ( int f = 0; f < NBR_FRAMES + NBR_STEPS; f++ )
+	{
+		Dial ( FrameFreq ( f ));
+
+
+		if ( dump )
+		{
+			fwrite ( GRAM65k, sizeof ( uint16_t ), DISP_W * DISP_H, file );
+			continue;
+		}
+
+		if ( fread ( image, sizeof ( uint16_t ), DISP_W * DISP_H, file ) != DISP_W * DISP_H )
+		{
+			fprintf ( stderr, "%s is too short\n", argv[2] );
+			return 1;
+		}
+
+		for ( int ix = 0; ix < DISP_W * DISP_H; ix++ )
+		{
+			uint16_t	got  = ( GRAM65k[ix] >> 8 ) | ( GRAM65k[ix] << 8 );	// Byte swapped
+			uint16_t	want = ( image[ix] >> 8 ) | ( image[ix] << 8 );
+
+			for ( int c = 0; c < 3; c++ )
+			{
+				int diff = abs ((( got >> shift[c] ) & mask[c] ) - (( want >> shift[c] ) & mask[c] ));
+
+				most = max ( most, diff );
+
+				if ( diff > MAX_DIFF && bad++ < 10 )
+					printf ( "Frame %d (%u Hz) pixel %d: %04x, should be %04x\n",
+								f, FrameFreq ( f ), ix, got, want );
+			}
+		}
+	}
+
+	fclose ( file );
+
+	if ( dump )
+		return 0;
+
+	printf ( "%d frames compared, largest difference %d, %d out of tolerance\n",
+				NBR_FRAMES + NBR_STEPS, most, bad );
+
+	return bad ? 1 : 0;
+}
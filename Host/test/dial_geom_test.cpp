@@ -0,0 +1,148 @@
+/*
+ *	"dial_geom_test.cpp"
+ *
+ *	The dial shape in "dial_geom.h" is worked out by the compiler. This works it out
+ *	again the way "InitDial()" used to when the program started, with "float" square
+ *	roots, and checks that the resolutions, the first and last ticks and every entry
+ *	in "yry" come out the same. It's built once for each display size.
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "display.h"
+#include "dial_geom.h"
+
+void setup ( void ) {}						// The sketch isn't part of this
+void loop ( void ) {}
+
+static int	bad = 0;
+
+
+/*
+ *	"OldArc()" is one of the loops "InitDial()" used to fill in a column of "yry".
+ */
+
+static void OldArc ( int old[][4], int n, int radius )
+{
+	int		xg;
+	float	xf, yf;
+
+	for ( xg = 0; xg <= Nx - 1; xg++ )
+	{
+		xf = (float) xg;
+		yf = (float) ( radius * radius )
+				- ( xf - (float) ( Nx >> 1 )) * ( xf - (float) ( Nx >> 1 ));
+
+		if ( yf > 0 )
+		{
+			old[xg][n] = (int) ( 0.5 + sqrt ( yf ) - (float) D_R + (float) D_HEIGHT );
+
+			if ( old[xg][n] < 0 )
+				old[xg][n] = 0;
+		}
+
+		else
+			old[xg][n] = 0;
+	}
+}
+
+static void Check ( const char* name, double got, double want )
+{
+	if (( got != want ) && bad++ < 10 )
+		printf ( "%s is %g, should be %g\n", name, got, want );
+}
+
+
+int main ( void )
+{
+	int		D_R_in = D_R - DIAL_SPACE;
+	float	arc_main, arc_sub;
+	float	res_sub, res_main;
+
+	if ( F_MAIN_OUTSIDE == 1 )
+	{
+		res_sub  = (float) TICK_PITCH_SUB  / (float) D_R_in;
+		res_main = (float) TICK_PITCH_MAIN / (float) D_R;
+		arc_main = ( D_R < ( Nx / 2 ))    ? 1.6 * (float) D_R    : 1.6 * 0.5 * (float) Nx;
+		arc_sub  = ( D_R_in < ( Nx / 2 )) ? 1.6 * (float) D_R_in : 1.6 * 0.5 * (float) Nx;
+	}
+
+	else
+	{
+		res_sub  = (float) TICK_PITCH_SUB  / (float) D_R;
+		res_main = (float) TICK_PITCH_MAIN / (float) D_R_in;
+		arc_sub  = ( D_R < ( Nx / 2 ))    ? 1.6 * (float) D_R    : 1.6 * 0.5 * (float) Nx;
+		arc_main = ( D_R_in < ( Nx / 2 )) ? 1.6 * (float) D_R_in : 1.6 * 0.5 * (float) Nx;
+	}
+
+	res_sub  = 0.1 * res_sub;
+	res_main = 0.1 * res_main;
+
+	Check ( "D_center",   D_center,   Nx >> 1 );
+	Check ( "D_R_inside", D_R_inside, D_R_in );
+	Check ( "reso_sub",   reso_sub,   res_sub );
+	Check ( "reso_main",  reso_main,  res_main );
+
+
+/*
+ *	The tick limits:
+ */
+
+	int		h1, l1, h5, l5, h10, l10;
+
+	h1  = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN )) *  2.0 );
+	l1  = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN )) * -1.0 );
+	h5  = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN ) / 5.0 ) * 2.00 );
+	l5  = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN ) / 5.0 ) * 0.75 );
+	h10 = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN ) / 10.0 ) * 2.00 );
+	l10 = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN ) / 10.0 ) * 0.75 );
+
+	l5  /= 2;	l5++;	l5 *= 2;	l5++;	l5 *= -1;
+	l10 /= 2;	l10++;	l10 *= 2;	l10 *= -1;
+
+	Check ( "H_main1",  H_main1,  h1 );		Check ( "L_main1",  L_main1,  l1 );
+	Check ( "H_main5",  H_main5,  h5 );		Check ( "L_main5",  L_main5,  l5 );
+	Check ( "H_main10", H_main10, h10 );	Check ( "L_main10", L_main10, l10 );
+
+	h1  = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB )) *  2.0 );
+	l1  = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB )) * -1.0 );
+	h5  = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB ) / 5.0 ) * 2.00 );
+	l5  = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB ) / 5.0 ) * 0.75 );
+	h10 = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB ) / 10.0 ) * 2.00 );
+	l10 = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB ) / 10.0 ) * 0.75 );
+
+	l5  /= 2;	l5++;	l5 *= 2;	l5++;	l5 *= -1;
+	l10 /= 2;	l10++;	l10 *= 2;	l10 *= -1;
+
+	Check ( "H_sub1",  H_sub1,  h1 );		Check ( "L_sub1",  L_sub1,  l1 );
+	Check ( "H_sub5",  H_sub5,  h5 );		Check ( "L_sub5",  L_sub5,  l5 );
+	Check ( "H_sub10", H_sub10, h10 );		Check ( "L_sub10", L_sub10, l10 );
+
+
+/*
+ *	And "yry":
+ */
+
+	static int	old[Nx][4];
+
+	OldArc ( old, 0, D_R );
+	OldArc ( old, 1, D_R - (( F_MAIN_OUTSIDE == 1 ) ? TICK_MAIN10 : TICK_SUB10 ));
+	OldArc ( old, 2, D_R_in + 1 );
+	OldArc ( old, 3, D_R_in - (( F_MAIN_OUTSIDE == 1 ) ? TICK_SUB10 : TICK_MAIN10 ));
+
+	for ( int xg = 0; xg < Nx; xg++ )
+	{
+		for ( int n = 0; n < 4; n++ )
+		{
+			if (( yry[xg][n] != old[xg][n] ) && bad++ < 10 )
+				printf ( "yry[%d][%d] is %d, should be %d\n", xg, n, yry[xg][n], old[xg][n] );
+		}
+	}
+
+	printf ( "%d columns, yry is %zu bytes in flash (was %zu in RAM)\n",
+				Nx, sizeof ( yry ), sizeof ( old ));
+	printf ( "Main ticks %d to %d, sub ticks %d to %d\n", L_main1, H_main1, L_sub1, H_sub1 );
+	printf ( "%d problems\n", bad );
+
+	return bad ? 1 : 0;
+}
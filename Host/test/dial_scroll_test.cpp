@@ -0,0 +1,156 @@
+/*
+ *	"dial_scroll_test.cpp"
+ *
+ *	Checks that sliding cached scales on a straight dial ("DIAL_SCROLL" in "config.h")
+ *	paints the same picture as painting them. The program is built twice with
+ *	"DIAL_LINEAR" set (see "CMakeLists.txt"); the copy without "DIAL_SCROLL" tunes
+ *	across a band in steps of different sizes, both ways, and saves the dials to a
+ *	file, then the copy with it does the same and compares them with what's in the
+ *	file.
+ *
+ *	A slid scale can be up to 1/DIAL_CACHE_SUBPIX of a pixel away from where the other
+ *	copy paints it, which can change the edge of a tick by that much of a full color,
+ *	so the red, green and blue parts of every pixel have to be within "MAX_DIFF" and
+ *	almost all of the screen has to be exactly the same. The copy that slides them also
+ *	has to have actually done some sliding.
+ *
+ *	Usage:	dial_scroll_test_<size>_noscroll --dump file
+ *			dial_scroll_test_<size> --compare file
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "display.h"
+#include "dial.h"
+
+
+extern band_data	bandData[];
+extern uint8_t		activeBand;
+
+extern uint16_t*	GRAM65k;
+
+#if DIAL_SCROLL
+	extern uint32_t	dialScrolls;
+#endif
+
+#define	MAX_DIFF		( 64 / DIAL_CACHE_SUBPIX )	// Allowed difference per color component
+#define	MAX_CHANGED		2				// Percent of the pixels that can differ
+
+
+/*
+ *	The tuning: "count" steps of "step" Hz each.
+ */
+
+struct sweep
+{
+	int		count;
+	int		step;
+};
+
+static const sweep	sweeps[] =
+{
+	{ 300,     10 },				// Slowly up
+	{ 200,    100 },
+	{  60,  -1000 },				// Quickly back down
+	{ 100,    -50 },
+	{  20,  25000 },				// Far enough to need painting again
+	{ 150,     30 }
+};
+
+
+int main ( int argc, char* argv[] )
+{
+	bool		dump;
+	FILE*		file;
+	int			bad     = 0;
+	int			most    = 0;
+	uint32_t	frames  = 0;
+	uint32_t	changed = 0;
+
+	if ( argc != 3 || ( strcmp ( argv[1], "--dump" ) && strcmp ( argv[1], "--compare" )))
+	{
+		fprintf ( stderr, "Usage: %s --dump|--compare file\n", argv[0] );
+		return 2;
+	}
+
+	dump = strcmp ( argv[1], "--dump" ) == 0;
+	file = fopen ( argv[2], dump ? "wb" : "rb" );
+
+	if ( !file )
+	{
+		fprintf ( stderr, "Can't open %s\n", argv[2] );
+		return 2;
+	}
+
+	HostSerialQuiet ( true );
+	setup ();
+
+	uint16_t	image[DISP_W * DISP_H];
+	int			shift[3] = { 11, 5, 0 };			// Red, green and blue fields
+	int			mask[3]  = { 0x1F, 0x3F, 0x1F };
+	uint32_t	freq     = bandData[activeBand].lowLimit + 123456;
+
+	for ( const sweep& sw : sweeps )
+	{
+		for ( int ix = 0; ix < sw.count; ix++, frames++ )
+		{
+			freq += sw.step;
+			Dial ( freq );
+
+			if ( dump )
+			{
+				fwrite ( GRAM65k, sizeof ( uint16_t ), DISP_W * DISP_H, file );
+				continue;
+			}
+
+			if ( fread ( image, sizeof ( uint16_t ), DISP_W * DISP_H, file ) != DISP_W * DISP_H )
+			{
+				fprintf ( stderr, "%s is too short\n", argv[2] );
+				return 1;
+			}
+
+			for ( int px = 0; px < DISP_W * DISP_H; px++ )
+			{
+				uint16_t	got  = ( GRAM65k[px] >> 8 ) | ( GRAM65k[px] << 8 );	// Byte swapped
+				uint16_t	want = ( image[px] >> 8 ) | ( image[px] << 8 );
+
+				if ( got != want )
+					changed++;
+
+				for ( int c = 0; c < 3; c++ )
+				{
+					int diff = abs ((( got >> shift[c] ) & mask[c] ) - (( want >> shift[c] ) & mask[c] ));
+
+					most = max ( most, diff );
+
+					if ( diff > MAX_DIFF && bad++ < 10 )
+						printf ( "%u Hz pixel %d: %04x, should be %04x\n", freq, px, got, want );
+				}
+			}
+		}
+	}
+
+	fclose ( file );
+
+	if ( dump )
+		return 0;
+
+	double	percent = 100.0 * changed / ((double) frames * DISP_W * DISP_H );
+
+	printf ( "%u frames compared, largest difference %d, %.3f%% of the pixels different, %d out of tolerance\n",
+				frames, most, percent, bad );
+
+	if (( percent > MAX_CHANGED ) && bad++ < 10 )
+		printf ( "Too many pixels are different\n" );
+
+	#if DIAL_SCROLL
+
+		printf ( "%u scales slid\n", dialScrolls );
+
+		if (( dialScrolls < frames / 2 ) && bad++ < 10 )
+			printf ( "Should have slid at least %u\n", frames / 2 );
+
+	#endif
+
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,273 @@
+/*
+ *	"i2c_timing_test.cpp"
+ *
+ *	Checks the timing of the bit-banged Si5351 bus against the I2C specification
+ *	(NXP UM10204, which the Si5351 datasheet refers to) for the speed the program was
+ *	built with ("SI_I2C_SPEED"). It records every change on "SI_SDA" and "SI_SCL" in
+ *	simulated time while the Si5351 is set up and tuned across its whole range, then
+ *	goes through the edges checking the setup and hold times, the clock high and low
+ *	times, the clock rate and the bus free time between transactions. It also checks
+ *	every transaction is a whole number of bytes and starts with the Si5351's address.
+ *
+ *	Usage:	i2c_timing_test_<speed>
+ */
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+#include "si5351.h"
+
+void setup ( void ) {}						// The sketch isn't part of this
+void loop ( void ) {}
+
+
+/*
+ *	Minimum times in nanoseconds (except "fMax"), from UM10204 table 10:
+ */
+
+struct bus_spec
+{
+	const char*	name;
+	uint32_t	fMax;						// Highest SCL frequency (Hz)
+	uint32_t	hdSta;						// tHD;STA	START hold time
+	uint32_t	low;						// tLOW		SCL LOW time
+	uint32_t	high;						// tHIGH	SCL HIGH time
+	uint32_t	hdDat;						// tHD;DAT	Data hold time
+	uint32_t	suDat;						// tSU;DAT	Data set up time
+	uint32_t	suSto;						// tSU;STO	STOP set up time
+	uint32_t	buf;						// tBUF		Bus free time between STOP and START
+};
+
+static const bus_spec specs[] =
+{
+	{ "standard mode (100KHz)", 100000, 4000, 4700, 4000, 0, 250, 4000, 4700 },
+	{ "fast mode (400KHz)",     400000,  600, 1300,  600, 0, 100,  600, 1300 }
+};
+
+static const bus_spec&	spec = specs[SI_I2C_SPEED];
+
+
+/*
+ *	The recorded edges:
+ */
+
+struct edge
+{
+	uint8_t		pin;
+	uint8_t		level;
+	uint64_t	ns;
+};
+
+static std::vector<edge>	edges;
+static uint8_t				level[2] = { HIGH, HIGH };	// SDA, SCL
+
+static void Record ( uint8_t pin, uint8_t val, uint64_t ns )
+{
+	int ix;
+
+	if ( pin == SI_SDA )		ix = 0;
+	else if ( pin == SI_SCL )	ix = 1;
+	else						return;
+
+	if ( level[ix] == val )					// Not an edge
+		return;
+
+	level[ix] = val;
+	edges.push_back ({ pin, val, ns });
+}
+
+
+/*
+ *	Each check keeps the shortest time seen so it can be reported:
+ */
+
+enum { C_HDSTA, C_LOW, C_HIGH, C_HDDAT, C_SUDAT, C_SUSTO, C_BUF, C_PERIOD, NBR_CHECKS };
+
+static const char*	checkName[NBR_CHECKS] =
+	{ "tHD;STA", "tLOW", "tHIGH", "tHD;DAT", "tSU;DAT", "tSU;STO", "tBUF", "SCL period" };
+
+static uint64_t		shortest[NBR_CHECKS];
+static uint32_t		checked[NBR_CHECKS];
+static int			bad = 0;
+
+static void Check ( int c, uint64_t ns, uint64_t min, uint64_t at )
+{
+	checked[c]++;
+
+	if ( ns < shortest[c] )
+		shortest[c] = ns;
+
+	if ( ns < min && bad++ < 10 )
+		printf ( "%s is %llu ns at %llu ns, minimum is %llu ns\n", checkName[c],
+					(unsigned long long) ns, (unsigned long long) at, (unsigned long long) min );
+}
+
+static void Fail ( const char* what, uint64_t at )
+{
+	if ( bad++ < 10 )
+		printf ( "%s at %llu ns\n", what, (unsigned long long) at );
+}
+
+
+int main ( void )
+{
+	HostSerialQuiet ( true );
+	HostSetPinObserver ( Record );
+
+	Si5351_Init ( CLK_DRIVE_8MA );
+
+	for ( uint64_t f = 1500; f <= 280000000; f = f * 1011 / 1000 + 1 )
+	{
+		Set_VFO_Freq ( f );
+		Set_Carrier_Freq ( f / 2 + 1000, C_OSC_QUAD, CLK_DRIVE_4MA );
+	}
+
+	HostSetPinObserver ( NULL );
+
+
+/*
+ *	Now go through the edges:
+ */
+
+	uint8_t		sda = HIGH, scl = HIGH;
+	bool		busy     = false;				// Between a START and a STOP
+	bool		stopped  = false;				// There's been a STOP
+	bool		firstLow = false;				// Next SCL fall is the first since START
+	bool		newData  = false;				// SDA changed since SCL went LOW
+	uint64_t	tStart = 0, tStop = 0, tRise = 0, tFall = 0, tData = 0;
+	uint64_t	tLastRise = 0;
+	int			bits = 0;						// Clock pulses in this transaction
+	uint32_t	byte = 0;
+	uint32_t	transactions = 0;
+	uint64_t	period = 1000000000ULL / spec.fMax;
+
+	for ( int c = 0; c < NBR_CHECKS; c++ )
+		shortest[c] = ~0ULL;
+
+	for ( size_t ix = 0; ix < edges.size (); ix++ )
+	{
+		const edge&	e = edges[ix];
+
+		if ( e.pin == SI_SCL )
+		{
+			if ( e.level == HIGH )
+			{
+				if ( busy )
+				{
+					Check ( C_LOW, e.ns - tFall, spec.low, e.ns );
+
+					if ( newData )						// Data changed in this LOW time
+						Check ( C_SUDAT, e.ns - tData, spec.suDat, e.ns );
+
+					if ( bits > 0 )
+						Check ( C_PERIOD, e.ns - tLastRise, period, e.ns );
+
+					if ( bits % 9 < 8 )					// Not the acknowledge bit
+						byte = ( byte << 1 ) | sda;
+
+					else if ( bits == 8 && byte != ( SI_I2C_ADDR << 1 ))
+						Fail ( "Wrong address", e.ns );
+
+					bits++;
+					newData   = false;
+					tLastRise = e.ns;
+				}
+
+				tRise = e.ns;
+			}
+
+			else										// SCL falling
+			{
+				if ( busy && firstLow )
+					Check ( C_HDSTA, e.ns - tStart, spec.hdSta, e.ns );
+
+				else if ( busy )
+					Check ( C_HIGH, e.ns - tRise, spec.high, e.ns );
+
+				else
+					Fail ( "SCL went LOW outside a transaction", e.ns );
+
+				if ( bits % 9 == 0 )
+					byte = 0;
+
+				firstLow = false;
+				tFall = e.ns;
+			}
+
+			scl = e.level;
+		}
+
+		else											// SDA
+		{
+			if ( scl == HIGH && e.level == LOW )		// START
+			{
+				if ( busy )
+					Fail ( "START in the middle of a transaction", e.ns );
+
+				if ( stopped )
+					Check ( C_BUF, e.ns - tStop, spec.buf, e.ns );
+
+				busy     = true;
+				firstLow = true;
+				bits     = 0;
+				byte     = 0;
+				tStart   = e.ns;
+			}
+
+			else if ( scl == HIGH )						// STOP
+			{
+				Check ( C_SUSTO, e.ns - tRise, spec.suSto, e.ns );
+
+				if ( bits < 10 || ( bits - 1 ) % 9 )		// The last clock is part of the STOP
+					Fail ( "STOP in the middle of a byte", e.ns );
+
+				busy    = false;
+				stopped = true;
+				tStop   = e.ns;
+				transactions++;
+			}
+
+			else										// Data change
+			{
+				Check ( C_HDDAT, e.ns - tFall, spec.hdDat, e.ns );
+				tData   = e.ns;
+				newData = true;
+			}
+
+			sda = e.level;
+		}
+	}
+
+	if ( busy )
+		Fail ( "Bus left in the middle of a transaction", tStart );
+
+	printf ( "I2C %s, %u transactions, %zu edges\n\n", spec.name, transactions, edges.size ());
+	printf ( "  %-12s %10s %12s %8s\n", "", "min ns", "shortest ns", "checks" );
+
+	for ( int c = 0; c < NBR_CHECKS; c++ )
+	{
+		uint64_t	min = 0;
+
+		switch ( c )
+		{
+			case C_HDSTA:	min = spec.hdSta;	break;
+			case C_LOW:		min = spec.low;		break;
+			case C_HIGH:	min = spec.high;	break;
+			case C_HDDAT:	min = spec.hdDat;	break;
+			case C_SUDAT:	min = spec.suDat;	break;
+			case C_SUSTO:	min = spec.suSto;	break;
+			case C_BUF:		min = spec.buf;		break;
+			case C_PERIOD:	min = period;		break;
+		}
+
+		printf ( "  %-12s %10llu %12llu %8u\n", checkName[c], (unsigned long long) min,
+					checked[c] ? (unsigned long long) shortest[c] : 0ULL, checked[c] );
+
+		if ( checked[c] == 0 && bad++ < 10 )
+			printf ( "%s was never checked\n", checkName[c] );
+	}
+
+	printf ( "\n%d problems\n", bad );
+
+	return bad ? 1 : 0;
+}
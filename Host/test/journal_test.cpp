@@ -0,0 +1,307 @@
+/*
+ *	"journal_test.cpp"
+ *
+ *	Tests the settings journal (see "journal.cpp") on the host's pretend flash. The
+ *	journal is started again ("JournalBegin()") after each step, as if the radio had
+ *	been turned off and on, and it has to come back with the latest settings for
+ *	every band:
+ *
+ *		After some saves.
+ *		After the power went off part way through writing a record.
+ *		After thousands of saves, which go round all the sectors several times.
+ *		After the power went off part way through starting a new sector.
+ *		After erasing a new sector didn't work.
+ *
+ *	Saving the same thing twice mustn't write anything, and if the band table is
+ *	changed, nothing that was saved for the old one can come back, even if it's
+ *	changed back again afterwards.
+ *
+ *	It finishes with how many saves each sector erase is worth and how long the
+ *	flash would last at one save a minute.
+ */
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "config.h"
+#include "journal.h"
+
+void setup ( void ) {}						// The sketch isn't part of this
+void loop ( void ) {}
+
+#define	BANDS		10
+#define	ERASE_LIFE	10000					// Erases a sector is good for
+#define	HEADER		16						// Sizes of a sector header and a record
+#define	RECORD		24						// in "journal.cpp"
+
+
+static band_data		bands[BANDS];
+static journal_state	latest[BANDS];		// What should come back for each band
+static bool				saved[BANDS];
+static int				lastBand = -1;
+static int				bad = 0;
+
+
+/*
+ *	"MakeState()" makes up some settings for a band from a frequency, "Remember()"
+ *	notes them as what should come back, and "Save()" saves them.
+ */
+
+static journal_state MakeState ( int band, uint32_t freq )
+{
+	journal_state	st;
+
+	memset ( &st, 0, sizeof ( st ));
+
+	st.band      = band;
+	st.rxFreq    = freq;
+	st.txFreq    = freq + 1000;
+	st.clarCount = (int16_t) ( freq % 200 ) - 100;
+	st.mode      = freq % 5;
+	st.incr      = freq % 3;
+	st.flags     = freq & ( JS_SPLIT | JS_CLAR );
+
+	return st;
+}
+
+static void Remember ( const journal_state& st )
+{
+	latest[st.band] = st;
+	saved[st.band]  = true;
+	lastBand        = st.band;
+}
+
+static bool Save ( int band, uint32_t freq )
+{
+	journal_state	st = MakeState ( band, freq );
+
+	if ( !JournalSave ( &st ))
+		return false;
+
+	Remember ( st );
+	return true;
+}
+
+static uint32_t Erases ( void )
+{
+	uint32_t	total = 0;
+
+	for ( int sec = 0; sec < JOURNAL_SECTORS; sec++ )
+		total += hostFlash.erases[sec];
+
+	return total;
+}
+
+
+/*
+ *	"Check()" starts the journal again and makes sure everything comes back.
+ */
+
+static void Check ( const char* when )
+{
+	journal_state	st;
+
+	if ( !JournalBegin ( bands, BANDS ) && bad++ < 10 )
+		printf ( "%s: the journal wouldn't start\n", when );
+
+	for ( int band = 0; band < BANDS; band++ )
+	{
+		bool	found = JournalBand ( band, &st );
+
+		if (( found != saved[band] ) && bad++ < 10 )
+			printf ( "%s: band %d %s\n", when, band, found ? "shouldn't be there" : "is missing" );
+
+		else if ( found && (( st.rxFreq != latest[band].rxFreq ) || ( st.txFreq != latest[band].txFreq )
+								|| ( st.clarCount != latest[band].clarCount ) || ( st.mode != latest[band].mode )
+								|| ( st.incr != latest[band].incr ) || ( st.flags != latest[band].flags ))
+					&& bad++ < 10 )
+			printf ( "%s: band %d has %u, should be %u\n", when, band, st.rxFreq, latest[band].rxFreq );
+	}
+
+	bool	found = JournalLast ( &st );
+
+	if (( found != ( lastBand >= 0 )) || ( found && ( st.band != lastBand )))
+		if ( bad++ < 10 )
+			printf ( "%s: the last band is %d, should be %d\n", when, found ? st.band : -1, lastBand );
+}
+
+
+int main ( void )
+{
+	HostSerialQuiet ( true );
+
+	for ( int ix = 0; ix < BANDS; ix++ )
+	{
+		memset ( &bands[ix], 0, sizeof ( band_data ));
+
+		bands[ix].lowLimit = 1800000 + ix * 2000000;
+		bands[ix].topLimit = bands[ix].lowLimit + 500000;
+	}
+
+	Check ( "New flash" );
+
+
+/*
+ *	A few saves, and the same thing again:
+ */
+
+	Save ( 3, 7100000 );
+	Save ( 0, 1850000 );
+	Save ( 3, 7150000 );
+	Check ( "First saves" );
+
+	uint32_t	writes = hostFlash.writes;
+
+	Save ( 3, 7150000 );
+
+	if (( hostFlash.writes != writes ) && bad++ < 10 )
+		printf ( "Saving the same thing again wrote to the flash\n" );
+
+
+/*
+ *	The power goes off part way through a record, so the one before it has to come
+ *	back. The next save after that has to work.
+ */
+
+	journal_state	torn = MakeState ( 3, 7200000 );
+
+	HostFlashCutAfter ( 10 );
+	JournalSave ( &torn );
+	HostFlashCutAfter ( -1 );
+	Check ( "Torn record" );
+
+	Save ( 3, 7250000 );
+	Check ( "Save after a torn record" );
+
+
+/*
+ *	Lots of saves; every band, in a shuffled order, so the sectors get used over
+ *	and over again. Check now and then.
+ */
+
+	int		saves = 0;
+
+	for ( int ix = 0; ix < 5000; ix++ )
+	{
+		int		band = ( ix * 7 + ix / 13 ) % BANDS;
+
+		if ( !Save ( band, bands[band].lowLimit + ( ix * 10 ) % 500000 ) && bad++ < 10 )
+			printf ( "Save %d failed\n", ix );
+
+		saves++;
+
+		if ( ix % 997 == 0 )
+			Check ( "Lots of saves" );
+	}
+
+	Check ( "After lots of saves" );
+
+
+/*
+ *	The power goes off while a new sector is being started, at different places in
+ *	the copying of the other bands into it:
+ */
+
+	for ( int cut = 0; cut < 24 * BANDS; cut += 40 )
+	{
+		while ( true )								// Save until one starts a sector
+		{
+			journal_state	st = MakeState ( saves % BANDS, bands[saves % BANDS].lowLimit + saves );
+			uint32_t		erases = Erases ();
+
+			HostFlashCutAfter ( RECORD + HEADER + cut );	// This record, a header and some copies
+			JournalSave ( &st );
+			HostFlashCutAfter ( -1 );
+
+			if ( Erases () != erases )				// Got cut starting one
+				break;
+
+			Remember ( st );						// This one got all the way
+			saves++;
+		}
+
+		Check ( "Cut starting a sector" );
+
+		Save ( saves % BANDS, bands[saves % BANDS].lowLimit + 123 );
+		Check ( "Save after a cut sector" );
+		saves++;
+	}
+
+
+/*
+ *	Erasing doesn't work for a while. The saves that need a new sector fail, and
+ *	nothing can get written into a sector that wasn't erased.
+ */
+
+	HostFlashEraseFails ( true );
+
+	for ( int ix = 0; ix < 400; ix++, saves++ )
+		Save ( saves % BANDS, bands[saves % BANDS].lowLimit + 7 * saves );
+
+	HostFlashEraseFails ( false );
+	Check ( "Erase failed" );
+
+	Save ( 1, bands[1].lowLimit + 99 );
+	Check ( "Save after a failed erase" );
+	saves++;
+
+
+/*
+ *	A different band table; nothing from the old one can come back.
+ */
+
+	bands[4].topLimit += 1000;
+
+	memset ( saved, 0, sizeof ( saved ));
+	lastBand = -1;
+
+	Check ( "Changed bands" );
+
+	Save ( 4, bands[4].lowLimit );
+	Check ( "Changed bands saved" );
+
+
+/*
+ *	And back to the first one. What was saved for it before is older than what was
+ *	saved for the changed one, so it can't come back either.
+ */
+
+	bands[4].topLimit -= 1000;
+
+	memset ( saved, 0, sizeof ( saved ));
+	lastBand = -1;
+
+	Check ( "Bands changed back" );
+
+	Save ( 2, bands[2].lowLimit + 50 );
+	Check ( "Bands changed back saved" );
+
+
+/*
+ *	And the wear:
+ */
+
+	uint32_t	most = 0, total = 0;
+
+	printf ( "%6s %8s\n", "Sector", "Erases" );
+
+	for ( int sec = 0; sec < JOURNAL_SECTORS; sec++ )
+	{
+		printf ( "%6d %8u\n", sec, hostFlash.erases[sec] );
+		most   = max ( most, hostFlash.erases[sec] );
+		total += hostFlash.erases[sec];
+	}
+
+	double	perErase = (double) saves / most;
+
+	printf ( "%d saves, %u erases, %.0f saves for each erase of the busiest sector\n",
+				saves, total, perErase );
+	printf ( "At one save a minute, the flash would last %.1f years\n",
+				perErase * ERASE_LIFE / ( 60.0 * 24 * 365 ));
+
+	if (( perErase < 100 ) && bad++ < 10 )
+		printf ( "Wearing the flash out too quickly\n" );
+
+	printf ( "\n%d problems\n", bad );
+
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/*
+ *	"pll_reset_test.cpp"
+ *
+ *	Sweeps the VFO across each band, up and then back down, the way "task0()" would
+ *	set the Si5351, and counts how many times the PLL gets reset (register 177 bit 7)
+ *	by decoding what goes out on the Si5351 bus. It does that once with the band's
+ *	fixed plan from "PlanBand()" and once looking up "M" and "R" from the table for
+ *	each frequency the way it used to be done.
+ *
+ *	The bands are the ones in "bandData" plus the commented out FT-7 ones and a few
+ *	made up ones whose VFO range crosses places where the table changes "M". Any band
+ *	that gets a fixed plan must not have a single reset.
+ *
+ *	Usage:	pll_reset_test
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "si5351.h"
+
+
+extern band_data	bandData[];
+extern SI_plan		bandPlan[];
+extern mode_data	modeData[];
+
+
+uint32_t	BandVFOFreq ( uint8_t band, uint32_t freq );
+void		PlanBand ( uint8_t band );
+
+#define	NBR_STEPS	2000					// Steps across the band each way
+
+
+/*
+ *	The extra bands:
+ *
+ *		|    vfoA   |    vfoB   |  refFreq  |  vfoRef  |  lowLimit  |  topLimit  |incr|bSW|dir| mode
+ */
+
+static const band_data	extraBands[] =
+{
+	{  3668000UL,  3668000UL,  3500000UL,  5500000UL,  3500000UL,   4000000UL, 1, 0, -1, MODE_LSB },
+	{  7040000UL,  7040000UL,  7000000UL,  5500000UL,  7000000UL,   7300000UL, 1, 0, -1, MODE_USB },
+	{ 14060000UL, 14060000UL, 14000000UL,  5500000UL, 14000000UL,  14350000UL, 1, 0, -1, MODE_USB },
+	{ 21150000UL, 21150000UL, 21000000UL,  5500000UL, 21000000UL,  21450000UL, 1, 0, -1, MODE_USB },
+	{ 28250000UL, 28250000UL, 28500000UL,  5500000UL, 28000000UL,  28500000UL, 1, 0, -1, MODE_USB },
+	{  6400000UL,  6400000UL,  6300000UL,  6300000UL,  6300000UL,   6700000UL, 1, 0, +1, MODE_USB },	// Crosses 6.5MHz
+	{ 13000000UL, 13000000UL, 12800000UL, 12800000UL, 12800000UL,  13200000UL, 1, 0, +1, MODE_USB },	// Crosses 13MHz
+	{  1000000UL,  1000000UL,   530000UL,   530000UL,   530000UL,   1700000UL, 1, 0, +1, MODE_AM  }	// Too wide
+};
+
+
+/*
+ *	Decode the Si5351 bus. Only single register writes to 177 matter:
+ */
+
+static uint8_t		sda = HIGH, scl = HIGH;
+static bool			busy = false;
+static int			bits = 0;
+static uint8_t		bytes[3];
+static uint32_t		resets = 0;
+
+static void WatchI2C ( uint8_t pin, uint8_t val, uint64_t ns )
+{
+	(void) ns;
+
+	if ( pin == SI_SCL )
+	{
+		if ( busy && ( val == HIGH ) && ( scl == LOW ))
+		{
+			int	byteNo = bits / 9;
+
+			if (( bits % 9 < 8 ) && ( byteNo < 3 ))
+				bytes[byteNo] = ( bytes[byteNo] << 1 ) | sda;
+
+			bits++;
+		}
+
+		scl = val;
+	}
+
+	else if ( pin == SI_SDA )
+	{
+		if (( scl == HIGH ) && ( sda == HIGH ) && ( val == LOW ))		// START
+		{
+			busy = true;
+			bits = 0;
+			memset ( bytes, 0, sizeof ( bytes ));
+		}
+
+		if (( scl == HIGH ) && ( sda == LOW ) && ( val == HIGH ))		// STOP
+		{
+			busy = false;
+
+			if (( bits == 28 ) && ( bytes[1] == 177 ) && ( bytes[2] & 0x80 ))
+				resets++;
+		}
+
+		sda = val;
+	}
+}
+
+
+/*
+ *	"Sweep()" tunes band 0 from one end to the other and back and returns the number
+ *	of PLL resets. The first setting doesn't count; changing bands can reset the PLL.
+ */
+
+static uint32_t Sweep ( SI_plan* plan )
+{
+	const band_data&	b   = bandData[0];
+	int16_t				adj = modeData[b.opMode].vfoAdjust;
+	uint32_t			first;
+
+	for ( int ix = 0; ix <= 2 * NBR_STEPS; ix++ )
+	{
+		int			step = ix <= NBR_STEPS ? ix : 2 * NBR_STEPS - ix;
+		uint32_t	freq = b.lowLimit + (uint64_t) ( b.topLimit - b.lowLimit ) * step / NBR_STEPS;
+
+		Set_VFO_Freq ( BandVFOFreq ( 0, freq ) + adj, VFO_DRIVE, plan );
+
+		if ( ix == 0 )
+			first = resets;
+	}
+
+	return resets - first;
+}
+
+
+int main ( void )
+{
+	int	bad = 0;
+
+	HostSerialQuiet ( true );
+
+	setup ();									// Plans the bands in "bandData"
+
+	HostSetPinObserver ( WatchI2C );
+
+	printf ( "  %-19s  %-5s %-7s %s\n", "VFO range (Hz)", "M", "resets", "resets without a plan" );
+
+	band_data	saved = bandData[0];
+	SI_plan		savedPlan = bandPlan[0];
+	int			count = 1 + sizeof ( extraBands ) / sizeof ( extraBands[0] );
+
+	for ( int n = 0; n < count; n++ )
+	{
+		bandData[0] = n ? extraBands[n - 1] : saved;	// Everything runs in band 0
+
+		if ( n )
+			PlanBand ( 0 );
+
+		SI_plan		table = {};
+		char		M[8] = "none";
+		uint32_t	lowVFO  = BandVFOFreq ( 0, bandData[0].lowLimit );
+		uint32_t	highVFO = BandVFOFreq ( 0, bandData[0].topLimit );
+		uint32_t	fixed   = Sweep ( &bandPlan[0] );
+		uint32_t	before  = Sweep ( &table );
+
+		if ( bandPlan[0].fixed )
+			sprintf ( M, "%u", bandPlan[0].M );
+
+		printf ( "  %9u-%-9u  %-5s %-7u %u\n", min ( lowVFO, highVFO ), max ( lowVFO, highVFO ),
+					M, fixed, before );
+
+		if ( bandPlan[0].fixed && fixed )
+			bad++;
+	}
+
+	bandData[0] = saved;
+	bandPlan[0] = savedPlan;
+
+
+	printf ( "\n%d bands with a plan reset the PLL\n", bad );
+
+	return bad ? 1 : 0;
+}
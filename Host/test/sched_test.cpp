@@ -0,0 +1,177 @@
+/*
+ *	"sched_test.cpp"
+ *
+ *	Tests the scheduler (see "sched.cpp") with a "loop()" like the VFO program's and
+ *	some made up jobs:
+ *
+ *		Two jobs every 25mS, which have to run on their beat every time, in the
+ *		order they were added.
+ *		One every 7mS and one every 1000mS (longer than the timer wheel goes round).
+ *		One that only runs when "loop()" asks, after a task wakes "loop()" up; it
+ *		has to run the same millisecond.
+ *		One that takes 40mS once; the others have to skip the times they missed and
+ *		carry on on their beat.
+ *
+ *	"loop()" has to sleep in between, so it should run a lot less often than once a
+ *	millisecond.
+ */
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+#include "sched.h"
+
+#define	RUN_MS		10000					// How long to run for
+
+static std::vector<uint32_t>	runs[5];	// When each job ran
+static std::vector<int>			order;		// Which jobs ran, in order
+
+static uint32_t		startMs;
+static uint32_t		wokenMs  = 0;
+static bool			paint    = false;		// Something for "loop()" to do
+static int			paintJob;
+static uint32_t		passes   = 0;			// Times through "loop()"
+
+static void Job ( int ix )
+{
+	runs[ix].push_back ( millis () - startMs );
+	order.push_back ( ix );
+}
+
+static void JobA ( void ) { Job ( 0 ); }
+static void JobB ( void ) { Job ( 1 ); }
+static void JobC ( void ) { Job ( 2 ); }
+
+static uint32_t		slowMs = 0;				// When the slow one ran
+
+static void JobD ( void )					// The slow one, the 5th time
+{
+	Job ( 3 );
+
+	if ( runs[3].size () == 5 )
+	{
+		slowMs = millis () - startMs;
+		delayMicroseconds ( 40000 );
+	}
+}
+
+static void Paint ( void )
+{
+	Job ( 4 );
+	paint = false;
+}
+
+
+/*
+ *	A task that wakes "loop()" up every 333mS with something to do:
+ */
+
+static void Waker ( void* arg )
+{
+	(void) arg;
+
+	while ( true )
+	{
+		delay ( 333 );
+
+		wokenMs = millis () - startMs;
+		paint   = true;
+		SchedWake ();
+	}
+}
+
+void setup ( void ) {}
+
+void loop ( void )
+{
+	passes++;
+
+	SchedRun ();
+
+	if ( paint )
+		SchedRunJob ( paintJob );
+
+	else
+		SchedSleep ();
+}
+
+
+static int	bad = 0;
+
+int main ( void )
+{
+	HostSerialQuiet ( true );
+
+	startMs = millis ();
+
+	SchedAdd ( "A", JobA, 25 );
+	SchedAdd ( "B", JobB, 25 );
+	SchedAdd ( "C", JobC, 7, 3 );
+	SchedAdd ( "D", JobD, 1000, 500 );
+	paintJob = SchedAdd ( "Paint", Paint, 0 );
+
+	xTaskCreatePinnedToCore ( Waker, "Waker", 4096, NULL, 1, NULL, 0 );
+
+	HostRunFor ( RUN_MS * 1000 );
+
+
+/*
+ *	The jobs with a period have to run on their beat, except straight after the slow
+ *	one, when they're late. The times they missed while it was running are skipped.
+ */
+
+	static const uint32_t	period[] = { 25, 25, 7, 1000 };
+	static const uint32_t	first[]  = {  0,  0, 3,  500 };
+
+	for ( int ix = 0; ix < 4; ix++ )
+	{
+		for ( size_t r = 0; r < runs[ix].size (); r++ )
+		{
+			uint32_t	ms   = runs[ix][r];
+			bool		late = ( ms > slowMs ) && ( ms <= slowMs + 41 );
+
+			if ((( ms < first[ix] ) || (( ms - first[ix] ) % period[ix] != 0 )) && !late )
+				if ( bad++ < 10 )
+					printf ( "Job %c ran at %u mS, off its beat\n", 'A' + ix, ms );
+		}
+
+		uint32_t	beats   = ( RUN_MS - first[ix] ) / period[ix] + 1;
+		uint32_t	skipped = beats - runs[ix].size ();
+
+		printf ( "Job %c: %zu runs, %u skipped\n", 'A' + ix, runs[ix].size (), skipped );
+
+		if (( runs[ix].size () > beats || skipped > 40 / period[ix] + 1 ) && bad++ < 10 )
+			printf ( "Job %c should have run %u times, less the ones the slow job held up\n",
+						'A' + ix, beats );
+	}
+
+	for ( size_t ix = 1; ix < order.size (); ix++ )
+		if (( order[ix] == 0 ) && ( order[ix - 1] == 1 ) && bad++ < 10 )
+			printf ( "Job B ran before job A\n" );
+
+
+/*
+ *	"loop()" has to paint as soon as it's woken up, and sleep the rest of the time.
+ */
+
+	printf ( "Paint: %zu runs, last woken at %u mS\n", runs[4].size (), wokenMs );
+
+	if (( runs[4].size () != RUN_MS / 333 ) && bad++ < 10 )
+		printf ( "Paint should have run %u times\n", RUN_MS / 333 );
+
+	for ( size_t r = 0; r < runs[4].size (); r++ )
+		if (( runs[4][r] - 333 * ( r + 1 ) > 1 ) && bad++ < 10 )
+			printf ( "Paint %zu ran at %u mS\n", r + 1, runs[4][r] );
+
+	printf ( "loop() ran %u times in %u mS\n", passes, RUN_MS );
+
+	if (( passes > RUN_MS / 3 ) && bad++ < 10 )
+		printf ( "loop() isn't sleeping\n" );
+
+	HostSerialQuiet ( false );
+	SchedDump ();
+
+	printf ( "\n%d problems\n", bad );
+
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+/*
+ *	"si5351_math_test.cpp"
+ *
+ *	Checks "DoTheMath()" against a reference version that does the sums with 128 bit
+ *	integers, so nothing is ever rounded until the end. For every frequency in the
+ *	Si5351's range (1.5KHz to 280MHz) tried with a few crystal frequencies and
+ *	correction factors, "M", "R", "a", "b", "c" and the "P" values have to be exactly
+ *	what the reference gets. The frequencies are tried going up and then coming back
+ *	down with the same plan, so picking a new "M" and "R" when the frequency leaves the
+ *	range of the old ones gets tested as well.
+ *
+ *	It also reports the worst output frequency error for the old floating point "b"
+ *	and the new one, as a fraction of the smallest step "b" can make at that frequency.
+ *	The new one should never be more than half a step out.
+ *
+ *	Usage:	si5351_math_test
+ */
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+#include "si5351.h"
+
+void setup ( void ) {}						// The sketch isn't part of this
+void loop ( void ) {}
+
+typedef unsigned __int128 u128;
+
+
+/*
+ *	The reference. "M" and "R" come from the original chain of comparisons:
+ */
+
+static void RefMR ( uint32_t freq, uint32_t& M, uint32_t& R )
+{
+	if		( freq > 150000000 ) { M =    4; R = 0; }
+	else if ( freq >= 63000000 ) { M =    6; R = 0; }
+	else if ( freq >= 27500000 ) { M =   14; R = 0; }
+	else if ( freq >= 13000000 ) { M =   30; R = 0; }
+	else if ( freq >=  6500000 ) { M =   62; R = 0; }
+	else if ( freq >=  3000000 ) { M =  126; R = 0; }
+	else if ( freq >=  1500000 ) { M =  280; R = 0; }
+	else if ( freq >=   700000 ) { M =  600; R = 0; }
+	else if ( freq >=   330000 ) { M = 1280; R = 0; }
+	else if ( freq >=   150000 ) { M = 1300; R = 1; }
+	else if ( freq >=    67000 ) { M = 1500; R = 2; }
+	else if ( freq >=    30300 ) { M = 1600; R = 3; }
+	else if ( freq >=    14000 ) { M = 1800; R = 4; }
+	else if ( freq >=     7000 ) { M = 1800; R = 5; }
+	else if ( freq >=     3500 ) { M = 1800; R = 6; }
+	else						 { M = 1800; R = 7; }
+}
+
+
+/*
+ *	The PLL ratio is "freq * M * 2^R * ( 1e9 + corr ) / ( xtal * 1e9 )", and "b" is the
+ *	fraction times "c" rounded to the nearest whole number:
+ */
+
+static void RefMath ( uint32_t freq, uint32_t xtal, int32_t corr, SI_math& p )
+{
+	freq = std::min ( std::max ( freq, 1500U ), 280000000U );
+
+	RefMR ( freq, p.M, p.R );
+
+	u128	num = (u128) freq * p.M << p.R;
+	u128	den = (u128) xtal * 1000000000ULL;
+
+	num *= (u128) ( 1000000000LL + corr );
+
+	p.c = 0xFFFFF;
+	p.a = (uint32_t) ( num / den );
+	p.b = (uint32_t) ((( num % den ) * p.c * 2 + den ) / ( den * 2 ));
+
+	if ( p.b == p.c )
+	{
+		p.a++;
+		p.b = 0;
+	}
+
+	p.dd = ( 128 * p.b ) / p.c;
+	p.P1 = 128 * p.a + p.dd - 512;
+	p.P2 = 128 * p.b - p.c * p.dd;
+	p.P3 = p.c;
+}
+
+
+/*
+ *	The old floating point "a" and "b" (with the correction applied to the frequency
+ *	the way the old code did it) are only used for the error report:
+ */
+
+static void OldMath ( uint32_t freq, uint32_t xtal, int32_t corr, uint32_t M, uint32_t R,
+						uint32_t& a, uint32_t& b )
+{
+	freq = freq + (int32_t) (((( ((int64_t) corr ) << 31 ) / 1000000000LL ) * freq ) >> 31 );
+	freq = ( freq * M ) << R;
+
+	a = freq / xtal;
+	b = (long) ( (float) ( freq - a * xtal ) * (float) 0xFFFFF / (float) xtal );
+}
+
+
+/*
+ *	How far (in steps of "b") the output is from "freq" for a given "a" and "b":
+ */
+
+static double Error ( uint32_t freq, uint32_t xtal, int32_t corr, const SI_math& p, uint32_t a, uint32_t b )
+{
+	long double	xtalHz = (long double) xtal * 1e9L / ( 1e9L + corr );
+	long double	step   = xtalHz / p.c / ((long double) p.M * ( 1 << p.R ));
+	long double	out    = xtalHz * a / ((long double) p.M * ( 1 << p.R )) + step * b;
+
+	return (double) ( fabsl ( out - freq ) / step );
+}
+
+
+static int bad = 0;
+
+static bool Same ( const SI_math& s, const SI_math& r )
+{
+	return s.M == r.M && s.R == r.R && s.a == r.a && s.b == r.b && s.c == r.c
+		&& s.dd == r.dd && s.P1 == r.P1 && s.P2 == r.P2 && s.P3 == r.P3;
+}
+
+
+int main ( void )
+{
+	static const uint32_t	xtals[] = { 25000000, 27000000, 24999123 };
+	static const int32_t	corrs[] = { 0, 1, -1, 12345, -98765, 10000000, -10000000 };
+
+	std::vector<uint32_t>	freqs;
+
+	for ( uint64_t f = 1500; f <= 280000000; f = f * 1003 / 1000 + 1 )
+		freqs.push_back ( f );
+
+	static const uint32_t	edges[] =					// Both sides of every range change
+		{ 3500, 7000, 14000, 30300, 67000, 150000, 330000, 700000, 1500000, 3000000,
+		  6500000, 13000000, 27500000, 63000000, 150000000, 150000001, 280000000 };
+
+	for ( uint32_t e : edges )
+	{
+		freqs.push_back ( e - 1 );
+		freqs.push_back ( e );
+		freqs.push_back ( e + 1 );
+	}
+
+	for ( uint32_t f = 50000000; f <= 50010000; f += 10 )		// A bit of 6 meters in 10Hz steps
+		freqs.push_back ( f );
+
+	uint32_t	checks = 0;
+	double		worstOld = 0, worstNew = 0;
+
+	for ( uint32_t xtal : xtals )
+		for ( int32_t corr : corrs )
+		{
+			SI_plan		plan = {};
+
+			SetXtalFreq ( xtal );
+			SetCorrection ( corr );
+
+			for ( int pass = 0; pass < 2; pass++ )			// Up, then back down
+				for ( size_t n = 0; n < freqs.size (); n++ )
+				{
+					uint32_t	f = freqs[pass ? freqs.size () - 1 - n : n];
+					SI_math		s = {}, r = {};
+
+					DoTheMath ( f, &s, &plan );
+					RefMath ( f, xtal, corr, r );
+					checks++;
+
+					if ( !Same ( s, r ) && bad++ < 10 )
+						printf ( "%u Hz, xtal %u, corr %d: got M %u R %u a %u b %u, expected M %u R %u a %u b %u\n",
+									f, xtal, corr, s.M, s.R, s.a, s.b, r.M, r.R, r.a, r.b );
+
+					if ( f < 1500 || f > 280000000 )
+						continue;							// Clamped, so it's bound to be off
+
+					uint32_t	oldA, oldB;
+
+					OldMath ( f, xtal, corr, r.M, r.R, oldA, oldB );
+
+					worstNew = std::max ( worstNew, Error ( f, xtal, corr, r, r.a, r.b ));
+					worstOld = std::max ( worstOld, Error ( f, xtal, corr, r, oldA, oldB ));
+				}
+		}
+
+	printf ( "%u frequencies checked, %d wrong\n", checks, bad );
+	printf ( "Worst output error: float %.3f steps, integer %.3f steps\n", worstOld, worstNew );
+
+	if ( worstNew > 0.5001 && bad++ < 10 )
+		printf ( "Integer version is more than half a step out\n" );
+
+	return bad ? 1 : 0;
+
+}
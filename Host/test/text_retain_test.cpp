@@ -0,0 +1,210 @@
+/*
+ *	"text_retain_test.cpp"
+ *
+ *	Checks that keeping the text that doesn't change ("TEXT_RETAIN" in "config.h")
+ *	paints the same screens as painting all of it every time. The program is built
+ *	twice (see "CMakeLists.txt"); the copy without "TEXT_RETAIN" goes through a list of
+ *	changes (tuning, the underline moving, split, transmit, the clarifier, the mode,
+ *	the battery and VFO-B) painting the screen after each one the way "loop()" does,
+ *	and saves the screens to a file. Then the copy with it does the same and compares
+ *	them with what's in the file. They have to be exactly the same, and so does the
+ *	number of pixels sent to the display. The copy that keeps the text also has to have
+ *	actually kept some.
+ *
+ *	Usage:	text_retain_test_<size>_noretain --dump file
+ *			text_retain_test_<size> --compare file
+ */
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "config.h"
+#include "display.h"
+
+
+extern band_data		bandData[];
+extern uint8_t			activeBand;
+extern uint8_t			activeMode;
+extern uint32_t			rxFreq;
+extern float			battVolts;
+extern volatile uint8_t	incrCount;
+extern volatile uint8_t	xmitStatus;
+extern volatile bool	splitMode;
+extern volatile bool	clarifierOn;
+extern volatile int16_t	clarCount;
+extern TFT_eSPI			tft;
+
+extern uint16_t*		GRAM65k;
+extern uint32_t			textKept;
+
+void PaintScreen ();
+
+
+/*
+ *	The changes; each one is made and then the screen is painted "count" times, with
+ *	the frequency going up by "step" Hz each time.
+ */
+
+enum { TUNE, INCR, SPLIT, XMIT, CLAR_ON, CLAR, MODE, BATT, VFO_B };
+
+struct change
+{
+	int		what;
+	int		value;
+	int		count;
+	int		step;
+};
+
+static const change	changes[] =
+{
+	{ TUNE,     0, 40,     10 },				// Just the last digits
+	{ INCR,     1, 10,    100 },				// Underline moves
+	{ INCR,     2, 10,   1000 },
+	{ TUNE,     0,  5, 250000 },				// Most of the digits
+	{ INCR,     0, 20,    -10 },
+	{ SPLIT,    1, 10,     10 },
+	{ XMIT,     1,  4,      0 },
+	{ XMIT,     0,  4,     10 },
+	{ SPLIT,    0,  4,     10 },
+	{ XMIT,     1,  4,     10 },
+	{ XMIT,     0,  4,      0 },
+	{ CLAR_ON,  1,  4,     10 },
+	{ CLAR,     5,  4,      0 },
+	{ CLAR,   -12,  4,     10 },				// Wider string, moves left
+	{ CLAR,     0,  4,     10 },
+	{ CLAR_ON,  0,  4,     10 },
+	{ MODE,     1,  4,     10 },
+	{ MODE,     0,  4,      0 },
+	{ BATT,  1231,  4,     10 },
+	{ BATT,  1229,  4,     10 },
+	{ BATT,   999,  4,      0 },				// Shorter string
+	{ VFO_B,    0,  6,     10 },
+	{ TUNE,     0, 30,    -20 }
+};
+
+
+/*
+ *	"Frame()" paints a screen, saves it or compares it, and sends it to the (host)
+ *	display the way "task0()" does.
+ */
+
+static FILE*	file;
+static bool		dump;
+static int		bad    = 0;
+static int		frames = 0;
+
+static void Frame ( void )
+{
+	static uint16_t		image[DISP_W * DISP_H];
+
+	PaintScreen ();
+	frames++;
+
+	if ( dump )
+		fwrite ( GRAM65k, sizeof ( uint16_t ), DISP_W * DISP_H, file );
+
+	else if ( fread ( image, sizeof ( uint16_t ), DISP_W * DISP_H, file ) != DISP_W * DISP_H )
+	{
+		if ( bad++ < 10 )
+			printf ( "The file is too short\n" );
+	}
+
+	else
+	{
+		for ( int px = 0; px < DISP_W * DISP_H; px++ )
+		{
+			if (( GRAM65k[px] != image[px] ) && bad++ < 10 )
+			{
+				printf ( "Frame %d: pixel %d, %d is %04x, should be %04x\n",
+							frames, px / Ny, px % Ny, GRAM65k[px], image[px] );
+				break;
+			}
+		}
+	}
+
+	Transfer_Image ();
+
+	while ( !Transfer_Done ())
+		HostAdvanceUs ( 1000 );
+}
+
+
+int main ( int argc, char* argv[] )
+{
+	if ( argc != 3 || ( strcmp ( argv[1], "--dump" ) && strcmp ( argv[1], "--compare" )))
+	{
+		fprintf ( stderr, "Usage: %s --dump|--compare file\n", argv[0] );
+		return 2;
+	}
+
+	dump = strcmp ( argv[1], "--dump" ) == 0;
+	file = fopen ( argv[2], dump ? "wb" : "rb" );
+
+	if ( !file )
+	{
+		fprintf ( stderr, "Can't open %s\n", argv[2] );
+		return 2;
+	}
+
+	HostSerialQuiet ( true );
+	setup ();
+
+	uint64_t	startPixels = tft.stats.pixels;
+	uint64_t	pixels;
+
+	rxFreq = bandData[activeBand].lowLimit + 123450;
+
+	for ( const change& c : changes )
+	{
+		switch ( c.what )
+		{
+			case TUNE:								break;
+			case INCR:		incrCount   = c.value;	break;
+			case SPLIT:		splitMode   = c.value;	break;
+			case XMIT:		xmitStatus  = c.value;	break;
+			case CLAR_ON:	clarifierOn = c.value;	break;
+			case CLAR:		clarCount   = c.value;	break;
+			case MODE:		activeMode  = c.value;	break;
+			case BATT:		battVolts   = c.value / 100.0;	break;
+			case VFO_B:		bandData[activeBand].vfoB = rxFreq;	break;
+		}
+
+		for ( int ix = 0; ix < c.count; ix++ )
+		{
+			rxFreq += c.step;
+			bandData[activeBand].vfoA = rxFreq;
+			Frame ();
+		}
+	}
+
+	pixels = tft.stats.pixels - startPixels;
+
+
+/*
+ *	The number of pixels sent goes at the end of the file:
+ */
+
+	if ( dump )
+		fwrite ( &pixels, sizeof ( pixels ), 1, file );
+
+	else
+	{
+		uint64_t	want = 0;
+
+		if (( fread ( &want, sizeof ( want ), 1, file ) != 1 || pixels != want ) && bad++ < 10 )
+			printf ( "%llu pixels sent, should be %llu\n",
+						(unsigned long long) pixels, (unsigned long long) want );
+	}
+
+	fclose ( file );
+
+	if ( dump )
+		return 0;
+
+	printf ( "%d frames compared, %llu pixels sent, %u characters kept, %d problems\n",
+				frames, (unsigned long long) pixels, textKept, bad );
+
+	if (( textKept == 0 ) && bad++ < 10 )
+		printf ( "Should have kept some characters\n" );
+
+	return bad ? 1 : 0;
+}
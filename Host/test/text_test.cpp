@@ -0,0 +1,224 @@
+/*
+ *	"text_test.cpp"
+ *
+ *	"disp_str12()", "disp_str16()" and "disp_str20()" paint from the glyph atlas (see
+ *	"graph.cpp"). This paints strings with every character in them, all over the
+ *	screen and hanging off each edge of it, both ways; with the atlas and with a copy
+ *	of the old functions that went through the font tables a bit at a time. The
+ *	screens have to be the same and so does the "x" coordinate they end at, which
+ *	also has to be what "disp_width12()", etc. say.
+ *
+ *	With "--no-psram", the atlas can't get any memory for the runs, so the string
+ *	functions go through the font tables too (see "PaintBits()" in "graph.cpp"). That
+ *	has to give the same screens as well. "setup()" would paint the splash screen and
+ *	make the atlas first, so it isn't called; the screen image comes from "calloc()".
+ *
+ *	It also times both ways of painting the VFO frequency string. The times are host
+ *	times; the ESP32 is a lot slower.
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include "config.h"
+#include "display.h"
+#include "graph.h"
+#include "font.h"
+
+extern uint16_t*	GRAM65k;
+
+typedef std::chrono::steady_clock Clock;
+
+#define	CHARS	95							// ' ' to '~'
+
+static int	bad = 0;
+
+
+/*
+ *	The old way, from before the atlas. "OldChr()" is "disp_chr12()", "disp_chr16()" and
+ *	"disp_chr20()" in one; "OldStr()" is the string functions without "AddDamage()".
+ */
+
+template <typename T, int N>
+static int OldChr ( const T ( *font )[N], int height, uint32_t end, char c, int x, int y, uint32_t color )
+{
+	int			k, j, yj;
+	uint32_t	f;
+
+	if ( c == '\\' )	c = ' ';
+
+	for ( k = 0; k < 24; k++ )
+	{
+		f = (uint32_t) font[c - 0x20][k];
+
+		if ( height <= 16 )
+			f &= 0xFFFF;
+
+		if ( f == end )
+			break;
+
+		if ( x >= 0 )
+		{
+			for ( j = 0; j < height; j++ )
+			{
+				yj = y + j;
+
+				if ( f & 1 )
+				{
+					if ( x >= 0 && x < Nx && yj >= 0 && yj < Ny )
+						setPixel ( x, yj, color );
+				}
+
+				f >>= 1;
+			}
+		}
+
+		x++;
+	}
+
+	return x + 1;
+}
+
+static int OldStr ( int size, const char* s, int x, int y, uint32_t color )
+{
+	for ( int k = 0; k < 128 && s[k]; k++ )
+	{
+		if ( size == 12 )	x = OldChr ( font12, 12, 0x0fff,  s[k], x, y, color );
+		if ( size == 16 )	x = OldChr ( font16, 16, 0xffff,  s[k], x, y, color );
+		if ( size == 20 )	x = OldChr ( font20, 20, 0xfffff, s[k], x, y, color );
+		x += 1;
+	}
+
+	return x;
+}
+
+static int NewStr ( int size, const char* s, int x, int y, uint32_t color )
+{
+	if ( size == 12 )	{ disp_str12 ((char*) s, x, y, color );	return x + disp_width12 ( s ); }
+	if ( size == 16 )	{ disp_str16 ((char*) s, x, y, color );	return x + disp_width16 ( s ); }
+
+	disp_str20 ((char*) s, x, y, color );
+	return x + disp_width20 ( s );
+}
+
+
+/*
+ *	"Compare()" paints "s" both ways on a cleared screen and compares them.
+ */
+
+static uint16_t		screen[DISP_W * DISP_H];
+
+static void Compare ( int size, const char* s, int x, int y )
+{
+	int		oldEnd, newEnd;
+
+	memset ( GRAM65k, 0, sizeof ( screen ));
+	oldEnd = OldStr ( size, s, x, y, CL_WHITE );
+	memcpy ( screen, GRAM65k, sizeof ( screen ));
+
+	memset ( GRAM65k, 0, sizeof ( screen ));
+	newEnd = NewStr ( size, s, x, y, CL_WHITE );
+
+	if (( oldEnd != newEnd ) && bad++ < 10 )
+		printf ( "Font%d \"%s\" at %d, %d: ends at %d, should be %d\n", size, s, x, y, newEnd, oldEnd );
+
+	for ( int ix = 0; ix < DISP_W * DISP_H; ix++ )
+	{
+		if (( screen[ix] != GRAM65k[ix] ) && bad++ < 10 )
+		{
+			printf ( "Font%d \"%s\" at %d, %d: pixel %d, %d is different\n",
+						size, s, x, y, ix / Ny, ix % Ny );
+			break;
+		}
+	}
+}
+
+
+/*
+ *	"Time()" paints "s" "count" times and returns the time for each in nanoseconds.
+ */
+
+static double Time ( bool atlas, int size, const char* s, int count )
+{
+	Clock::time_point	start = Clock::now ();
+
+	for ( int ix = 0; ix < count; ix++ )
+	{
+		if ( atlas )
+			NewStr ( size, s, 20, 20, CL_WHITE );
+		else
+			OldStr ( size, s, 20, 20, CL_WHITE );
+	}
+
+	return std::chrono::duration<double, std::nano> ( Clock::now () - start ).count () / count;
+}
+
+
+int main ( int argc, char* argv[] )
+{
+	HostSerialQuiet ( true );
+
+	if ( argc > 1 && strcmp ( argv[1], "--no-psram" ) == 0 )
+	{
+		GRAM65k = (uint16_t*) calloc ( DISP_W * DISP_H, sizeof ( uint16_t ));
+		HostPsramFull ( true );
+	}
+
+	else
+		setup ();
+
+	static const int	sizes[]  = { 12, 16, 20 };
+	static const int	places[] = { -30, -13, -1, 0, 7 };		// From each edge
+	char				all[CHARS + 1];
+
+	for ( int ix = 0; ix < CHARS; ix++ )				// Every character
+		all[ix] = 0x20 + ix;
+
+	all[CHARS] = 0;
+
+	for ( int size : sizes )
+	{
+		for ( int start = 0; start < CHARS; start += 8 )	// 8 at a time
+		{
+			char	s[9];
+
+			strncpy ( s, all + start, 8 );
+			s[8] = 0;
+
+			for ( int px : places )
+			{
+				Compare ( size, s, px, 10 );					// Left edge
+				Compare ( size, s, Nx - 40 - px, 10 );			// Right edge
+				Compare ( size, s, 10, px );					// Top
+				Compare ( size, s, 10, Ny - size - px );		// Bottom
+				Compare ( size, s, px, Ny - size - px );		// Corner
+			}
+
+			Compare ( size, s, Nx / 3, Ny / 3 );				// On the screen
+			Compare ( size, s, Nx + 5, 10 );					// Off it altogether
+			Compare ( size, s, 10, -50 );
+		}
+
+		Compare ( size, all, -200, 20 );						// Longer than the screen
+	}
+
+
+/*
+ *	And how long the VFO frequency takes:
+ */
+
+	const char*	vfo = " 14.074,00";
+
+	printf ( "%-8s %10s %10s\n", "Font", "Old ns", "Atlas ns" );
+
+	for ( int size : sizes )
+	{
+		double	oldNs = Time ( false, size, vfo, 20000 );
+		double	newNs = Time ( true,  size, vfo, 20000 );
+
+		printf ( "%-8d %10.1f %10.1f\n", size, oldNs, newNs );
+	}
+
+	printf ( "\n%d problems\n", bad );
+
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+/*
+ *	"trace_record_test.cpp"
+ *
+ *	Runs the VFO program built with "TRACE_INPUT" turned on through a made up
+ *	operating session (turning the knob slowly and quickly both ways, keying the PTT,
+ *	a CAT frequency change and a few clarifier steps), then sends "#TR;" and saves
+ *	what it prints. It checks the recording has everything that was done in it, and
+ *	the "trace_replay" test then plays the file back; that has to end up on the same
+ *	frequency.
+ *
+ *	Usage:	trace_record_test file
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "trace.h"
+
+
+extern uint32_t		rxFreq;
+
+static int	bad = 0;
+
+static void Turn ( uint8_t pinA, uint8_t pinB, int steps, uint32_t gapUs )
+{
+	for ( int ix = 0; ix < abs ( steps ); ix++ )
+	{
+		HostEncoderStep ( pinA, pinB, steps > 0 ? 1 : -1 );
+		HostRunFor ( gapUs );
+	}
+}
+
+
+int main ( int argc, char* argv[] )
+{
+	if ( argc != 2 )
+	{
+		fprintf ( stderr, "Usage: %s file\n", argv[0] );
+		return 2;
+	}
+
+	HostSerialQuiet ( true );
+
+	setup ();
+
+	HostRunFor ( 100000 );
+
+	Turn ( FREQ_ENCDR_A, FREQ_ENCDR_B,  30, 40000 );		// Slowly up
+	Turn ( FREQ_ENCDR_A, FREQ_ENCDR_B, 120,  2500 );		// Spin it
+	HostRunFor ( 300000 );
+	Turn ( FREQ_ENCDR_A, FREQ_ENCDR_B, -50,  8000 );		// Back down a bit
+	HostRunFor ( 300000 );
+
+	#if ( PTT_LINE == AVAILABLE )
+		HostPinWrite ( PTT_PIN, PTT_ON );
+		HostRunFor ( 200000 );
+		Turn ( FREQ_ENCDR_A, FREQ_ENCDR_B, 10, 5000 );		// Mustn't tune while transmitting
+		HostPinWrite ( PTT_PIN, PTT_OFF );
+		HostRunFor ( 300000 );
+	#endif
+
+	HostSerialFeed ( "FA050313000;" );						// CAT frequency change
+	HostRunFor ( 300000 );
+
+	#if ( CLARIFIER == ENCODER )
+		Turn ( CLAR_ENCDR_A, CLAR_ENCDR_B, 5, 20000 );
+	#endif
+
+	Turn ( FREQ_ENCDR_A, FREQ_ENCDR_B, -20, 15000 );
+	HostRunFor ( 500000 );
+
+
+/*
+ *	Get the recording:
+ */
+
+	FILE*	out = fopen ( argv[1], "w" );
+
+	if ( out == NULL )
+	{
+		fprintf ( stderr, "Can't write %s\n", argv[1] );
+		return 2;
+	}
+
+	uint32_t	endFreq = rxFreq;
+
+	HostSerialCapture ( out );
+	HostSerialFeed ( "#TR;" );
+	HostRunFor ( 100000 );
+	HostSerialCapture ( NULL );
+
+	fclose ( out );
+
+
+/*
+ *	And check it:
+ */
+
+	FILE*		in = fopen ( argv[1], "r" );
+	char		line[80];
+	uint32_t	count = 0, missed = 0, freq = 0, lines = 0;
+	int			perType[128] = { 0 };
+	int			net = 0;
+
+	while ( fgets ( line, sizeof ( line ), in ))
+	{
+		unsigned	us;
+		char		type;
+		int			value;
+
+		if ( sscanf ( line, "#TRACE %u %u", &count, &missed ) == 2 )
+			continue;
+
+		if ( sscanf ( line, "#END %u", &freq ) == 1 )
+			break;
+
+		if ( sscanf ( line, "%u %c %d", &us, &type, &value ) == 3 )
+		{
+			lines++;
+			perType[type & 0x7F]++;
+
+			if ( type == TR_FREQ )
+				net += value;
+		}
+	}
+
+	fclose ( in );
+
+	int		steps = 30 + 120 + 50 + 20 + (( PTT_LINE == AVAILABLE ) ? 10 : 0 );
+
+	printf ( "%u things recorded, %d frequency steps, %d PTT changes, %d CAT changes\n",
+				lines, perType[TR_FREQ], perType[TR_PTT], perType[TR_FA] );
+
+	if ((( lines != count ) || ( missed != 0 )) && bad++ < 10 )
+		printf ( "Header says %u recorded and %u missed\n", count, missed );
+
+	if (( freq != endFreq ) && bad++ < 10 )
+		printf ( "Ends with %u, should be %u\n", freq, endFreq );
+
+	if ((( perType[TR_FREQ] != steps ) || ( net != steps - 140 )) && bad++ < 10 )
+		printf ( "Should have %d frequency steps adding up to %d\n", steps, steps - 140 );
+
+	if (( perType[TR_PTT] != (( PTT_LINE == AVAILABLE ) ? 2 : 0 )) && bad++ < 10 )
+		printf ( "Wrong number of PTT changes\n" );
+
+	if (( perType[TR_FA] != 2 ) && bad++ < 10 )				// At the start and the CAT change
+		printf ( "Should have 2 CAT changes\n" );
+
+	printf ( "%d problems\n", bad );
+
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,369 @@
+/*
+ *	"trace_replay.cpp"
+ *
+ *	Plays an input recording made with "TRACE_INPUT" turned on (see "trace.cpp") back
+ *	into the VFO program on the host. Encoder steps are turned back into edges on the
+ *	encoder pins timed so the interrupt handler sees the step when the real one did,
+ *	PTT changes go to the PTT pin, and the CAT settings are sent as CAT messages, so
+ *	everything goes through the same interrupt handlers, "task0()", "loop()" and
+ *	"CheckCAT()" it did on the radio.
+ *
+ *	It reports what the program did with it: how "rxFreq" moved, what was written to
+ *	the Si5351 and how many frames were sent to the display. The Si5351 writes are
+ *	also boiled down to a checksum so two versions of the program can be compared on
+ *	the same recording. If the recording ends with the frequency the radio was on
+ *	when it was printed, the program has to end up there too.
+ *
+ *	The recording can be copied from the serial monitor after sending "#TR;"; anything
+ *	before the "#TRACE" line and after the "#END" line is ignored.
+ *
+ *	Usage:	trace_replay [--timeline file] [--quiet] trace
+ *
+ *	"--timeline" writes each change of "rxFreq" to the file as "<mS> <frequency>".
+ */
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <vector>
+#include "config.h"
+#include "events.h"
+#include "trace.h"
+
+
+/*
+ *	Things in the VFO program we look at:
+ */
+
+extern uint32_t		rxFreq;
+extern TFT_eSPI		tft;
+
+#define	EDGE_US		10						// Time between encoder edges
+#define	SETTLE_US	500000					// How long to let it run after the last thing
+
+
+/*
+ *	Watch the Si5351 bus pins and decode what's written. Each transaction is the
+ *	Si5351's address, the first register number and then the data for that register
+ *	and the ones after it. Every register written goes into the checksum (FNV-1a).
+ */
+
+static uint8_t		sda = HIGH, scl = HIGH;
+static bool			busy = false;
+static int			bits = 0;
+static uint8_t		byteIn = 0;
+static std::vector<uint8_t>	bytes;
+
+static uint32_t		transactions = 0;
+static uint32_t		registers = 0;
+static uint32_t		checksum = 2166136261UL;
+
+static void Checksum ( uint8_t b )
+{
+	checksum = ( checksum ^ b ) * 16777619UL;
+}
+
+static void WatchI2C ( uint8_t pin, uint8_t val, uint64_t ns )
+{
+	(void) ns;
+
+	if ( pin == SI_SCL )
+	{
+		if ( busy && ( val == HIGH ) && ( scl == LOW ))
+		{
+			if ( bits % 9 < 8 )						// Not the acknowledge bit
+				byteIn = ( byteIn << 1 ) | sda;
+
+			else
+				bytes.push_back ( byteIn );
+
+			bits++;
+		}
+
+		scl = val;
+	}
+
+	else if ( pin == SI_SDA )
+	{
+		if (( scl == HIGH ) && ( sda == HIGH ) && ( val == LOW ))		// START
+		{
+			busy = true;
+			bits = 0;
+			bytes.clear ();
+		}
+
+		if (( scl == HIGH ) && ( sda == LOW ) && ( val == HIGH ))		// STOP
+		{
+			busy = false;
+			transactions++;
+
+			for ( size_t ix = 2; ix < bytes.size (); ix++ )
+			{
+				Checksum ( bytes[1] + ix - 2 );					// Register number
+				Checksum ( bytes[ix] );							// and what went in it
+				registers++;
+			}
+		}
+
+		sda = val;
+	}
+}
+
+
+/*
+ *	"RunTo()" runs the program up to a little before "ns" (it can go a little past
+ *	where it's told to stop) and notes every change of "rxFreq" on the way.
+ */
+
+#define	SPARE_US	20
+
+static uint64_t		startNs;
+static uint32_t		lastFreq;
+static uint32_t		freqChanges = 0;
+static FILE*		timeline = NULL;
+
+static void NoteFreq ( void )
+{
+	if ( rxFreq == lastFreq )
+		return;
+
+	lastFreq = rxFreq;
+	freqChanges++;
+
+	if ( timeline )
+		fprintf ( timeline, "%.3f %u\n", ( HostNowNs () - startNs ) / 1e6, rxFreq );
+}
+
+static void RunTo ( uint64_t ns )
+{
+	while ( HostNowNs () + SPARE_US * 1000 < ns )
+	{
+		uint64_t	left = ( ns - HostNowNs ()) / 1000 - SPARE_US;
+
+		HostStep ( left > 1000 ? 1000 : left < 1 ? 1 : (uint32_t) left );
+		NoteFreq ();
+
+	}
+}
+
+
+/*
+ *	"Encoder()" turns an encoder one step so that the interrupt handler sees it at
+ *	"ns" (on the last of the four edges).
+ */
+
+static void Encoder ( uint8_t pinA, uint8_t pinB, int dir, uint64_t ns )
+{
+	uint64_t	start = ns - 3 * EDGE_US * 1000ULL;
+
+	RunTo ( start );
+
+	if ( HostNowNs () < start )
+		HostAdvanceNs ( start - HostNowNs ());
+
+	HostEncoderStep ( pinA, pinB, dir, EDGE_US );
+}
+
+
+int main ( int argc, char* argv[] )
+{
+	const char*	traceFile = NULL;
+	const char*	timeFile  = NULL;
+	bool		quiet     = false;
+
+	for ( int ix = 1; ix < argc; ix++ )
+	{
+		if (( strcmp ( argv[ix], "--timeline" ) == 0 ) && ( ix + 1 < argc ))
+			timeFile = argv[++ix];
+
+		else if ( strcmp ( argv[ix], "--quiet" ) == 0 )
+			quiet = true;
+
+		else if (( argv[ix][0] != '-' ) && ( traceFile == NULL ))
+			traceFile = argv[ix];
+
+		else
+		{
+			traceFile = NULL;
+			break;
+		}
+	}
+
+	if ( traceFile == NULL )
+	{
+		fprintf ( stderr, "Usage: %s [--timeline file] [--quiet] trace\n", argv[0] );
+		return 2;
+	}
+
+
+/*
+ *	Read the recording:
+ */
+
+	FILE*	in = fopen ( traceFile, "r" );
+
+	if ( in == NULL )
+	{
+		fprintf ( stderr, "Can't read %s\n", traceFile );
+		return 2;
+	}
+
+	std::vector<trace_rec>	recs;
+	char		line[80];
+	bool		inTrace = false;
+	uint32_t	count = 0, missed = 0;
+	uint32_t	endFreq = 0;
+	uint32_t	perType[128] = { 0 };
+
+	while ( fgets ( line, sizeof ( line ), in ))
+	{
+		trace_rec	r;
+		unsigned	us;
+		char		type;
+		int			value;
+
+		if ( sscanf ( line, "#TRACE %u %u", &count, &missed ) == 2 )
+			inTrace = true;
+
+		else if ( inTrace && ( sscanf ( line, "#END %u", &endFreq ) == 1 ))
+			break;
+
+		else if ( inTrace && ( sscanf ( line, "%u %c %d", &us, &type, &value ) == 3 ))
+		{
+			r.us    = us;
+			r.type  = type;
+			r.value = value;
+			recs.push_back ( r );
+			perType[type & 0x7F]++;
+		}
+	}
+
+	fclose ( in );
+
+	if ( !inTrace || ( recs.size () != count ))
+	{
+		fprintf ( stderr, "%s isn't a whole recording (%zu of %u lines)\n",
+					traceFile, recs.size (), count );
+		return 2;
+	}
+
+	if ( timeFile && (( timeline = fopen ( timeFile, "w" )) == NULL ))
+	{
+		fprintf ( stderr, "Can't write %s\n", timeFile );
+		return 2;
+	}
+
+
+/*
+ *	Start the program the same way the radio was started. The recording starts at
+ *	the end of "setup()".
+ */
+
+	HostSerialQuiet ( quiet );
+
+	setup ();
+
+	startNs  = HostNowNs ();
+	lastFreq = rxFreq;
+
+	uint32_t	startFreq   = rxFreq;
+	uint32_t	startFrames = tft.stats.frames;
+
+	HostSetPinObserver ( WatchI2C );
+
+	for ( size_t ix = 0; ix < recs.size (); ix++ )
+	{
+		const trace_rec&	r  = recs[ix];
+		uint64_t			ns = startNs + r.us * 1000ULL;
+		char				msg[20];
+
+		switch ( r.type )
+		{
+			case TR_FREQ:
+				Encoder ( FREQ_ENCDR_A, FREQ_ENCDR_B, r.value, ns );
+				break;
+
+			#if ( CLARIFIER == ENCODER )
+				case TR_CLAR:
+					Encoder ( CLAR_ENCDR_A, CLAR_ENCDR_B, r.value, ns );
+					break;
+			#endif
+
+			#if ( PTT_LINE == AVAILABLE )
+				case TR_PTT:
+					RunTo ( ns );
+					HostPinWrite ( PTT_PIN, r.value );
+					break;
+			#endif
+
+			case TR_FA:							// The CAT settings, as CAT messages
+				RunTo ( ns );
+				sprintf ( msg, "FA%09u;", (uint32_t) r.value );
+				HostSerialFeed ( msg );
+				break;
+
+			case TR_FB:
+				RunTo ( ns );
+				sprintf ( msg, "FB%09u;", (uint32_t) r.value );
+				HostSerialFeed ( msg );
+				break;
+
+			case TR_MODE:
+				RunTo ( ns );
+				sprintf ( msg, "MD0%X;", r.value );
+				HostSerialFeed ( msg );
+				break;
+
+			case TR_TX:
+				RunTo ( ns );
+				sprintf ( msg, "TX%d;", r.value );
+				HostSerialFeed ( msg );
+				break;
+
+			case TR_SPLIT:
+				RunTo ( ns );
+				sprintf ( msg, "ST%d;", r.value );
+				HostSerialFeed ( msg );
+				break;
+
+			default:
+				fprintf ( stderr, "Don't know what to do with '%c' at %u uS\n", r.type, r.us );
+				return 2;
+		}
+	}
+
+	RunTo ( HostNowNs () + SETTLE_US * 1000ULL );
+
+	HostSetPinObserver ( NULL );
+
+	if ( timeline )
+		fclose ( timeline );
+
+
+/*
+ *	And report what happened:
+ */
+
+	double		seconds = recs.empty () ? 0 : recs.back ().us / 1e6;
+
+	printf ( "Recording:         %u things over %.3f s (%u missed when it was made)\n",
+				count, seconds, missed );
+	printf ( "                   %u frequency steps, %u clarifier steps, %u PTT changes, %u CAT changes\n",
+				perType[TR_FREQ], perType[TR_CLAR], perType[TR_PTT], perType[TR_FA] );
+
+	printf ( "Start frequency:   %u\n", startFreq );
+	printf ( "Final frequency:   %u", rxFreq );
+
+	if ( endFreq )
+		printf ( " (%u when recorded)", endFreq );
+
+	printf ( "\nFrequency changes: %u\n", freqChanges );
+	printf ( "Si5351 transfers:  %u (%u registers, checksum %08x)\n", transactions, registers, checksum );
+	printf ( "Frames sent:       %u\n", tft.stats.frames - startFrames );
+	printf ( "Input events lost: %u\n", EventsLost ());
+	printf ( "Simulated time:    %.3f s\n", HostNowNs () / 1e9 );
+
+	if ( endFreq && ( rxFreq != endFreq ))
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ *	"vfo_host.cpp"
+ *
+ *	Runs the VFO program on the host. It calls "setup()", lets the program run for a
+ *	while, turns the frequency encoder a number of steps each way and reports what
+ *	happened, and what the scheduler says "loop()" spent its time on. Optionally
+ *	it saves the final screen as a ".ppm" file.
+ *
+ *	Usage:	vfo_host [--steps n] [--ppm file] [--quiet]
+ *
+ *	Build with "-DVFO_HOST_PROFILE=ON" and run it to get a "gmon.out" for "gprof".
+ */
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "config.h"
+#include "display.h"
+#include "events.h"
+
+
+/*
+ *	Things in the VFO program we look at:
+ */
+
+extern uint32_t		rxFreq;
+extern uint32_t		vfoFreq;
+extern TFT_eSPI		tft;
+
+
+/*
+ *	Watch the Si5351 bus pins and count the I2C transactions (each one writes one
+ *	register or a block of them) and how long the bus was busy. A START is "SI_SDA" going LOW while
+ *	"SI_SCL" is HIGH and a STOP is "SI_SDA" going HIGH while "SI_SCL" is HIGH.
+ */
+
+static uint8_t		sda = HIGH, scl = HIGH;
+static uint64_t		startNs;
+static uint32_t		i2cWrites = 0;
+static uint64_t		i2cNs = 0;
+
+static void WatchI2C ( uint8_t pin, uint8_t val, uint64_t ns )
+{
+	if ( pin == SI_SCL )
+		scl = val;
+
+	else if ( pin == SI_SDA )
+	{
+		if (( scl == HIGH ) && ( sda == HIGH ) && ( val == LOW ))
+			startNs = ns;
+
+		if (( scl == HIGH ) && ( sda == LOW ) && ( val == HIGH ))
+		{
+			i2cWrites++;
+			i2cNs += ns - startNs;
+		}
+
+		sda = val;
+	}
+}
+
+
+int main ( int argc, char* argv[] )
+{
+	int			steps   = 100;				// Encoder steps each way
+	const char*	ppmFile = NULL;
+	bool		quiet   = false;
+
+	for ( int ix = 1; ix < argc; ix++ )
+	{
+		if (( strcmp ( argv[ix], "--steps" ) == 0 ) && ( ix + 1 < argc ))
+			steps = atoi ( argv[++ix] );
+
+		else if (( strcmp ( argv[ix], "--ppm" ) == 0 ) && ( ix + 1 < argc ))
+			ppmFile = argv[++ix];
+
+		else if ( strcmp ( argv[ix], "--quiet" ) == 0 )
+			quiet = true;
+
+		else
+		{
+			fprintf ( stderr, "Usage: %s [--steps n] [--ppm file] [--quiet]\n", argv[0] );
+			return 2;
+		}
+	}
+
+	HostSerialQuiet ( quiet );
+
+	setup ();
+	HostRunFor ( 100000 );						// Let the first frame get out
+
+	uint32_t startFreq   = rxFreq;
+	uint32_t startFrames = tft.stats.frames;
+	uint64_t startPixels = tft.stats.pixels;
+
+	HostSetPinObserver ( WatchI2C );
+	uint32_t turnFreq    = 0;
+
+	for ( int dir = 1; dir >= -1; dir -= 2 )	// One way, then back
+	{
+		for ( int ix = 0; ix < steps; ix++ )
+		{
+			HostEncoderStep ( FREQ_ENCDR_A, FREQ_ENCDR_B, dir );
+			HostRunFor ( 5000 );
+		}
+
+		if ( dir > 0 )
+			turnFreq = rxFreq;
+	}
+
+	HostRunFor ( 100000 );						// Let everything settle
+
+	uint32_t frames = tft.stats.frames - startFrames;
+
+	printf ( "Start frequency:   %u\n", startFreq );
+	printf ( "Turning frequency: %u\n", turnFreq );
+	printf ( "Final frequency:   %u\n", rxFreq );
+	printf ( "VFO frequency:     %u\n", vfoFreq );
+	printf ( "Frames sent:       %u\n", frames );
+	printf ( "Pixels sent:       %llu\n", (unsigned long long) ( tft.stats.pixels - startPixels ));
+
+	printf ( "Si5351 transfers:  %u (%.3f ms on the bus)\n", i2cWrites, i2cNs / 1e6 );
+	printf ( "Display wait:      %.3f ms\n", tft.stats.waitNs / 1e6 );
+	printf ( "Input events lost: %u\n", EventsLost ());
+
+	printf ( "Simulated time:    %.3f s\n", HostNowNs () / 1e9 );
+	printf ( "PSRAM allocations: %u (%zu bytes)\n", hostAlloc.count, hostAlloc.bytes );
+
+	#if LATENCY_TRACE							// Ask for the tuning times
+
+		printf ( "\n" );
+		HostSerialQuiet ( false );
+		HostSerialFeed ( "#LT;" );
+		HostRunFor ( CAT_READ_TIME * 2000 );
+
+	#endif
+
+	printf ( "\n" );							// And how busy "loop()" was
+	HostSerialQuiet ( false );
+	HostSerialFeed ( "#SC;" );
+	HostRunFor ( CAT_READ_TIME * 2000 );
+
+
+
+	if ( ppmFile && !HostTftSavePPM ( tft, ppmFile, DISP_W, DISP_H ))
+	{
+		fprintf ( stderr, "Can't write %s\n", ppmFile );
+		return 1;
+	}
+
+	if (( frames == 0 ) || ( turnFreq == startFreq ))	// Nothing happened
+		return 1;
+
+	return 0;
+}
@@ -94,6 +94,15 @@
 #include "display.h"		// Display handling functions
 #include "graph.h"			// Actual screen painting stuff
 #include "dial.h"			// Dial construction functions
+#include "damage.h"			// Keeps track of what changed on the screen
+#include "text.h"			// The text that stays on the screen
+#include "events.h"			// Queue from the interrupt handlers to "task0()"
+#include "accel.h"			// Tuning accelerator
+#include "trace.h"			// Recording the inputs for the host build
+#include "latency.h"		// Timing the tuning
+#include "bands.h"			// Finding which band a frequency is in
+#include "journal.h"		// Saving the settings in the flash
+#include "sched.h"			// Running the jobs in "loop()" when they're due
 #include "si5351.h"			// Si5351 functions
 #include <Wire.h>			// I2C device interface stuff
 #include <EEPROM.h>			// Contains Si5351 crystal calibration frequency
@@ -140,6 +149,10 @@ band_data bandData[] =
 	{ 50250000UL, 50123456UL, 50000000UL, 39102000UL, 50000000UL,  54000000UL, INC_100, BS_6M, +1, MODE_USB }
 };
 
+SI_plan	bandPlan[ELEMENTS ( bandData )];		// Si5351 "M" and "R" for each band (see "si5351.h")
+uint8_t	bandOrder[ELEMENTS ( bandData )];		// Bands in order of frequency (see "bands.cpp")
+uint8_t* bandIndex = NULL;						// "bandOrder" if the bands don't overlap
+
 
 uint8_t	NBR_BANDS;		// Used to be defined; will now be calculated so can easily add
 						// bands if required!
@@ -192,27 +205,15 @@ uint8_t lastMode;				// Used to decide if clear display required after a change
 ctl_flags changed;				// Control flags
 
 
-/*
- *	Adaptive step control parameters; I'm still now exactly sure how these all work! I
- *	don't suggest changing them!
- */
-
-float		Racc = 0.002;		// Rate of acceleration
-float		Rdec = 1.0;			// Rate of deceleration
-float		MaxL = 1500.0;		// Max Step[Hz] = bandData[activeBand].incr + Racc*MaxL*MaxL
-float		L    = 0.0;			// Something to do with how much to move the frequency
 int32_t		afstp;				// Calculated amount to change frequency
 
 
 /*
  *	Some variables needed for managing the rotary encoders; note the "volatile" designation
- *	as these are used in the encoder ISRs. We also create the rotary encoder object:
+ *	as some are used in the encoder ISRs. The encoder steps themselves go to "task0()"
+ *	through the queue in "events.cpp". We also create the rotary encoder object:
  */
 
-volatile	int16_t	freqCount   = 0;			// Encoder cumulative interrupt counter
-volatile	int16_t	encoderDir  = 0;			// Copy of last encoder direction
-volatile	bool	freqPulse   = false;		// True when we get an encoder interrupt
-
 volatile	int16_t	clarCount   = 0;			// Clarifier encoder cumulative counter
 volatile	int16_t	oldClarCnt  = 0;			// Previous counter value
 volatile	bool	clarifierOn = false;		// Clarifier status
@@ -235,20 +236,15 @@ uint8_t				redrawScreen; 				// Indicates need to repaint the screen
 
 
 /*
- *	Timing variables for the band switch read mode switch read and clarifier read. They
- *	don't need to be looked at every time through the loops. The clarifier time only
- *	applies to the potentiometer implementation as the encoder implementation is handled
- *	real-time using interrupts.
+ *	The band switch, mode switch, buttons, clarifier, battery and CAT control don't
+ *	need to be looked at every time through the loop. They used to each keep the last
+ *	time they were read; now the scheduler (see "sched.cpp") runs them every so often
+ *	(the times are in "config.h"). Painting the screen is a job too, so it's timed
+ *	with the others.
  */
 
-uint32_t	lastBandSwRead     = 0;		// Last time the band switch was looked at
-uint32_t	lastModeSwRead     = 0;		// Last time the mode switch was looked at
-uint32_t  	lastClarPotRead    = 0;		// Last time potentiometer clarifier was looked at
-uint32_t	lastCatRead        = 0;		// Last time we looked for a CAT message
-uint32_t	lastBattRead       = 0;		// Last time we looked at the battery
-uint32_t	lastIncrRead       = 0;		// Last time the increment button was read
-uint32_t	lastClarSwRead     = 0;		// Last time we read the clarifier switch
-uint32_t	lastModeButtonRead = 0;		// Last time we read the mode select button
+float		battVolts = 0;				// Battery voltage
+int			paintJob;					// Scheduler job number for "PaintScreen()"
 
 /*
  *	If we're using the PCF8574 to read the band switch, we need to create the
@@ -289,16 +285,18 @@ uint32_t	lastModeButtonRead = 0;		// Last time we read the mode select button
  *	required for the maps of the display as opposed to simply defining them in the
  *	flash memory.
  *
- *	In order to use the PSRAM, the original "GRAM" arrays become arrays of pointers to
- *	pointers. You'll see how it works when we allocate then dynamically from the PSRAM
- *	in "setup()".
+ *	Everything gets painted straight into "GRAM65k", which holds the 16 bit color of
+ *	each pixel exactly the way it gets sent to the display. It used to be painted in
+ *	separate red, green and blue "GRAM" arrays first, which took three times the memory
+ *	and an extra pass over the whole screen to combine them.
+ *
+ *	There are two copies of it; while one is being sent to the display ("GRAMsend"),
+ *	the next screen gets painted in the other one ("GRAM65k"). "Transfer_Image()"
+ *	swaps them.
  */
 
-uint8_t**	R_GRAM;				// Red component of a pixel (RGB color format)
-uint8_t**	G_GRAM;				// Green component of a pixel (RGB color format)
-uint8_t**	B_GRAM;				// Blue component of a pixel (RGB color format)
-
-uint16_t*	GRAM65k;			// 16 bit version of the color of a pixel
+uint16_t*	GRAM65k;			// 16 bit color of each pixel
+uint16_t*	GRAMsend;			// The one being sent to the display
 
 
 /*
@@ -332,44 +330,13 @@ void setup()
 
 
 /*
- *	Step 1 in building the "GRAM" arrays; The "GRAM" (now really just variables) become
- *	pointers to blocks of memory large enough to hold a list of pointers to the memory
- *	blocks that will hold the data for each horizontal row of the display. Yes it's
- *	confusing!
- */
-
-	R_GRAM = ( uint8_t** ) ps_malloc ( DISP_W * sizeof ( uint8_t* ));
-	G_GRAM = ( uint8_t** ) ps_malloc ( DISP_W * sizeof ( uint8_t* ));
-	B_GRAM = ( uint8_t** ) ps_malloc ( DISP_W * sizeof ( uint8_t* ));
-
-
-/*
- *	Step 2 in building the "GRAM" arrays; We can now treat the "GRAM" arrays as
- *	single-dimensioned arrays and we set each element of the array to a pointer
- *	of a block of memory big enough to hold the pixel data for each horizontal
- *	line of the display.
- *
- *	As convoluted as this may seem, it now allows the rest of the program to deal
- *	with the "GRAM" arrays as if they were simply standard two dimensional arrays,
- *	for example "R_GRAM[x][y]"!
- */
-
-	for ( int ix = 0; ix < DISP_W; ix++ )
-	{
-		R_GRAM[ix] = (uint8_t*) ps_malloc ( DISP_H );
-		G_GRAM[ix] = (uint8_t*) ps_malloc ( DISP_H );
-		B_GRAM[ix] = (uint8_t*) ps_malloc ( DISP_H );
-	}
-
-
-/*
- *	Because of how the 16 bit color array is used to transfer the pixel map to the display
- *	in one move, it is handled differently than the other "GRAM" arrays. Here we allocate
- *	one contiguous block of memory large enough to hold the 16 bit color word for each
- *	pixel on the display.
+ *	Allocate two contiguous blocks of memory large enough to hold the 16 bit color word
+ *	for each pixel on the display. All the "y" values for one "x" are together, so the
+ *	color of the pixel at "x", "y" is "GRAM65k[x * DISP_H + y]".
  */
 
-	GRAM65k = (uint16_t*) ps_calloc ( DISP_H * DISP_W * sizeof ( uint16_t* ) , sizeof ( uint16_t* ));
+	GRAM65k  = (uint16_t*) ps_calloc ( DISP_H * DISP_W, sizeof ( uint16_t ));
+	GRAMsend = (uint16_t*) ps_calloc ( DISP_H * DISP_W, sizeof ( uint16_t ));
 
 	NBR_BANDS = ELEMENTS ( bandData );				// How many bands?
 	NBR_MODES = ELEMENTS ( modeData );				// How many modes?
@@ -436,6 +403,12 @@ void setup()
 	SetCorrection ( correction );						// Tell the Si5351 module
 	SetXtalFreq   ( SI_XTAL );							// And set the crystal frequency
 
+	for ( int ix = 0; ix < NBR_BANDS; ix++ )			// Pick the Si5351 dividers for
+		PlanBand ( ix );								// each band
+
+	if ( IndexBands ( bandData, NBR_BANDS, bandOrder ))	// Sort the bands for "CheckFreq()"
+		bandIndex = bandOrder;
+
 
 /*
  *	If we're using a PCF8574 (or two) to read a physical band and/or mode switch, we
@@ -521,11 +494,17 @@ void setup()
 /*
  *	We had originally intended to store the last active band, frequency and mode
  *	in the EEPROM, but couldn't come up with a good scheme for doing that which
- *	wouldn't run the risk of exceeding the write limitation on the EEPROM. Instead.
- *	we will set the active band to '0' and since at this point, the split mode is off,
- *	both the transmit and receive frequencies are in VFO-A.
+ *	wouldn't run the risk of exceeding the write limitation on the EEPROM. That's
+ *	now done with a journal in the flash (see "journal.cpp"); "RestoreState()" puts
+ *	what was saved for each band back in "bandData" and, unless there's a band
+ *	switch, goes back to the band that was in use. Without anything saved, we
+ *	start on band '0' with the split mode off.
  */
 
+	#if SAVE_STATE
+		RestoreState ();
+	#endif
+
 	incrCount  = bandData[activeBand].incr;		// Set default index to "incrList" array
 	rxFreq     = bandData[activeBand].vfoA;		// VFO-A frequency
 	txFreq     = bandData[activeBand].vfoB;		// VFO-B frequency
@@ -550,6 +529,7 @@ void setup()
 	CAT.SetFB  ( bandData[activeBand].vfoB );
 	CAT.SetMDA ( modeData[activeMode].catMode );
 	CAT.SetMDB ( modeData[activeMode].catMode );
+	CAT.SetST  ( splitMode );
 
 	InitDisplay ();							// Initialize the physical display
 	ClearGRAM ();							// Clear the RAM used for the pixel map
@@ -576,7 +556,7 @@ void setup()
 
 //	Box ( 0, 0, Nx, Ny, CL_WHITE );				// Draw screen outline (if desired)
 
-	trans65k ();								// Loads the pixel image into the 16 bit array
+	DamageAll ();								// The whole screen is new
 	redrawScreen = true;						// Indicate a need to repaint the display
 
 	delay ( 2000 );								// 2 seconds to read the splash screen!
@@ -587,42 +567,104 @@ void setup()
 	changed.Disp    = true;						// Display changed
 	redrawScreen    = false;					// But hasn't been repainted
 
-	lastBattRead = millis() - BATT_READ_TIME;	// Force immediate display
+/*
+ *	Give the scheduler the jobs for "loop()". They only go in if the hardware they look
+ *	at is installed. The battery is read straight away and then once a minute.
+ */
+
+	#if ( BAND_SWITCH == GPIO_EXPNDR )
+		SchedAdd ( "BandSw", BandSwitchJob, BS_READ_TIME );
+	#endif
+
+	#if ( MODE_SWITCH == GPIO_EXPNDR )
+		SchedAdd ( "ModeSw", ModeSwitchJob, MS_READ_TIME );
+	#endif
+
+	SchedAdd ( "CAT", CatJob, CAT_READ_TIME );
+
+	#if ( CLARIFIER )
+		SchedAdd ( "ClarSw", CheckClarSwitch, CLAR_READ_TIME );
+	#endif
+
+	#if ( CLARIFIER == POTENTIOMETER )
+		SchedAdd ( "ClarPot", ReadClarifier, CLAR_READ_TIME );
+	#endif
+
+	#if ( FUNCN_BUTTON == AVAILABLE )
+		SchedAdd ( "FcnBtn", CheckFcnButton, FB_READ_TIME );
+	#endif
+
+	#if ( INCR_BUTTON == AVAILABLE )
+		SchedAdd ( "IncrBtn", CheckIncrButton, INCR_READ_TIME );
+	#endif
+
+	#if ( MODE_SWITCH == PUSH_BUTTON )
+		SchedAdd ( "ModeBtn", CheckModeButton, MS_READ_TIME );
+	#endif
+
+	#if ( BATT_CHECK == AVAILABLE )
+		SchedAdd ( "Battery", BatteryJob, BATT_READ_TIME );
+	#endif
+
+	#if SAVE_STATE
+		SchedAdd ( "Save", SaveState, SAVE_READ_TIME );
+	#endif
+
+	paintJob = SchedAdd ( "Paint", PaintScreen, 0 );	// Only when "loop()" says
+
+	#if TRACE_INPUT
+		StartTrace ();							// Record from here on
+	#endif
 }
 
 
 /*
  *	"loop()" runs forever in core #1. Its primary function in life is to
  *	handle the display.
+ *
+ *	It used to read all the peripherals every time through, with each one checking
+ *	whether it was time to really look. Now the scheduler (see "sched.cpp") runs
+ *	those jobs when they're due; the times are in "config.h". When there's nothing
+ *	to do, we sleep until the next job is due or "task0()" wakes us up with a change
+ *	to paint.
  */
 
 void loop()
 {
-char 	 str[64];						// For building numerical frequency strings
-uint8_t	 strLength;						// Length of various strings in pixels
-float	 battVolts;						// Battery voltage
-uint32_t tempColor;						// For "SPLIT" display
+	SchedRun ();								// Run the jobs that are due
+
+	if ( changed.Disp && !redrawScreen )		// Did the display change?
+		SchedRunJob ( paintJob );				// Yes, paint it ("PaintScreen()")
+
+	else
+		SchedSleep ();							// Nothing to do for a while
+}
 
 
 /*
- *	We start off by reading all the peripherals. Most of them are not actually read
- *	each time through the "loop". Most of these functions has a time parameter defined
- *	in the "config.h" file that determines how often we actually read and interpret
- *	the data.
+ *	The jobs for functions that return something:
  */
 
-	ReadBandSwitch ();					// Read the band switch (if installed)
-	ReadModeSwitch ();					// Read the mode switch (if installed)
+void BandSwitchJob ()
+{
+	ReadBandSwitch ();							// Read the band switch
+}
 
-	CheckCAT ();						// Check for CAT input (always available)
+void ModeSwitchJob ()
+{
+	ReadModeSwitch ();							// Read the mode switch
+}
 
-	CheckClarSwitch ();					// Check clarifier switch (if installed)
-	ReadClarifier ();					// Read potentiometer clarifier if installed
+void CatJob ()
+{
+	if ( CheckCAT ())							// Check for CAT input
+		WakeEvents ();							// "task0()" has a new frequency, etc. to send
+}
 
-	CheckFcnButton ();					// Check the function button (if installed)
-	CheckIncrButton ();					// Check the increment button (if installed)
-	CheckModeButton ();					// Check the mode button (if installed)
-	battVolts = ReadBattery ();			// Check the battery voltage (if installed)
+void BatteryJob ()
+{
+	battVolts = ReadBattery ();					// Check the battery voltage
+}
 
 
 /*	Display the analog frequency
@@ -635,203 +677,287 @@ uint32_t tempColor;						// For "SPLIT" display
  *		you might need to mess with is you are using that display type.
  */
 
-	if ( changed.Disp )								// Did the display change?
+/*
+ *		"PaintScreen()" paints into the spare copy of the screen image, and "task0()"
+ *		swaps the copies when it starts sending what we painted. "loop()" only calls
+ *		it once "task0()" has picked up the last screen.
+ *
+ *		The text is set up first, so that clearing the screen can leave the characters
+ *		that are already there alone (see "text.cpp").
+ */
+
+void PaintScreen ()
+{
+	changed.Disp = false;						// Clear the indicator
+
+	LatencyFrame ();							// Before looking at "rxFreq"
+
+	StartDamage ();								// Keep track of what changed
+	SetOverlay ( battVolts );					// What the text says and where
+	TextClear ( CL_BG );						// Clear the display (except the text that's staying)
+
+	Dial ( rxFreq );							// Send current rxFreq to the dial
+	LatencyMark ( LAT_DIAL );
+
+	PaintOverlay ();							// Boxes, frequencies and indicators
+
+//	Box ( 0, 0, Nx, Ny, CL_WHITE );				// Draw screen outline (optional)
+
+	EndDamage ();								// Work out what needs to be sent
+	LatencyMark ( LAT_PAINT );
+	redrawScreen = true;						// Indicate the pixel information is on its way
+												// to the physical display
+	WakeEvents ();								// Get "task0()" to send it
+}
+
+
+/*
+ *	The text on the screen; each of these is painted in the same place every time
+ *	(see "text.cpp"). The "A" and "B" indicators are the "Rx", "Tx" or "TR" next to
+ *	each VFO frequency.
+ */
+
+static text_field	vfoAText, vfoALabel;		// VFO-A frequency and "[A]"
+static text_field	vfoBText, vfoBLabel;		// VFO-B frequency and "[B]"
+static text_field	trAText, trBText;			// Transmit/receive indicators
+static text_field	clarText;					// Clarifier offset
+static text_field	modeText;					// Operating mode
+static text_field	splitText;					// Split mode indicator
+static text_field	battText;					// Battery voltage
+
+static int			ulX;						// Where the underline goes
+
+
+/*
+ *	"SetOverlay()" works out what everything except the dial itself says and where it
+ *	goes; the numerical frequencies, the increment underline and all the status
+ *	indicators. The strings for the frequencies, the clarifier and the battery are
+ *	only made again when the number they show changes. Anything other than text that
+ *	might be different on the next screen (the dial and the underline) is a block for
+ *	the text. "PaintOverlay()" paints it all once the screen has been cleared.
+ *
+ *	This all used to be part of "loop()", but having it separate allows the host
+ *	benchmark (see "Host/README.md") to time it on its own.
+ */
+
+void SetOverlay ( float battVolts )
+{
+uint8_t	 strLength;						// Length of various strings in pixels
+uint32_t tempColor;						// For "SPLIT" display
+uint32_t freq;							// VFO frequency being shown
+int16_t	 clar;							// Clarifier offset being shown
+uint32_t volts;							// "battVolts" as a key for "TextChanged()"
+
+	TextBlock ( 0, 0, Nx - 1, D_HEIGHT + DP_POS );			// The dial (see "Dial()")
+
+	if ( PAINT_UL )											// The underscore
 	{
-		changed.Disp = false;						// Yes, clear the indicator
-		BoxFill ( 0, 0, Nx - 1, Ny - 1, CL_BG );	// Clear the display
+		ulX = incrX[incrCount];
+		TextBlock ( ulX, UL_Y, ulX + UL_W, UL_Y - 1 );
+	}
 
-		Dial ( rxFreq );							// Send current rxFreq to the dial
+	if ( PAINT_VFO_A )						// Display the VFO-1 numerical frequency (maybe)
+	{
+		freq = bandData[activeBand].vfoA;
 
-		if ( PAINT_BOX )							// Are we supposed to draw the box?
+		if ( TextChanged ( &vfoAText, freq ))
+			sprintf ( vfoAText.text, "%3d.%03d,%02d",  freq / 1000000,
+				( freq / 1000) % 1000, 
+				( freq / 10) % 100 );   
+
+		if ( DISP_SIZE == FT7_DISP )
 		{
-			Box ( BOX_X,   BOX_Y,   BOX_X + BOX_W,   BOX_Y + BOX_H,   CL_FREQ_BOX );
-			Box ( BOX_X-1, BOX_Y-1, BOX_X + BOX_W-1, BOX_Y + BOX_H+1, CL_FREQ_BOX );
+			TextField ( &vfoAText, vfoAText.text, VFO_A_X -12, VFO_A_Y - 2, 20, CL_FA_NUM );	// Str12 add -12 for bigger number
+			TextField ( &vfoALabel, "[A]", VFO_A_X + 110, VFO_A_Y + 2, 12, CL_FA_NUM );		// size; was +103
 		}
 
-		if ( PAINT_VFO_A )						// Display the VFO-1 numerical frequency (maybe)
+		else															// All except FT7
 		{
-			sprintf ( str, "%3d.%03d,%02d",  bandData[activeBand].vfoA / 1000000,
-				( bandData[activeBand].vfoA / 1000) % 1000, 
-				( bandData[activeBand].vfoA / 10) % 100 );   
+			TextField ( &vfoAText, vfoAText.text, VFO_A_X, VFO_A_Y, 16, CL_FA_NUM );
+			TextField ( &vfoALabel, "[A]", VFO_A_X + 103, VFO_A_Y + 2, 12, CL_FA_NUM );
+		}
+	}
 
-			if ( DISP_SIZE == FT7_DISP )
-			{
-				disp_str20( str, VFO_A_X -12, VFO_A_Y - 2, CL_FA_NUM );			// Str12 add -12 for bigger number
-				disp_str12 ( "[A]", VFO_A_X + 110, VFO_A_Y + 2, CL_FA_NUM );	// size; was +103
-			}
+	if ( PAINT_VFO_B )						// Display the VFO-1 numerical frequency (maybe)
+	{
+		freq = bandData[activeBand].vfoB;
 
-			else															// All except FT7
-			{
-				disp_str16( str, VFO_A_X, VFO_A_Y, CL_FA_NUM );
-				disp_str12 ( "[A]", VFO_A_X + 103, VFO_A_Y + 2, CL_FA_NUM );
-			}
+		if ( TextChanged ( &vfoBText, freq ))
+			sprintf ( vfoBText.text, "%3d.%03d,%02d",  freq / 1000000,
+						( freq / 1000) % 1000, 
+						( freq / 10) % 100 );
+
+		if ( DISP_SIZE == FT7_DISP )
+		{
+			TextField ( &vfoBText, vfoBText.text, VFO_B_X + 2, VFO_B_Y, 16, CL_FB_NUM );
+			TextField ( &vfoBLabel, "[B]", VFO_B_X + 110, VFO_B_Y + 2, 12, CL_FB_NUM );
+		}
+
+		else
+		{
+			TextField ( &vfoBText, vfoBText.text, VFO_B_X, VFO_B_Y, 16, CL_FB_NUM );
+			TextField ( &vfoBLabel, "[B]", VFO_B_X + 105, VFO_B_Y + 2, 12, CL_FB_NUM );
+		}
+ 		}
+
+
+	if ( xmitStatus )						// If transmitting
+		if ( splitMode )					// And split mode active
+		{
+			TextField ( &trAText, "Rx", TR_X, VFO_A_Y+2, 12, CL_INACTIVE );
+			TextField ( &trBText, "Tx", TR_X, VFO_B_Y+2, 12, CL_ACTIVE );
+		}
+
+		else								// Not in split mode
+			TextField ( &trAText, "Tx", TR_X, VFO_A_Y+2, 12, CL_ACTIVE );
+
+	else									// Receiving
+		if ( splitMode )					// And split mode active
+		{
+			TextField ( &trAText, "Rx", TR_X, VFO_A_Y+2, 12, CL_INACTIVE );
+			TextField ( &trBText, "Tx", TR_X, VFO_B_Y+2, 12, CL_INACTIVE );
 		}
+		else
+			TextField ( &trAText, "TR", TR_X, VFO_A_Y+1, 12, CL_INACTIVE );
 
-		if ( PAINT_UL )														// Paint underscore?
-			Box ( incrX[incrCount], UL_Y, incrX[incrCount] + UL_W,
-									UL_Y - 1, CL_RED );
 
-		if ( PAINT_VFO_B )						// Display the VFO-1 numerical frequency (maybe)
+	if ( CLARIFIER )							// If the clarifier is installed
+		if ( clarifierOn )						// If it's on display offset
 		{
-			sprintf ( str, "%3d.%03d,%02d",  bandData[activeBand].vfoB / 1000000,
-						( bandData[activeBand].vfoB / 1000) % 1000, 
-						( bandData[activeBand].vfoB / 10) % 100 );
+			clar = clarCount;
 
-			if ( DISP_SIZE == FT7_DISP )
+			if ( TextChanged ( &clarText, (uint16_t) clar ))
+				sprintf ( clarText.text, "CLAR %+i Hz", clar * 10 );
+
+			if (( DISP_SIZE == SMALL_DISP )
+							|| ( DISP_SIZE == FT7_DISP ))			// Small Screen
 			{
-				disp_str16( str, VFO_B_X + 2, VFO_B_Y, CL_FB_NUM );	
-				disp_str12 ( "[B]", VFO_B_X + 110, VFO_B_Y + 2, CL_FB_NUM );
+				strLength = ( strlen ( clarText.text ) * 6 ) / 2;	// Half string length in pixels
+				TextField ( &clarText, clarText.text, CLAR_X - strLength, CLAR_Y, 8, CL_ACTIVE );
 			}
 
-			else
+			else													// Large screen
 			{
-				disp_str16( str, VFO_B_X, VFO_B_Y, CL_FB_NUM );
-				disp_str12 ( "[B]", VFO_B_X + 105, VFO_B_Y + 2, CL_FB_NUM );
+				strLength = ( strlen ( clarText.text ) * 8 ) / 2;	// Half string length in pixels
+				TextField ( &clarText, clarText.text, CLAR_X - strLength, CLAR_Y, 12, CL_ACTIVE );
 			}
- 		}
-
+		}
 
-		if ( xmitStatus )						// If transmitting
-			if ( splitMode )					// And split mode active
+		else													// Not on - Indicate it's off
+		{
+			if ( DISP_SIZE == SMALL_DISP )						// Small screen
 			{
-				disp_str12 ( "Rx", TR_X, VFO_A_Y+2, CL_INACTIVE );
-				disp_str12 ( "Tx", TR_X, VFO_B_Y+2, CL_ACTIVE );
+				strLength = ( strlen ( "CLAR OFF" ) * 6 ) / 2;	// Half string length in pixels
+				TextField ( &clarText, "CLAR OFF", CLAR_X - strLength, CLAR_Y, 8, CL_INACTIVE );
 			}
 
-			else								// Not in split mode
-				disp_str12 ( "Tx", TR_X, VFO_A_Y+2, CL_ACTIVE );
-
-		else									// Receiving
-			if ( splitMode )					// And split mode active
+			else if ( DISP_SIZE == FT7_DISP )
 			{
-				disp_str12 ( "Rx", TR_X, VFO_A_Y+2, CL_INACTIVE );
-				disp_str12 ( "Tx", TR_X, VFO_B_Y+2, CL_INACTIVE );
+				strLength = ( strlen ( "CL OFF" ) * 8 ) / 2;	// Half string length in pixels
+				TextField ( &clarText, "CL OFF", CLAR_X - strLength, CLAR_Y, 12, CL_INACTIVE );
 			}
-			else
-				disp_str12 ( "TR", TR_X, VFO_A_Y+1, CL_INACTIVE );
-
 
-		if ( CLARIFIER )							// If the clarifier is installed
-			if ( clarifierOn )						// If it's on display offset
+			else												// Large screen
 			{
-				sprintf ( str, "CLAR %+i Hz", clarCount * 10 );
-
-				if (( DISP_SIZE == SMALL_DISP )
-								|| ( DISP_SIZE == FT7_DISP ))			// Small Screen
-				{
-					strLength = ( strlen ( str ) * 6 ) / 2;				// Half string length in pixels
-					disp_str8 ( str, CLAR_X - strLength, CLAR_Y, CL_ACTIVE );
-				}
-
-				else													// Large screen
-				{
-					strLength = ( strlen ( str ) * 8 ) / 2;				// Half string length in pixels
-					disp_str12 ( str, CLAR_X - strLength, CLAR_Y, CL_ACTIVE );
-				}
+				strLength = ( strlen ( "CLAR OFF" ) * 8 ) / 2;	// Half string length in pixels
+				TextField ( &clarText, "CLAR OFF", CLAR_X - strLength, CLAR_Y, 12, CL_INACTIVE );
 			}
+		}
 
-			else													// Not on - Indicate it's off
-			{
-				strcpy ( str, "CLAR OFF" );
 
-				if ( DISP_SIZE == SMALL_DISP )						// Small screen
-				{
-					strLength = ( strlen ( str ) * 6 ) / 2;			// Half string length in pixels
-					disp_str8 ( str, CLAR_X - strLength, CLAR_Y, CL_INACTIVE );
-				}
+/*
+ *	The operating mode:
+ */
 
-				else if ( DISP_SIZE == FT7_DISP )
-				{
-					strcpy ( str, "CL OFF" );
-					strLength = ( strlen ( str ) * 8 ) / 2;			// Half string length in pixels
-					disp_str12 ( str, CLAR_X - strLength, CLAR_Y, CL_INACTIVE );
-				}
+		if ( PAINT_MODE )											// It's optional now!
+		{
+			if (( DISP_SIZE == SMALL_DISP )
+							|| ( DISP_SIZE == FT7_DISP ))			// Small Screen
+				TextField ( &modeText, modeData[activeMode].modeString, MODE_X, MODE_Y, 8, CL_GREEN );
 
-				else												// Large screen
-				{
-					strLength = ( strlen ( str ) * 8 ) / 2;		// Half string length in pixels
-					disp_str12 ( str, CLAR_X - strLength, CLAR_Y, CL_INACTIVE );
-				}
-			}
+			else													// Large screen
+				TextField ( &modeText, modeData[activeMode].modeString, MODE_X, MODE_Y, 12, CL_GREEN );
+		}
 
 
 /*
- *	Paint the operating mode:
+ *	The split mode indicator:
  */
 
-			if ( PAINT_MODE )											// It's optional now!
-			{
-				strcpy ( str, modeData[activeMode].modeString );
+		if ( PAINT_SPLIT )										// On or off?
+		{
+			if ( splitMode )
+				tempColor = CL_ACTIVE;
+			else
+				tempColor = CL_INACTIVE;
 
-				if (( DISP_SIZE == SMALL_DISP )
-								|| ( DISP_SIZE == FT7_DISP ))			// Small Screen
-					disp_str8 ( str, MODE_X, MODE_Y, CL_GREEN );
+			if ( DISP_SIZE == SMALL_DISP )						// Small Screen
+				TextField ( &splitText, "SPLIT", SPLIT_X, SPLIT_Y, 8, tempColor );
 
-				else													// Large screen
-					disp_str12 ( str, MODE_X, MODE_Y, CL_GREEN );
+			else if ( DISP_SIZE == FT7_DISP )					// Glenn's display
+			{
+				strLength = ( strlen ( "SPL" ) * 6 );			// Different text; length in pixels
+				TextField ( &splitText, "SPL", SPLIT_X - strLength, SPLIT_Y, 8, tempColor );
 			}
 
+			else												// Large display
+				TextField ( &splitText, "SPLIT", SPLIT_X, SPLIT_Y, 12, tempColor );
+		}
+
 
 /*
- *	Paint the split mode indicator:
+ *	The battery voltage:
  */
 
-			if ( PAINT_SPLIT )										// On or off?
-			{
-				strcpy ( str, "SPLIT" );
-
-				if ( splitMode )
-					tempColor = CL_ACTIVE;
-				else
-					tempColor = CL_INACTIVE;
-
-				if ( DISP_SIZE == SMALL_DISP )						// Small Screen
-					disp_str8 ( str, SPLIT_X, SPLIT_Y, tempColor );
+		if ( BATT_CHECK	== AVAILABLE )							// Installed?
+		{
+			memcpy ( &volts, &battVolts, sizeof ( volts ));
 
-				else if ( DISP_SIZE == FT7_DISP )					// Glenn's display
-				{
-					strcpy ( str, "SPL" );							// Different text
-					strLength = ( strlen ( str ) * 6 );				// String length in pixels
-					disp_str8 ( str, SPLIT_X - strLength, SPLIT_Y, tempColor );
-				}
+			if ( TextChanged ( &battText, volts ))
+				sprintf ( battText.text, "%.2fV", battVolts );	// Copy voltage to string
 
-				else												// Large display
-					disp_str12 ( str, SPLIT_X, SPLIT_Y, tempColor );
+			if (( DISP_SIZE == SMALL_DISP )
+							|| ( DISP_SIZE == FT7_DISP ))		// Small Screen
+			{
+				strLength = ( strlen ( battText.text ) * 6 ) / 2;	// Half string length in pixels
+				TextField ( &battText, battText.text, BATT_X - strLength, BATT_Y, 8, CL_INACTIVE );
 			}
 
+			else												// Large display
+				TextField ( &battText, battText.text, BATT_X, BATT_Y, 12, CL_INACTIVE );
+		}
+}
+
 
 /*
- *	Paint the battery voltage:
+ *	"PaintOverlay()" paints everything "SetOverlay()" set up, in the same order it was
+ *	always painted in; the box first, then the text with the underline in between the
+ *	VFO frequencies. Only the characters that aren't still on the screen get painted.
  */
 
-			if ( BATT_CHECK	== AVAILABLE )							// Installed?
-			{
-				sprintf ( str, "%.2fV", battVolts );				// Copy voltage to string
-
-				if (( DISP_SIZE == SMALL_DISP )
-								|| ( DISP_SIZE == FT7_DISP ))		// Small Screen
-				{
-					strLength = ( strlen ( str ) * 6 ) / 2;			// Half string length in pixels
-					disp_str8 ( str, BATT_X - strLength, BATT_Y, CL_INACTIVE );
-				}
-
-				else												// Large display
-				{
-					disp_str12 ( str, BATT_X, BATT_Y, CL_INACTIVE );
-				}
-			}
+void PaintOverlay ()
+{
+	if ( PAINT_BOX )							// Are we supposed to draw the box?
+	{
+		Box ( BOX_X,   BOX_Y,   BOX_X + BOX_W,   BOX_Y + BOX_H,   CL_FREQ_BOX );
+		Box ( BOX_X-1, BOX_Y-1, BOX_X + BOX_W-1, BOX_Y + BOX_H+1, CL_FREQ_BOX );
+	}
 
+	TextPaint ( &vfoAText );
+	TextPaint ( &vfoALabel );
 
-//		Box ( 0, 0, Nx, Ny, CL_WHITE );			// Draw screen outline (optional)
+	if ( PAINT_UL )								// Paint underscore?
+		Box ( ulX, UL_Y, ulX + UL_W, UL_Y - 1, CL_RED );
 
-		if ( !redrawScreen )					// Has the screen been repainted since last change?
-		{
-			trans65k();						    // No, copy the RGB information to 16 bit pixel array
-			redrawScreen = true;				// Indicate the pixel information is on its way
-												// to the physical display
-		}
-	}											// End of if ( changed.Disp)
-}												// End of "loop()"
+	TextPaint ( &vfoBText );
+	TextPaint ( &vfoBLabel );
+	TextPaint ( &trAText );
+	TextPaint ( &trBText );
+	TextPaint ( &clarText );
+	TextPaint ( &modeText );
+	TextPaint ( &splitText );
+	TextPaint ( &battText );
+}
 
 
 /*
@@ -841,11 +967,11 @@ uint32_t tempColor;						// For "SPLIT" display
 
 void task0 ( void* arg )
 {
-uint32_t	tempFreq   =  0;					// Temporary frequency
 int16_t		lclIncr    =  0;					// Local copy of bandData[activeBand].incr
-int16_t		incrFactor =  0;					// Part of afstp accelerator formula
-int16_t		count      =  0;					// Local copy of encoder count
 int16_t		freqDir    = -1;					// Indicates direction to move frequency
+int16_t		freqCount  =  0;					// Encoder steps not used yet
+uint16_t	mult       =  1;					// Accelerator multiplier
+input_event	ev;									// From the interrupt handlers
 
 	while ( true )								// Runs forever (like "loop")
 	{
@@ -856,77 +982,72 @@ int16_t		freqDir    = -1;					// Indicates direction to move frequency
 
 
 /*
- *	First part of the math overhaul. Originally, he was allowing "count" to be
- *	negative in the "afstp" computation which was causing nonsense numbers. So,
- *	"count" is now going to always be positive in the computation.
+ *	The interrupt handlers queue up what they see, and we deal with it all here in
+ *	the order it happened. If the PTT line is connected and the transmitter is on,
+ *	the frequency can't be changed, so frequency encoder steps are ignored.
  *
- *	But, we need to take into consideration the setting of "F_REV" which tells
- *	us which way the dial rotates when the frequency increases and decreases
- *	and we need to consider which way the encoder actually moved.
- *
- *	"freqDir" will end up being either plus or minus '1' and we will multiply the
- *	result of the "afstp" calculation by that to determine whether to increase
- *	or decrease the operating frequency.
- */
-
-		if ( freqPulse )						// New interrupt?
-			freqPulse = false;					// Clear the indicator
- 
- 
- /*
  *	The "ENCDR_FCTR" is used to reduce the number of virtual interrupts from the
  *	high-speed encoders. If using a mechanical encoder, it should probably be set
- *	to '1' (in "config.h").
+ *	to '1' (in "config.h"). Every "ENCDR_FCTR" encoder steps the same way make one
+ *	step of the frequency.
+ *
+ *	We need to take into consideration the setting of "F_REV" which tells us which
+ *	way the dial rotates when the frequency increases and decreases and we need to
+ *	consider which way the encoder actually moved. "freqDir" will end up being either
+ *	plus or minus '1'.
+ *
+ *	Each step moves the frequency by the increment times what the accelerator says
+ *	(see "accel.cpp"), which depends on how fast the steps are coming.
  */
 
-		count = freqCount / ENCDR_FCTR;			// Adjusted interrupt count
-		freqCount %= ENCDR_FCTR;				// Leave the remainder for next time
-
-		if ( count != 0 )						// If we have a pulse to process
+		while ( GetEvent ( &ev ))
 		{
-			freqDir = -1;						// Direction will be plus or minus 1
+			switch ( ev.type )
+			{
+				case EV_FREQ:								// Frequency encoder
+					if ( PTT_LINE && xmitStatus )			// Frequency can't be changed
+						break;
 
-			if ( count > 0 )					// Encoder counter is positive
-				freqDir = 1;					// So frequency is increasing
+					freqCount += ev.value;
 
-			if ( F_REV == 1 )					// Dial is in reverse (?) mode
-				freqDir = -freqDir;				// Reverse frequency direction
+					if ( abs ( freqCount ) < ENCDR_FCTR )	// Not a whole step yet
+						break;
 
-			count = abs ( count );				// Always positive now
+					freqDir   = ( freqCount > 0 ) ? 1 : -1;
+					freqCount = 0;
 
-			incrFactor = lclIncr * count;		// Unaccelerated increment
+					LatencyStep ( ev.us );					// Time the change from here
 
-			if ( ACCELERATE )					// Accelertor on?
-			{
-				if ( count >= V_TH )			// At or above the threshold?
-				{
-					if ( ACC_FACTOR )							// Accelerator factor non-zero?
-						incrFactor = lclIncr * ACC_FACTOR;		// Yes - use linear acceleration
+					mult = 1;								// Unaccelerated increment
 
-					else										// If factor is zero, use dynamic mode
-					{
-						L += 1.0 * (float) ( abs (count) - V_TH );
-						incrFactor = lclIncr + ( Racc * L * L );
-					}
-				}
-			}
+					if ( ACCELERATE )						// Accelerator on?
+						mult = AccelStep ( ev.us, freqDir );
+
+					if ( F_REV == 1 )						// Dial is in reverse (?) mode
+						freqDir = -freqDir;					// Reverse frequency direction
 
-			afstp = count * incrFactor;							// Positive "afstp"
+					afstp += freqDir * lclIncr * mult;
+					break;
 
-			afstp = freqDir * ( afstp / lclIncr ) * lclIncr;	// Set direction and eliminate
-																// insignificant digits
+				case EV_CLAR:								// Clarifier encoder
+					oldClarCnt   = clarCount;				// Save old counter
+					clarCount   += ev.value;				// Add in the step
+					changed.Disp = true;
+					break;
 
-			if ( L > MaxL )										// Range check
-				L = MaxL;
-		}										// End of if ( count != 0 )
+				case EV_PTT:								// TX/RX changed
+					changed.Disp = true;					// Display needs to be updated
 
-		else									// The encoder didn't move since last check
-		{
-			L -= Rdec;							// Subtract deceleration constant
+					if ( ev.value == PTT_OFF )				// Transmitting?
+						xmitStatus = TX_OFF;				// No, set receive mode
 
-			if ( L < 0 )						// Range check
-				L = 0;
-		}										// End of if ( count != 0 )
+					else if ( xmitStatus != TX_CAT )		// If not already transmitting via CAT
+						xmitStatus = TX_MAN;				// So indicate manual transmission
+
+					CAT.SetTX ( xmitStatus );				// Set in CAT module
+					break;
+			}
+		}
 
 		if ( afstp != 0 )						// Need to update the frequency?
 		{
@@ -972,6 +1093,8 @@ int16_t		freqDir    = -1;					// Indicates direction to move frequency
 
 			if ( CLAR_FA_RESET )					// Reset clarifier on frequency change?
 				clarCount = 0;						// Yes
+
+			LatencyNewFreq ();						// The steps are in "rxFreq" now
 		}											// End of if ( afstp != 0 )	Need to update the frequency
 
 
@@ -1012,12 +1135,7 @@ int16_t		freqDir    = -1;					// Indicates direction to move frequency
 			vfoFreq = txFreq;								// Set vfo frequency
 		}
 
-		vfoFreq = labs ( bandData[activeBand].refFreq - vfoFreq );
-
-		vfoFreq = vfoFreq * bandData[activeBand].vfoDir;
-		vfoFreq = vfoFreq + bandData[activeBand].vfoRef;
-
-		vfoFreq  = vfoFreq / VFO_FACTOR;					// See "config.h" 
+		vfoFreq  = BandVFOFreq ( activeBand, vfoFreq );		// See below
 
 		vfoFreq += modeData[bandData[activeBand].opMode].vfoAdjust;
 
@@ -1028,7 +1146,9 @@ int16_t		freqDir    = -1;					// Indicates direction to move frequency
 
 		if ( vfoFreq != oldVFO )					// Only update the Si5351 if necessary
 		{
-			Set_VFO_Freq ( vfoFreq, VFO_DRIVE );	// Set the oscillator frequency
+			LatencyMark ( LAT_VFO );
+			Set_VFO_Freq ( vfoFreq, VFO_DRIVE, &bandPlan[activeBand] );	// Set the oscillator frequency
+			LatencyMark ( LAT_SI5351 );
 
 			oldVFO = vfoFreq;						// Save frequency
 		}
@@ -1058,22 +1178,36 @@ int16_t		freqDir    = -1;					// Indicates direction to move frequency
 				oldMode = modeData[activeMode].coMode;		// And/or new mode
 			}
 
-		if ( redrawScreen )							// If repaint needed
+/*
+ *	"Transfer_Done()" has to be called every time around to keep the last screen
+ *	going out to the display. Once it's all there, we can start on the next one
+ *	if "loop()" has painted it.
+ */
+
+		if ( Transfer_Done () && redrawScreen )		// If repaint needed
 		{
-			Transfer_Image ();						// Send 16 bit pixel array to the display
-			redrawScreen = false;					// And clear the repaint flag
+			Transfer_Image ();						// Start sending the new screen
+			redrawScreen = false;					// And let "loop()" paint the next one
 		}
 
+		if ( changed.Disp && !redrawScreen )		// Something for "loop()" to paint?
+			SchedWake ();							// It might be asleep
+
 
 /*
- *	Why the 1mS delay you might wonder! The ESP32 compiler builds a "watchdog" timer function into
- *	the looping tasks in both cores (here, "loop()" and "task0()"). If one of those functions does
- *	not run within the time limit set in the watchdog, an exception will occur and the processor
- *	will re-boot. The "delay" stops this task ("task0()") just long enough to give the core #1 task
- *	("loop()") control of the processor.
+ *	The ESP32 compiler builds a "watchdog" timer function into the looping tasks in both cores
+ *	(here, "loop()" and "task0()"). If one of those functions does not run within the time limit
+ *	set in the watchdog, an exception will occur and the processor will re-boot. So we have to
+ *	stop and let the rest of the system run.
+ *
+ *	This used to be a 1mS "delay" every time around. Now we sleep until the interrupt handlers
+ *	or "loop()" wake us up (see "events.cpp"), which gets encoder steps to the Si5351 sooner and
+ *	lets core #0 idle when nothing's happening. While a screen is going out to the display, we
+ *	still have to come back every millisecond to start the next piece; otherwise we only need
+ *	to come back every "TASK0_WAIT" milliseconds.
  */
 
-		delay ( 1 );
+		WaitEvents ( Transfer_Done () ? TASK0_WAIT : 1 );
 
 	}												// End of "while ( true )"
 }													// End of task0
@@ -1091,23 +1225,16 @@ bool ReadBandSwitch ()
 
 #if ( BAND_SWITCH == GPIO_EXPNDR )		// Only compile if using a physical switch
 
-static	bool	firstTime = true;		// True first time called
 		bool	foundIt   = false;		// True when we find a valid selection
 		uint8_t	aBit = 1;				// Reading from one pin of the PCF8574
 
 
 /*
- *	There is really no need to read the switch everytime through the loop, so we only
- *	look at it every "BS_READ_TIME" milliSeconds, unless it's the first time called.
+ *	There is really no need to read the switch everytime through the loop; the
+ *	scheduler calls us every "BS_READ_TIME" milliSeconds (this used to check the
+ *	mode switch's time by mistake).
  */
 
-	if ( !firstTime )										// If we've been here before
-		if (( millis() - lastModeSwRead ) < BS_READ_TIME )	// See if time to really read it
-			return true;									// Not really
-
-	lastBandSwRead = millis ();							// Update the last read time
-	firstTime      = false;								// No longer first time here
-
 	lastBand =  activeBand;								// Remember last band
 	foundIt  = false;									// Haven't found a selection yet
 
@@ -1180,23 +1307,15 @@ bool ReadModeSwitch ()
 {
 #if ( MODE_SWITCH == GPIO_EXPNDR )		// Only compile if using a physical switch
 
-static	bool	firstTime = true;		// True first time called
 		bool	foundIt   = false;		// True when we find a valid selection
 		uint8_t	aBit = 1;				// Reading from a single pin of the PCF8574
 
 
 /*
- *	There is really no need to read the switch everytime through the loop, so we only
- *	look at it every "MS_READ_TIME" milliSeconds unless it's the first time called.
+ *	There is really no need to read the switch everytime through the loop; the
+ *	scheduler calls us every "MS_READ_TIME" milliSeconds.
  */
 
-	if ( !firstTime )										// If we've been here before
-		if (( millis() - lastModeSwRead ) < MS_READ_TIME )	// See if time to really read it
-			return true;									// Not really
-
-	lastModeSwRead = millis ();						// Update the last read time
-	firstTime      = false;							// No longer first time here
-
 	lastMode =  activeMode;							// Remember last mode
 	foundIt  = false;								// Haven't found a selection yet
 
@@ -1255,11 +1374,6 @@ static 	bool 	 pressed = false;					// True when button is pushed
 
 bool	 		 buttonState;						// What we read on the pin
 
-	if (( millis() - lastModeButtonRead ) < MS_READ_TIME )	// We don't look every time through the loop
-		return;
-
-	lastModeButtonRead = millis ();					// Update the last read time
-
 	buttonState = digitalRead ( MODE_BUTTON );		// Read the button
 
 
@@ -1321,15 +1435,10 @@ static	uint16_t	reading;						// BATTERY_PIN reading
 
 
 /*
- *	There is really no need to check the battery everytime through the loop, so we only
- *	look at it every "BATT_READ_TIME" milliSeconds.
+ *	There is really no need to check the battery everytime through the loop; the
+ *	scheduler calls us every "BATT_READ_TIME" milliSeconds.
  */
 
-	if (( millis() - lastBattRead ) < BATT_READ_TIME )
-		return voltage;								// Return last measured voltage
-
-	lastBattRead = millis ();						// Update the last read time
-
 	reading = analogRead ( BATTERY_PIN );			// Read the pin
 	reading = reading - BATTERY_ADJ;				// Apply the correction factor
 	reading = reading * 2;							// Account for voltage divider on TTGO board
@@ -1350,6 +1459,201 @@ static	uint16_t	reading;						// BATTERY_PIN reading
 }
 
 
+/*
+ *	"CheckLocal()" looks for commands meant for this program rather than for the CAT
+ *	library. They start with a '#', which no CAT command does, and end with a ';'
+ *	like the CAT commands. The CAT library reads everything waiting on the serial
+ *	port, so these have to be sent on their own and not straight after a CAT command.
+ *
+ *		#TR;	Print the input recording and start a new one (if "TRACE_INPUT"
+ *				is turned on)
+ *		#LT;	Print the tuning times and start again (if "LATENCY_TRACE" is
+ *				turned on; see "latency.cpp")
+ *		#SC;	Print how long the jobs "loop()" runs are taking and start again
+ *				(see "sched.cpp")
+ *
+ *	Anything else starting with a '#' is ignored.
+ */
+
+void CheckLocal ()
+{
+static char	cmd[8];								// The command, without the '#' and ';'
+static int	len = -1;							// -1 if we're not in the middle of one
+char		c;									// Character from the serial port
+
+	while ( Serial.available () && (( len >= 0 ) || ( Serial.peek () == '#' )))
+	{
+		c = Serial.read ();
+
+		if ( c == '#' )							// Start of a command
+			len = 0;
+
+		else if ( c != ';' )					// Middle of one
+		{
+			if ( len < (int) sizeof ( cmd ) - 1 )
+				cmd[len++] = c;
+		}
+
+		else									// End of one
+		{
+			cmd[len] = '\0';
+			len = -1;
+
+			if ( strcmp ( cmd, "LT" ) == 0 )
+				LatencyDump ();
+
+			if ( strcmp ( cmd, "SC" ) == 0 )
+				SchedDump ();
+
+			#if TRACE_INPUT
+
+				if ( strcmp ( cmd, "TR" ) == 0 )
+				{
+					TraceDump ( rxFreq );
+					StartTrace ();
+				}
+
+			#endif
+		}
+	}
+}
+
+
+#if TRACE_INPUT
+
+/*
+ *	"StartTrace()" starts a new recording of the inputs with what CAT control has
+ *	for the frequencies, mode, etc. at the start so it can be played back from the
+ *	same place.
+ */
+
+void StartTrace ()
+{
+	TraceBegin ();
+	TraceCAT ( CAT.GetFA (), CAT.GetFB (), CAT.GetMDA (), CAT.GetTX (), CAT.GetST ());
+}
+
+#endif
+
+
+#if SAVE_STATE
+
+/*
+ *	"GetState()" collects the settings that are saved for the current band.
+ */
+
+void GetState ( journal_state* st )
+{
+	st->rxFreq    = rxFreq;
+	st->txFreq    = bandData[activeBand].vfoB;
+	st->clarCount = clarCount;
+	st->band      = activeBand;
+	st->mode      = activeMode;
+	st->incr      = incrCount;
+	st->flags     = ( splitMode ? JS_SPLIT : 0 ) | ( clarifierOn ? JS_CLAR : 0 );
+}
+
+
+/*
+ *	"RestoreState()" is called from "setup()" and puts what was saved for each band
+ *	back in "bandData". Anything that doesn't fit the band as it's defined now (the
+ *	journal ignores everything if the band edges have changed, but the modes or
+ *	increments might have) is left as it is in "bandData".
+ *
+ *	The band, split and clarifier settings come from the last thing saved. If there
+ *	is a physical band switch, that decides the band.
+ */
+
+void RestoreState ()
+{
+journal_state	st;								// What was saved
+
+	if ( !JournalBegin ( bandData, NBR_BANDS ))	// No flash to use
+		return;
+
+	for ( int ix = 0; ix < NBR_BANDS; ix++ )
+	{
+		if ( !JournalBand ( ix, &st ))			// Nothing saved for this band
+			continue;
+
+		if (( st.rxFreq >= bandData[ix].lowLimit ) && ( st.rxFreq <= bandData[ix].topLimit ))
+			bandData[ix].vfoA = st.rxFreq;
+
+		if (( st.txFreq >= bandData[ix].lowLimit ) && ( st.txFreq <= bandData[ix].topLimit ))
+			bandData[ix].vfoB = st.txFreq;
+
+		if (( MODE_SWITCH != GPIO_EXPNDR ) && ( st.mode < NBR_MODES ))
+			bandData[ix].opMode = st.mode;
+
+		if ( st.incr < ELEMENTS ( incrList ))
+			bandData[ix].incr = st.incr;
+	}
+
+	if ( !JournalLast ( &st ))
+		return;
+
+	if ( BAND_SWITCH != GPIO_EXPNDR )			// No band switch
+		activeBand = st.band;
+
+	if ( st.band == activeBand )				// Only if it's the same band
+	{
+		splitMode   = st.flags & JS_SPLIT;
+		clarifierOn = st.flags & JS_CLAR;
+		clarCount   = st.clarCount;
+		oldClarCnt  = clarCount;
+	}
+}
+
+
+/*
+ *	"SaveState()" is called from "loop()" and saves the settings in the flash once
+ *	they've stopped changing for "JOURNAL_QUIET" milliseconds, or have been changing
+ *	for "JOURNAL_LIMIT" milliseconds. When the band changes, whatever hadn't been
+ *	saved yet for the old band is saved straight away.
+ */
+
+void SaveState ()
+{
+static	journal_state	last;					// What the settings were last time
+static	bool			dirty = false;			// "last" hasn't been saved
+static	uint32_t		changedAt;				// When it last changed
+static	uint32_t		dirtyAt;				// When it first changed after a save
+
+journal_state			now;
+
+	GetState ( &now );
+
+	if (( now.rxFreq != last.rxFreq ) || ( now.txFreq != last.txFreq )
+			|| ( now.clarCount != last.clarCount ) || ( now.band != last.band )
+			|| ( now.mode != last.mode ) || ( now.incr != last.incr )
+			|| ( now.flags != last.flags ))
+	{
+		if ( dirty && ( now.band != last.band ))	// Changed bands
+		{
+			JournalSave ( &last );
+			dirty = false;
+		}
+
+		if ( !dirty )
+			dirtyAt = millis ();
+
+
+		last      = now;
+		dirty     = true;
+		changedAt = millis ();
+	}
+
+	if ( dirty && ((( millis () - changedAt ) >= JOURNAL_QUIET )
+					|| (( millis () - dirtyAt ) >= JOURNAL_LIMIT )))
+	{
+		JournalSave ( &last );
+		dirty = false;
+	}
+}
+
+#endif
+
+
 /*
  *	"CheckCAT()" calls the "CAT.CheckCAT()" library function to see if anything was 
  *	changed by the CAT interface. If so, we figure out what changed and perform any
@@ -1378,13 +1682,11 @@ bool	 returnCode = false;					// Assume nothing happened
 
 
 /*
- *	We only look for new messages every CAT_READ_TIME milliseconds:
+ *	We only look for new messages every CAT_READ_TIME milliseconds (the scheduler
+ *	calls us that often):
  */
 
-	if (( millis() - lastCatRead ) < CAT_READ_TIME )
-		return returnCode;						// Nothing changed
-
-	lastCatRead = millis ();					// Update the last read time
+	CheckLocal ();								// Anything for us rather than CAT?
 
 
 /*
@@ -1394,6 +1696,10 @@ bool	 returnCode = false;					// Assume nothing happened
 	if ( !CAT.CheckCAT () )						// If nothing changed
 		return returnCode;						// No more to do!
 
+	#if TRACE_INPUT								// Record what CAT control has now
+		TraceCAT ( CAT.GetFA (), CAT.GetFB (), CAT.GetMDA (), CAT.GetTX (), CAT.GetST ());
+	#endif
+
 
 /*
  *	Well, something changed, now we have to figure out what and make sure it's valid.
@@ -1614,6 +1920,11 @@ bool	 returnCode = false;					// Assume nothing happened
  *	First we have to see if the frequency falls into the range of one of the
  *	entries in the "band" array. If it does, we then need to see if the
  *	frequency is in the current band, or if we also need to change bands.
+ *
+ *	Only a VFO-A frequency with the band switching under CAT control can change
+ *	the band; "FindBand()" (see "bands.cpp") finds which one it's in. Otherwise the
+ *	frequency has to be in the current band. (That case used to leave the loop limits
+ *	unset when the band switch wasn't under CAT control.)
  */
 
 bool CheckFreq ( uint32_t newFreq, uint8_t whichOne )		// Makes sure legal frequency and sets band
@@ -1621,32 +1932,17 @@ bool CheckFreq ( uint32_t newFreq, uint8_t whichOne )		// Makes sure legal frequ
 
 int	currentBand;						// Current band index
 int	newBand;							// New frequency falls in this band (maybe)
-int ix, loop1, loop2;					// Loop index and range
 
 	currentBand = activeBand;			// Make a copy of the current active band
 	newBand     = -1;					// If we don't find a legitimate band
 
 	if (( whichOne == FA ) &&							// Doing VFO-A?
 				( BAND_SWITCH == CAT_CONTROL ))			// And band switching under CAT control
-	{
-		loop1 = 0;										// Loop through entire bandData array
-		loop2 = NBR_BANDS;
-	}
-
-	else if (( whichOne == FB ) &&						// Doing VFO-B?
-				( BAND_SWITCH == CAT_CONTROL ))			// Frequency must be in current band
-	{
-		loop1 = activeBand;								// Only look at current active band
-		loop2 = activeBand + 1;
-	}
+		newBand = FindBand ( bandData, bandIndex, NBR_BANDS, newFreq );
 
-	for ( ix = loop1; ix < loop2; ix++ )				// Loop through band or bands
-		if (( newFreq >= bandData[ix].lowLimit )		// Frequency in this band?
-			&& ( newFreq <= bandData[ix].topLimit ))
-		{
-			newBand = ix;								// New band index
-			break;										// Finished search
-		}
+	else if (( newFreq >= bandData[activeBand].lowLimit )	// Frequency must be in
+			&& ( newFreq <= bandData[activeBand].topLimit ))	// current band
+		newBand = activeBand;
 
 	if ( newBand == -1 )				// Frequency not in one of our legal bands
 		return false;
@@ -1666,41 +1962,29 @@ int ix, loop1, loop2;					// Loop index and range
 
 
 /*
- *	Frequency encoder ISR. It's pretty simple. If the encoder moves, we set a
- *	flag indicating so and make a copy of the direction it moved. Depending on
- *	which way it moved, we increment or decrement the click counter.
- *
- *	If the radio is transmitting (requires the "PTT_PIN" pin to be connected and
- *	the "PTT_LINE" indicator set to '1') we don't allow the frequency to be
- *	changed.
+ *	Frequency encoder ISR. It's pretty simple. If the encoder moves, we queue
+ *	up a step in the direction it moved for "task0()". The encoder is read even
+ *	if the radio is transmitting so it doesn't lose track of where it is; "task0()"
+ *	ignores the steps if the frequency can't be changed.
  */
 
 IRAM_ATTR void FrequencyISR ()
 {
 uint8_t	Result;								// Direction read from encoder
 
-	if ( PTT_LINE  && xmitStatus )			// If PTT connected and transmitter is on
-		return;								// Frequency can't be changed
-
-	Result = freqEncdr.process ();			// Otherwise, read the encoder
-
-	if ( Result == DIR_NONE )				// Encoder didn't move (don't think this
-		return;								// Is actually possible)
-
-	freqPulse   = true;						// Got a new pulse
-	encoderDir = Result;					// Make a copy of direction
+	Result = freqEncdr.process ();			// Read the encoder
 
 	if ( Result == DIR_CW )					// Encoder rotated clockwise
-		freqCount++;						// Increment the counter
+		PutEvent ( EV_FREQ, +1 );			// Step up
 
 	else if ( Result == DIR_CCW )			// Encoder rotated counter-clockwise
-		freqCount--;						// Decrement the counter
+		PutEvent ( EV_FREQ, -1 );			// Step down
 }
 
 
 /*
- *	This ISR handles the TX/RX indication. It sets the TX/RX status and sets
- *	a flag indicating that it changed.
+ *	This ISR handles the TX/RX indication. It queues up the new state of the
+ *	PTT line; "task0()" sets the TX/RX status and updates the display.
  *
  *	NOTE: If the clarifier is installed (either type), the PTT_LINE pin MUST
  *	be hooked up.
@@ -1710,18 +1994,7 @@ IRAM_ATTR void PTT_ISR ()
 {
 	#if ( PTT_LINE == AVAILABLE )					// Indicator wired?
 
-		changed.Disp = true;						// Which means the display needs to be updated
-
-		if ( digitalRead ( PTT_PIN ) == PTT_OFF )	// Transmitting?
-			xmitStatus = TX_OFF;					// No, set receive mode
-
-		else										// We are transmitting
-		{
-			if ( xmitStatus != TX_CAT )				// If not already transmitting via CAT control
-				xmitStatus = TX_MAN;				// So indicate manual transmission
-		}
-
-		CAT.SetTX ( xmitStatus );					// Set in CAT module	
+		PutEvent ( EV_PTT, digitalRead ( PTT_PIN ));
 
 	#endif
 }
@@ -1773,17 +2046,12 @@ void InitClarifier ()
 
 void ReadClarifier ()
 {
-int 	 clValue = 0;							// New clarifier value
-
 	#if ( CLARIFIER == POTENTIOMETER )			// Potentiometer type installed?
 
+		int 	clValue = 0;							// New clarifier value
+
 		if ( clarifierOn )            			// Is it turned on?
 		{
-			if ((millis() - lastClarPotRead ) < CLAR_READ_TIME )
-				return ;                    	// Wait for 25mS before sampling clarifier pot
-
-			lastClarPotRead = millis ();      	// Update clarifier read time
-
 			clValue = 0;									// Clear accumulator
 
 			for ( int i = 0; i < 500; i++ )					// Take a lot of readings
@@ -1806,9 +2074,9 @@ int 	 clValue = 0;							// New clarifier value
 
 
 /*
- *	Clarifier encoder ISR. Even simpler! It just increments or decrements the
- *	click counter! But note, it only compiles if the encoder type clarifier
- *	is installed.
+ *	Clarifier encoder ISR. Even simpler! It just queues up a step for "task0()"
+ *	to add to the click counter! But note, it only compiles if the encoder type
+ *	clarifier is installed.
  */
 
 IRAM_ATTR void ClarifierISR ()
@@ -1822,17 +2090,12 @@ uint8_t	Result;									// Direction read from encoder
 
 		Result = ClarEncdr.process ();
 
-		if ( Result == DIR_NONE )				// Encoder didn't move (don't think this
-			return;								// Is actually possible)
-
-		oldClarCnt = clarCount;					// Save old counter
-		changed.Disp = true;
-
 		if ( Result == DIR_CW )					// Encoder rotated clockwise
-			clarCount++;						// Increment the counter
+			PutEvent ( EV_CLAR, +1 );			// Step up
 
 		else if ( Result == DIR_CCW )			// Encoder rotated counter-clockwise
-			clarCount--;						// Decrement the counter
+			PutEvent ( EV_CLAR, -1 );			// Step down
+
 
 	#endif										// CLARIFIER == 1
 }
@@ -1861,15 +2124,8 @@ static	uint8_t	 buttonClicks = 0;					// Cumulative number of short pushes
 static 	bool 	 pressed    = false;				// True when button is pushed
 static	bool	 buttonHeld = false;				// True when the button is being held
 
-static 	uint32_t lastRead;							// Last time we checked
-
 bool	 		 buttonState;						// What we read on the pin
 
-	if (( millis() - lastRead ) < FB_READ_TIME )	// We don't look every time through the loop
-		return;
-
-	lastRead = millis ();							// Update the last read time
-
 	buttonState = digitalRead ( FUNCN_PIN );		// Read the button
 
 
@@ -2009,11 +2265,6 @@ static 	bool 	 pressed    = false;				// True when button is pushed
 
 bool	 		 buttonState;						// What we read on the pin
 
-	if (( millis() - lastIncrRead ) < INCR_READ_TIME )	// We don't look every time through the loop
-		return;
-
-	lastIncrRead = millis ();						// Update the last read time
-
 	buttonState = digitalRead ( INCR_PIN );			// Read the button
 
 
@@ -2065,10 +2316,8 @@ static 	bool 	 pressed = false;					// True when button is pushed
 
 bool	 		 buttonState;						// What we read on the pin
 
-	if (( millis() - lastClarSwRead ) < CLAR_READ_TIME )	// We don't look every time through the loop
-		return;
-
-	buttonState = digitalRead ( CLAR_ENCDR_SW );	// Read the switch
+	buttonState
+ = digitalRead ( CLAR_ENCDR_SW );	// Read the switch
 
 
 /*
@@ -2117,6 +2366,84 @@ void SwapVFOs ()
 }
 
 
+/*
+ *	"BandVFOFreq()" works out the frequency the Si5351 has to make for an operating
+ *	frequency in the band (before the mode's "vfoAdjust" is added). How it works is
+ *	explained in "task0()". The difference is worked out as a signed 32 bit number so
+ *	it comes out the same whatever size a "long" is.
+ */
+
+uint32_t BandVFOFreq ( uint8_t band, uint32_t freq )
+{
+	int32_t		offset;
+
+	offset = (int32_t) ( bandData[band].refFreq - freq );
+
+	if ( offset < 0 )
+		offset = -offset;
+
+	offset = offset * bandData[band].vfoDir;
+
+	return ( bandData[band].vfoRef + offset ) / VFO_FACTOR;
+}
+
+
+/*
+ *	"PlanBand()" works out the range of frequencies the Si5351 has to cover for a
+ *	band, in any mode and with a bit to spare for the clarifier, and has the Si5351
+ *	module pick "M" and "R" values for the whole range. That way the PLL never has
+ *	to be reset (which clicks) while tuning across the band.
+ *
+ *	If one set of values won't do (the band is too wide), it says so, and the PLL
+ *	will get reset if tuning takes it across one of the places "M" changes.
+ */
+
+#define	PLAN_SPARE	2000							// Room for the clarifier (Hz)
+
+void PlanBand ( uint8_t band )
+{
+	uint32_t	low, high, freq;
+	int16_t		adjLow = 0, adjHigh = 0;
+
+	for ( int ix = 0; ix < NBR_MODES; ix++ )			// Range of the mode adjustments
+	{
+		adjLow  = min ( adjLow,  modeData[ix].vfoAdjust );
+		adjHigh = max ( adjHigh, modeData[ix].vfoAdjust );
+	}
+
+	low  = BandVFOFreq ( band, bandData[band].lowLimit );
+	high = BandVFOFreq ( band, bandData[band].topLimit );
+
+	if ( low > high )									// VFO goes down as frequency goes up
+	{
+		freq = low;
+		low  = high;
+		high = freq;
+	}
+
+
+	freq = bandData[band].refFreq;						// The VFO turns round here
+
+	if (( freq > bandData[band].lowLimit ) && ( freq < bandData[band].topLimit ))
+	{
+		low  = min ( low,  BandVFOFreq ( band, freq ));
+		high = max ( high, BandVFOFreq ( band, freq ));
+	}
+
+	low  += adjLow  - PLAN_SPARE / VFO_FACTOR;
+	high += adjHigh + PLAN_SPARE / VFO_FACTOR;
+
+	if ( !SetBandPlan ( low, high, &bandPlan[band] ))
+	{
+		Serial.print   ( "\nNo one Si5351 setting covers " );
+		Serial.print   ( low );
+		Serial.print   ( " to " );
+		Serial.println ( high );
+		Serial.println ( "The PLL will be reset when crossing some frequencies in this band." );
+	}
+}
+
+
 /*
  *	Non-blocking delay function:
  */
@@ -0,0 +1,90 @@
+/*
+ *	"accel.cpp"
+ *
+ *	"accel.cpp" is the tuning accelerator. "task0()" calls "AccelStep()" for every
+ *	step of the frequency encoder with the time the interrupt handler saw it, and
+ *	gets back how many times the frequency increment the step should move.
+ *
+ *	The speed of the knob comes from the time between steps, smoothed a little so
+ *	one fast or slow step doesn't make much difference, then "ACC_CURVE" in "config.h"
+ *	turns that into the multiplier. Only the step times go into it, so it comes out
+ *	the same however often "task0()" gets to look at the steps.
+ *
+ *	The old accelerator added up how many steps came in each time around "task0()",
+ *	so how it behaved depended on how long everything else in "task0()" took.
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include "config.h"							// User customization stuff
+#include "accel.h"							// Our function prototypes
+
+#define	SMOOTH		4						// Each step moves the average 1/4 of the way
+
+static const acc_point	accCurve[] = ACC_CURVE;
+static const uint8_t	nbrPoints  = sizeof ( accCurve ) / sizeof ( accCurve[0] );
+
+static uint32_t		lastUs  = 0;			// Time of the last step
+static uint32_t		avgUs   = 0;			// Average time between steps (0 = stopped)
+static int8_t		lastDir = 0;			// Which way it was going
+
+
+/*
+ *	"AccelStep()" takes the time of a step ("micros()") and which way it went. Turning
+ *	the knob the other way or stopping for "ACC_REST" milliseconds starts again
+ *	from the slowest speed.
+ */
+
+uint16_t AccelStep ( uint32_t us, int8_t dir )
+{
+	uint32_t	gap = us - lastUs;
+
+	lastUs = us;
+
+	if (( avgUs == 0 ) || ( dir != lastDir ) || ( gap >= ACC_REST * 1000UL ))
+		avgUs = ACC_REST * 1000UL;					// Starting from a standstill
+
+	else
+		avgUs = avgUs - avgUs / SMOOTH + gap / SMOOTH;
+
+	if ( avgUs == 0 )								// Steps faster than we can time
+		avgUs = 1;
+
+	lastDir = dir;
+
+	uint32_t	rate = AccelRate ();
+
+	if ( rate <= accCurve[0].rate )					// Slowest
+		return accCurve[0].mult;
+
+	for ( uint8_t ix = 1; ix < nbrPoints; ix++ )
+	{
+		const acc_point&	lo = accCurve[ix - 1];
+		const acc_point&	hi = accCurve[ix];
+
+		if ( rate < hi.rate )						// Somewhere between "lo" and "hi"
+			return lo.mult + ( (int32_t) hi.mult - lo.mult ) * (int32_t) ( rate - lo.rate )
+														   / (int32_t) ( hi.rate - lo.rate );
+	}
+
+	return accCurve[nbrPoints - 1].mult;			// Faster than the last point
+}
+
+
+/*
+ *	"AccelRate()" returns the speed (steps per second) the last step was going at:
+ */
+
+uint16_t AccelRate ( void )
+{
+	if ( avgUs == 0 )
+		return 0;
+
+	return min ( 1000000UL / avgUs, 65535UL );
+}
+
+
+void AccelReset ( void )
+{
+	avgUs   = 0;
+	lastDir = 0;
+}
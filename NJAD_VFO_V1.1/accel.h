@@ -0,0 +1,34 @@
+/*
+ *	"accel.h"
+ *
+ *	"accel.h" contains the definitions and function prototypes for the "accel.cpp"
+ *	module, the tuning accelerator.
+ */
+
+#ifndef _ACCEL_H_
+#define _ACCEL_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "ACC_CURVE", etc.
+
+
+/*
+ *	One point on the "ACC_CURVE":
+ */
+
+struct acc_point
+{
+	uint16_t	rate;					// Steps per second
+	uint16_t	mult;					// What to multiply the step by
+};
+
+
+/*
+ *	Function prototypes:
+ */
+
+uint16_t AccelStep ( uint32_t us, int8_t dir );		// Multiplier for a step at time "us"
+uint16_t AccelRate ( void );						// Speed worked out for the last step
+void	 AccelReset ( void );						// Start again from a standstill
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ *	"bands.cpp"
+ *
+ *	"bands.cpp" finds which entry in the "bandData" array a frequency belongs to.
+ *	"CheckFreq()" used to look through all of them for every CAT frequency change,
+ *	and there can be up to 255 of them; logging programs send a lot of frequency
+ *	changes when clicking around a band map or scanning.
+ *
+ *	"IndexBands()" is called once from "setup()" and puts the band numbers in order
+ *	of their lower band edges. "FindBand()" can then find the band with a binary
+ *	search, which takes at most 8 looks at the table instead of up to 255.
+ *
+ *	That only works if no two bands overlap. If they do, or one has its band edges
+ *	the wrong way round, "IndexBands()" says so on the serial port and "FindBand()"
+ *	goes back to looking through the bands in order, so it still finds the first
+ *	one that has the frequency in it, as it always did.
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include "config.h"							// User customization stuff
+#include "bands.h"							// Our function prototypes
+
+
+/*
+ *	"IndexBands()" sorts the "count" band numbers into "order" by lower band edge
+ *	and returns "true" if the bands don't overlap.
+ */
+
+bool IndexBands ( const band_data* bands, uint8_t count, uint8_t* order )
+{
+	bool	ok = true;
+	int		ix, jx;
+
+	for ( ix = 0; ix < count; ix++ )				// Insertion sort; it's only done once
+	{
+		uint8_t	band = ix;
+
+		for ( jx = ix; ( jx > 0 ) && ( bands[order[jx - 1]].lowLimit > bands[band].lowLimit ); jx-- )
+			order[jx] = order[jx - 1];
+
+		order[jx] = band;
+
+		if ( bands[ix].lowLimit > bands[ix].topLimit )
+		{
+			Serial.printf ( "\nBand %d's lower edge (%u) is above its upper edge (%u)\n",
+								ix, bands[ix].lowLimit, bands[ix].topLimit );
+			ok = false;
+		}
+	}
+
+	for ( ix = 1; ix < count; ix++ )
+	{
+		const band_data&	lower = bands[order[ix - 1]];
+		const band_data&	upper = bands[order[ix]];
+
+		if ( upper.lowLimit <= lower.topLimit )
+		{
+			Serial.printf ( "\nBands %d (%u to %u) and %d (%u to %u) overlap\n",
+								order[ix - 1], lower.lowLimit, lower.topLimit,
+								order[ix], upper.lowLimit, upper.topLimit );
+			ok = false;
+		}
+	}
+
+	if ( !ok )
+		Serial.println ( "Frequencies will be looked up the slow way; please fix \"bandData\"." );
+
+	return ok;
+}
+
+
+/*
+ *	"FindBand()" returns the number of the band "freq" is in, or -1 if it isn't in
+ *	any of them. "order" is what "IndexBands()" worked out, or NULL if the bands
+ *	overlap.
+ */
+
+int FindBand ( const band_data* bands, const uint8_t* order, uint8_t count, uint32_t freq )
+{
+	if ( order == NULL )								// Look through them all
+	{
+		for ( int ix = 0; ix < count; ix++ )
+			if (( freq >= bands[ix].lowLimit ) && ( freq <= bands[ix].topLimit ))
+				return ix;
+
+		return -1;
+	}
+
+	int		low = 0, high = count;					// Find the first band that
+													// starts above "freq"
+	while ( low < high )
+	{
+		int		mid = ( low + high ) / 2;
+
+		if ( bands[order[mid]].lowLimit <= freq )
+			low = mid + 1;
+
+		else
+			high = mid;
+	}
+
+	if ( low == 0 )									// Below all of them
+		return -1;
+
+	uint8_t		band = order[low - 1];				// The one before it is the only
+													// one "freq" can be in
+	return ( freq <= bands[band].topLimit ) ? band : -1;
+}
@@ -0,0 +1,22 @@
+/*
+ *	"bands.h"
+ *
+ *	"bands.h" contains the function prototypes for the "bands.cpp" module, which
+ *	finds the band in the "bandData" array a frequency is in.
+ */
+
+#ifndef _BANDS_H_
+#define _BANDS_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "band_data"
+
+
+/*
+ *	Function prototypes:
+ */
+
+bool IndexBands ( const band_data* bands, uint8_t count, uint8_t* order );
+int	 FindBand ( const band_data* bands, const uint8_t* order, uint8_t count, uint32_t freq );
+
+#endif
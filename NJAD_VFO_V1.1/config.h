@@ -172,9 +172,14 @@
  *	Many of the locations of things on the screen are conditionalized based on the
  *	screen size. The fonts used on the splash screen also vary with the screen
  *	size.
+ *
+ *	The host build (see "Host/README.md") sets "DISP_SIZE" itself when it builds the
+ *	benchmarks for all four sizes, hence the "#ifndef".
  */
 
-#define	DISP_SIZE	CUSTOM_DISP			// Custom display currently in use
+#ifndef	DISP_SIZE
+	#define	DISP_SIZE	CUSTOM_DISP			// Custom display currently in use
+#endif
 
 
 /*
@@ -329,6 +334,21 @@
 #define	SI_I2C_ADDR	  0x60			// Standard I2C Address for the Si5351
 
 
+/*
+ *	"SI_I2C_SPEED" sets the timing used on the Si5351 bus. "SI_I2C_STANDARD" is the
+ *	100KHz I2C standard mode and "SI_I2C_FAST" is the 400KHz fast mode; the Si5351
+ *	handles either one. If you have long wires to the Si5351 and it doesn't always
+ *	do what it's told, try the standard mode.
+ */
+
+#define	SI_I2C_STANDARD	   0			// 100KHz
+#define	SI_I2C_FAST		   1			// 400KHz
+
+#ifndef	SI_I2C_SPEED
+	#define	SI_I2C_SPEED	SI_I2C_FAST
+#endif
+
+
 /*
  *	Define the things associated with the clarifier if either type is installed.
  */
@@ -396,7 +416,8 @@
 /*
  *	These definitions control how often we read the bandswitch and potentiometer type
  *	clarifier (the encoder clarifier implementation is handled with interrupts) and
- *	other stuff.
+ *	other stuff. Each one is a job for the scheduler (see "sched.cpp"), which runs it
+ *	on that beat and lets "loop()" sleep in between.
  */
 
 #define	BS_READ_TIME	   25UL		// Read the band switch every 25mS
@@ -406,6 +427,7 @@
 #define FB_READ_TIME	   25UL		// Check the function button every 25mS
 #define INCR_READ_TIME	   25UL		// Check the increment button every 25mS
 #define BATT_READ_TIME	60000UL		// Check the battery once per minute
+#define SAVE_READ_TIME	  250UL		// See if the settings need saving every 1/4 second
 
 
 /*
@@ -431,18 +453,29 @@
 /*
  *	Accelerator parameters. "ACCELERATE" turns the feature on or off.
  *
- *	If "ACC_FACTOR" is zero, TJ's original dynamic accelerate/decelerate math is used
- *	(it's really cool). If "ACC_FACTOR" is a number other than zero, a linear
- *	acceleration formula is used that just multiplies the "bandData.incr" value by the
- *	"ACC_FACTOR" when it kicks in.
+ *	The faster the knob turns, the bigger each step gets. How fast it's turning is
+ *	worked out from the times of the encoder steps (after dividing by "ENCDR_FCTR"),
+ *	so it doesn't matter how busy the program is. "ACC_CURVE" says how much each
+ *	step is multiplied by (the frequency increment is multiplied by that) at a given
+ *	speed in steps per second. In between the points in the list, it's worked out on
+ *	a straight line; above the last one it stays the same. The speeds have to go up.
  *
- *	"V_TH" is the number of encoder interrupts that must be seen in one read of the
- *	encoder for the accelerator to kick in.
+ *	For a steady multiplier once the knob gets going (like the old "ACC_FACTOR"),
+ *	use something like "{{ 0, 1 }, { 29, 1 }, { 30, 10 }}".
+ *
+ *	"ACC_REST" is how long (in milliseconds) between steps counts as the knob having
+ *	stopped; the next step starts off at the slowest speed again.
  */
 
 #define	ACCELERATE	  true		// Accelerator enabled = "true"; Off = "false"
-#define	ACC_FACTOR	  0			// Frequency increment multiplier with accelerator on
-#define	V_TH		  2			// Encoder count where the accelerator kinks in
+
+#define	ACC_CURVE	{{   0,   1 },	/* Steps per second, multiplier */ \
+					 {  20,   1 },	\
+					 {  50,   5 },	\
+					 { 100,  20 },	\
+					 { 200,  50 }}
+
+#define	ACC_REST	100			// Milliseconds between steps to count as stopped
 
 
 /*
@@ -755,6 +788,22 @@
 #endif
 
 
+/*
+ *	Setting "DIAL_LINEAR" to "true" replaces the dial radius ("D_R") above with 45000,
+ *	which turns the dial into a straight scale across the screen instead of an arc.
+ *	The fixed point dial ("DIAL_FIXED_POINT" below) can't handle a radius that big.
+ */
+
+#ifndef	DIAL_LINEAR
+	#define	DIAL_LINEAR			 false		// Straight dial
+#endif
+
+#if DIAL_LINEAR
+	#undef	D_R
+	#define	D_R				 45000
+#endif
+
+
 /*
  *	The following are the things that the user can change to modify the appearance
  *	and/or behavior of the dial itself. They were moved from the original "dial_prm.h"
@@ -811,6 +860,184 @@
 #define		TNCL_SUB			16		// Space between Number and Tick (Sub)
 
 
+/*
+ *	Painting the dial scales is by far the slowest part of updating the display. With
+ *	"DIAL_CACHE" set to "true", "Dial()" remembers the last few positions of each scale
+ *	it painted and re-uses them instead of doing all the math over again. This makes a
+ *	big difference when the display is repainted without the frequency changing, and
+ *	on the main scale, which only moves a small fraction of a pixel for each step of
+ *	the encoder.
+ *
+ *	To make that work, the position of the scales is rounded off to the nearest
+ *	1/DIAL_CACHE_SUBPIX of a pixel at the outside edge of the dial. "DIAL_CACHE_SLOTS"
+ *	is how many positions are remembered for each scale and "DIAL_CACHE_POINTS" is
+ *	the maximum number of pixels in one of them. The cache lives in the PSRAM.
+ */
+
+#define		DIAL_CACHE			  true		// Cache painted dial scales
+#define		DIAL_CACHE_SUBPIX		 8		// Position resolution (fractions of a pixel)
+#define		DIAL_CACHE_SLOTS		 8		// Positions remembered for each scale
+#define		DIAL_CACHE_POINTS	  4096		// Maximum pixels in one scale
+
+
+/*
+ *	On a straight (or nearly straight) dial, moving a scale a whole number of pixels is
+ *	just sliding the picture sideways. With "DIAL_SCROLL" set to "true", when there's no
+ *	remembered position that matches, "Dial()" looks for one that's a few pixels away
+ *	at the same fraction of a pixel, slides that over and only paints the strip that
+ *	slid onto the screen at the end. How far a position can be slid is worked out from
+ *	the dial radius so the result is within 1/DIAL_CACHE_SUBPIX of a pixel; on the
+ *	curved dials it's not at all, so this only does anything with "DIAL_LINEAR".
+ */
+
+#ifndef	DIAL_SCROLL
+	#define	DIAL_SCROLL			  true		// Slide cached scales on a straight dial
+#endif
+
+
+/*
+ *	The ESP32's floating point unit only does single precision and is slow converting
+ *	between floating point and integers, both of which the dial painting does a lot of.
+ *	Setting "DIAL_FIXED_POINT" to "true" makes it do the rotations and antialiasing with
+ *	integer (fixed point) math instead. The result can differ from the floating point
+ *	version by 1 in the last bit of a color here and there, which you'll never see.
+ *	The host build tests both versions against each other.
+ */
+
+#ifndef	DIAL_FIXED_POINT
+	#define	DIAL_FIXED_POINT	 false		// Use fixed point math for the dial
+#endif
+
+#if DIAL_FIXED_POINT && DIAL_LINEAR
+	#error "DIAL_FIXED_POINT" does not work with "DIAL_LINEAR"
+#endif
+
+
+/*
+ *	Most display updates only change a small part of the screen; the clarifier offset,
+ *	the "TX" indicator, etc. With "DAMAGE_TRACKING" set to "true", the painting functions
+ *	remember what they painted where, and only the parts of the screen that came out
+ *	different from the last time get sent to the display.
+ *
+ *	"DAMAGE_ITEMS" is how many things (strings, lines, boxes and the dial) can be
+ *	remembered for one screen; if more than that get painted, the whole screen is sent.
+ *	"DAMAGE_RECTS" is the most separate rectangles that will be sent to the display;
+ *	if there are more changed areas than that, the closest ones get combined.
+ */
+
+#define		DAMAGE_TRACKING		  true		// Only send the changed parts of the screen
+#define		DAMAGE_ITEMS			64		// Things remembered per screen
+#define		DAMAGE_RECTS			 8		// Maximum rectangles sent to the display
+
+
+/*
+ *	The screen is painted again from scratch every time something changes, but most
+ *	of the time the only text that changes is the last few digits of VFO-A. With
+ *	"TEXT_RETAIN" set to "true", the frequencies and indicators remember what they
+ *	painted in each copy of the screen image (see "text.cpp") and only the characters
+ *	that are different get cleared and painted again. Text on top of the dial always
+ *	gets painted, since the dial is painted under it every time.
+ */
+
+#ifndef	TEXT_RETAIN
+	#define	TEXT_RETAIN			  true		// Only paint the characters that changed
+#endif
+
+
+/*
+ *	There are two copies of the screen image; "loop()" paints the next screen in one
+ *	while the other one is being sent to the display. With "DISPLAY_DMA" set to "true",
+ *	the sending is done by the SPI DMA hardware, so "task0()" only has to start each
+ *	piece and can get back to the encoder and the Si5351 instead of waiting for the
+ *	pixels to go out.
+ *
+ *	The DMA can't read the PSRAM the images are in, so the pieces are copied into two
+ *	buffers in the internal memory first; "DMA_PIXELS" is the size of each of those.
+ */
+
+#ifndef	DISPLAY_DMA
+	#define	DISPLAY_DMA			  true		// Send the screen with the SPI DMA
+#endif
+#define		DMA_PIXELS			  4096		// Pixels in each DMA buffer (2 bytes each)
+
+
+/*
+ *	The encoder and PTT interrupt handlers put what they see in a queue for "task0()"
+ *	to deal with (see "events.cpp"). "EVENT_QUEUE" is how many events it can hold; it
+ *	has to be a power of 2. "task0()" empties it about once a millisecond, so it only
+ *	has to be big enough for the encoder steps that could come in while it's busy
+ *	with something else.
+ */
+
+#define		EVENT_QUEUE				64		// Input events waiting for "task0()"
+
+
+/*
+ *	"task0()" sleeps until there's something for it to do, but never longer than
+ *	"TASK0_WAIT" milliseconds.
+ */
+
+#define		TASK0_WAIT				20		// Longest "task0()" sleeps (mS)
+
+
+/*
+ *	The scheduler (see "sched.cpp") can run up to "SCHED_JOBS" jobs for "loop()".
+ *	"SCHED_WHEEL" is how many milliseconds its timer wheel goes round; it has to be
+ *	a power of 2, and it's the longest "loop()" sleeps without waking up to look.
+ */
+
+#define		SCHED_JOBS				16		// Jobs "loop()" can have
+#define		SCHED_WHEEL				32		// Slots (mS) in the timer wheel
+
+
+/*
+ *	Setting "TRACE_INPUT" to "true" records everything the encoders, the PTT line and
+ *	CAT control do (see "trace.cpp") so that a real operating session can be played
+ *	back in the host build ("Host/trace_replay.cpp"). Sending "#TR;" on the serial
+ *	port prints what's been recorded and starts a new recording. "TRACE_SIZE" is how
+ *	many things can be recorded; each takes 12 bytes of PSRAM. Recording stops when
+ *	it's full.
+ */
+
+#ifndef	TRACE_INPUT
+	#define	TRACE_INPUT			 false		// Record the inputs for the host build
+#endif
+#define		TRACE_SIZE			  8192		// Things the recording can hold
+
+
+/*
+ *	With "LATENCY_TRACE" set to "true", the program times how long it takes from a
+ *	step of the tuning knob to the new frequency getting to the Si5351 and to the
+ *	new screen getting to the display (see "latency.cpp"). Sending "#LT;" on the
+ *	serial port prints the times and starts again.
+ */
+
+#ifndef	LATENCY_TRACE
+	#define	LATENCY_TRACE		  true		// Time the tuning
+#endif
+
+
+/*
+ *	With "SAVE_STATE" set to "true", the band, frequencies, mode, frequency increment,
+ *	split and clarifier settings are saved in the flash (see "journal.cpp") and the
+ *	radio starts up where it was left. Nothing is saved until the settings have been
+ *	left alone for "JOURNAL_QUIET" milliseconds, or have been changing for more than
+ *	"JOURNAL_LIMIT" milliseconds, so tuning across a band only writes once.
+ *
+ *	"JOURNAL_SECTORS" 4K sectors at the start of the "JOURNAL_PARTITION" partition are
+ *	used (the "spiffs" partition is there in all the standard partition schemes). Each
+ *	sector holds 170 saves (less a copy of the latest one for each band) before the
+ *	next one is used, so with 4 of them and a save every minute, the flash would
+ *	last for more than 10 years of non-stop tuning.
+ */
+
+#define		SAVE_STATE			  true		// Remember the settings
+#define		JOURNAL_PARTITION	"spiffs"	// Flash partition to use
+#define		JOURNAL_SECTORS			 4		// Sectors of it to use
+#define		JOURNAL_QUIET		  3000		// Save when nothing changed for this long (mS)
+#define		JOURNAL_LIMIT		 60000		// But don't wait longer than this (mS)
+
+
 /*
  *	Let's define some colors that are used to draw things. Feel free to add to the
  *	list. The following link is a handy tool for selecting colors and getting the
@@ -0,0 +1,262 @@
+/*
+ *	"damage.cpp"
+ *
+ *	"damage.cpp" keeps track of which parts of the screen changed so "Transfer_Image()"
+ *	only has to send those instead of the whole screen.
+ *
+ *	"loop()" still repaints nearly everything in "GRAM65k" every time something changes,
+ *	which is pretty quick compared to sending it all to the display. Every painting
+ *	function ("Dial()", "Line()", "BoxFill()", the "disp_strN()" functions and the text
+ *	fields in "text.cpp") tells us the rectangle it painted along with a "signature"
+ *	that's different if what it painted would look different; the frequency for the
+ *	dial, the string and color for text, etc.
+ *
+ *	When the screen is finished, "EndDamage()" compares the list with the one from the
+ *	last time. Anything that was painted exactly the same way both times didn't change;
+ *	the rectangles for everything else (what's there now and what used to be there) are
+ *	added to the list of areas that need to be sent to the display.
+ *
+ *	"loop()" doesn't paint another screen until "Transfer_Image()" has taken the list,
+ *	so each list describes the changes from one screen to the next one.
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include "config.h"							// User customization stuff
+#include "display.h"						// Defines "Nx" and "Ny"
+#include "damage.h"							// Our function prototypes
+
+
+/*
+ *	What got painted where:
+ */
+
+struct damage_item
+{
+	damage_rect	rect;						// Where it was painted
+	uint32_t	sig;						// What it looked like
+};
+
+static damage_item	itemList[2][DAMAGE_ITEMS];	// This screen and the last one
+static int			itemCount[2]    = { 0, 0 };
+static bool			itemOverflow[2] = { false, false };
+static int			thisScreen      = 0;		// Which one is this screen
+
+static damage_rect	dirtyRect[DAMAGE_RECTS];	// Areas that need to be sent
+static int			dirtyCount = 0;
+
+
+/*
+ *	"StartDamage()" is called before painting a new screen. Whatever was painted
+ *	since the last call is what's on the screen now.
+ */
+
+void StartDamage ( void )
+{
+	thisScreen ^= 1;
+
+	itemCount[thisScreen]    = 0;
+	itemOverflow[thisScreen] = false;
+}
+
+
+/*
+ *	"AddDamage()" is called by the painting functions. The limits don't have to be in
+ *	order (the underline is painted upside down) and they get clipped to the screen.
+ */
+
+void AddDamage ( int x_min, int y_min, int x_max, int y_max, uint32_t sig )
+{
+	damage_item*	item;
+	int				temp;
+
+	if ( x_min > x_max )	{ temp = x_min; x_min = x_max; x_max = temp; }
+	if ( y_min > y_max )	{ temp = y_min; y_min = y_max; y_max = temp; }
+
+	if ( x_min < 0 )	x_min = 0;
+	if ( y_min < 0 )	y_min = 0;
+	if ( x_max >= Nx )	x_max = Nx - 1;
+	if ( y_max >= Ny )	y_max = Ny - 1;
+
+	if ( x_min > x_max || y_min > y_max )			// Nothing on the screen
+		return;
+
+	if ( itemCount[thisScreen] >= DAMAGE_ITEMS )	// No room to remember it?
+	{
+		itemOverflow[thisScreen] = true;			// Then we'll send everything
+		return;
+	}
+
+	item = &itemList[thisScreen][itemCount[thisScreen]++];
+
+	item->rect.x_min = x_min;  item->rect.y_min = y_min;
+	item->rect.x_max = x_max;  item->rect.y_max = y_max;
+	item->sig = sig;
+}
+
+
+/*
+ *	"DamageSig()" makes a signature out of a string and a number which is usually the
+ *	color and size of the font (FNV-1a hash).
+ */
+
+uint32_t DamageSig ( const char* s, uint32_t seed )
+{
+	uint32_t	h = 2166136261UL ^ seed;
+
+	while ( *s )
+		h = ( h ^ (uint8_t) *s++ ) * 16777619UL;
+
+	return h;
+}
+
+
+/*
+ *	"Area()" returns the number of pixels in a rectangle and "Union()" returns the
+ *	smallest rectangle that holds both of the ones given.
+ */
+
+static long Area ( const damage_rect& r )
+{
+	return (long) ( r.x_max - r.x_min + 1 ) * (long) ( r.y_max - r.y_min + 1 );
+}
+
+static damage_rect Union ( const damage_rect& a, const damage_rect& b )
+{
+	damage_rect	u;
+
+	u.x_min = min ( a.x_min, b.x_min );  u.y_min = min ( a.y_min, b.y_min );
+	u.x_max = max ( a.x_max, b.x_max );  u.y_max = max ( a.y_max, b.y_max );
+
+	return u;
+}
+
+static bool Touching ( const damage_rect& a, const damage_rect& b )
+{
+	return a.x_min <= b.x_max + 1 && b.x_min <= a.x_max + 1
+		&& a.y_min <= b.y_max + 1 && b.y_min <= a.y_max + 1;
+}
+
+
+/*
+ *	"AddDirty()" adds a rectangle to the list of areas that need to be sent. If it
+ *	overlaps or touches one that's already there, the two are combined (which might
+ *	make it overlap another one, and so on). If the list is full, the rectangle is
+ *	combined with whichever one makes the smallest increase in the number of pixels.
+ */
+
+static void AddDirty ( damage_rect r )
+{
+	int		ix;
+	int		best;
+	long	cost, bestCost;
+
+	for ( ix = 0; ix < dirtyCount; )
+	{
+		if ( Touching ( r, dirtyRect[ix] ))
+		{
+			r = Union ( r, dirtyRect[ix] );				// Combine them
+			dirtyRect[ix] = dirtyRect[--dirtyCount];	// and start over
+			ix = 0;
+		}
+		else
+			ix++;
+	}
+
+	if ( dirtyCount < DAMAGE_RECTS )
+	{
+		dirtyRect[dirtyCount++] = r;
+		return;
+	}
+
+	best = 0;
+	bestCost = 0x7FFFFFFF;
+
+	for ( ix = 0; ix < dirtyCount; ix++ )
+	{
+		cost = Area ( Union ( r, dirtyRect[ix] )) - Area ( dirtyRect[ix] );
+
+		if ( cost < bestCost )
+		{
+			best = ix;
+			bestCost = cost;
+		}
+	}
+
+	r = Union ( r, dirtyRect[best] );
+	dirtyRect[best] = dirtyRect[--dirtyCount];
+
+	AddDirty ( r );									// It might touch something else now
+}
+
+
+/*
+ *	"DamageAll()" says the whole screen has to be sent.
+ */
+
+void DamageAll ( void )
+{
+	dirtyRect[0].x_min = 0;		 dirtyRect[0].y_min = 0;
+	dirtyRect[0].x_max = Nx - 1; dirtyRect[0].y_max = Ny - 1;
+
+	dirtyCount = 1;
+}
+
+
+/*
+ *	"EndDamage()" is called when the screen has been painted. Everything on this
+ *	screen that doesn't have an identical twin on the last one (and vice versa) is
+ *	a change.
+ */
+
+void EndDamage ( void )
+{
+	damage_item*	now  = itemList[thisScreen];
+	damage_item*	then = itemList[thisScreen ^ 1];
+	int				nowCount  = itemCount[thisScreen];
+	int				thenCount = itemCount[thisScreen ^ 1];
+	bool			same[2][DAMAGE_ITEMS];
+	int				ix, jx;
+
+	if ( !DAMAGE_TRACKING || itemOverflow[0] || itemOverflow[1] )
+	{
+		DamageAll ();
+		return;
+	}
+
+	memset ( same, 0, sizeof ( same ));
+
+	for ( ix = 0; ix < nowCount; ix++ )
+		for ( jx = 0; jx < thenCount; jx++ )
+			if ( !same[1][jx] && now[ix].sig == then[jx].sig
+					&& memcmp ( &now[ix].rect, &then[jx].rect, sizeof ( damage_rect )) == 0 )
+			{
+				same[0][ix] = true;
+				same[1][jx] = true;
+				break;
+			}
+
+	for ( ix = 0; ix < nowCount; ix++ )
+		if ( !same[0][ix] )
+			AddDirty ( now[ix].rect );
+
+	for ( jx = 0; jx < thenCount; jx++ )
+		if ( !same[1][jx] )
+			AddDirty ( then[jx].rect );
+}
+
+
+/*
+ *	"TakeDamage()" copies the list of areas that need to be sent into "rects" (which
+ *	must have room for "DAMAGE_RECTS" of them), clears the list and returns how many
+ *	there were.
+ */
+
+int TakeDamage ( damage_rect* rects )
+{
+	int		count = dirtyCount;
+
+	memcpy ( rects, dirtyRect, count * sizeof ( damage_rect ));
+	dirtyCount = 0;
+
+	return count;
+}
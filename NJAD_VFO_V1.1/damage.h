@@ -0,0 +1,39 @@
+/*
+ *	"damage.h"
+ *
+ *	"damage.h" contains the definitions and function prototypes for the "damage.cpp"
+ *	module, which keeps track of which parts of the screen need to be sent to the
+ *	display by "Transfer_Image()".
+ */
+
+#ifndef _DAMAGE_H_
+#define _DAMAGE_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "DAMAGE_RECTS", etc.
+
+
+/*
+ *	A rectangle on the screen. The limits are inclusive and use the same "x" and "y"
+ *	as "BoxFill()" and friends.
+ */
+
+struct damage_rect
+{
+	int16_t		x_min, y_min;
+	int16_t		x_max, y_max;
+};
+
+
+/*
+ *	Function prototypes:
+ */
+
+void	 StartDamage ( void );						// Start painting a new screen
+void	 AddDamage ( int, int, int, int, uint32_t );	// Something was painted here
+void	 EndDamage ( void );						// Finished painting the screen
+void	 DamageAll ( void );						// The whole screen needs to be sent
+int		 TakeDamage ( damage_rect* );				// Get & clear the changed areas
+uint32_t DamageSig ( const char*, uint32_t );		// Signature for a string
+
+#endif
@@ -20,221 +20,76 @@
 #include "graph.h"							// Paint shapes, lines and text
 #include "dial_font.h"						// Fonts
 #include "dial.h"							// Our function prototypes
+#include "damage.h"							// Tracks what changed on the screen
+#include "dial_geom.h"						// Where everything goes on the dial
 
-extern uint8_t**  R_GRAM;					// Red component of pixels
-extern uint8_t**  B_GRAM;					// Blue component of pixels
-extern uint8_t**  G_GRAM;					// Green component of pixels
+extern uint16_t*  GRAM65k;					// The screen image
 
 int		freq_tick = 1000;					// Isn't this in "config.h"?
 long	Dial_font[26][13];					// Array for current font
 float	fontpitch;
 float	xoff_font, yoff_font;
 float	xoff_point;
-int		D_center, D_left, D_right;			// "X" coordinates based on display size
-int		yry[Nx][4];
-int		D_R_inside;
-float	reso_sub;
-float	reso_main;
-
-int		H_sub1, H_sub5, H_sub10;			// Height of sub-ticks
-int		L_sub1, L_sub5, L_sub10;			// Length
-
-int		H_main1, H_main5, H_main10;			// Height of main ticks
-int		L_main1, L_main5, L_main10;			// Length
-
 
 /*
- *	"InitDial()" sets up a number of the variables used to determine where
- *	to place pixels in the map once we actually start drawing the dial face.
+ *	The dial is painted in two steps. First, "dot()" adds up how much of each pixel is
+ *	covered by the ticks and numbers in "dialCover", which has one byte per pixel for
+ *	the top "coverRows" rows of the screen (the ones the dial is in). Then "Dial()"
+ *	turns that into colors in "GRAM65k" in one pass. "dialCover" is stored the same way
+ *	as "GRAM65k"; all the rows for one "x" together.
  */
 
-void InitDial ( void )
-{
-	int		xg;
-	float	xf;
-	float	yf;
-	float	arc_main;
-	float	arc_sub;
-	int		D_R_tmp;
-
-	D_left = 0; D_right = Nx - 1;				// Set left & right limits based on width
-	D_center = ( Nx >> 1 );						// Center is width / 2
-	D_R_inside = D_R - DIAL_SPACE;				// Radius of inside scale
-
-	if ( F_MAIN_OUTSIDE == 1 )					// 0 - Main dial is inside;  1 - Main dial is outside
-	{
-		reso_sub  = (float) TICK_PITCH_SUB  / (float) D_R_inside;
-		reso_main = (float) TICK_PITCH_MAIN / (float )D_R;
-
-		if ( D_R < ( Nx / 2 ))
-			arc_main = 1.6 * (float) D_R;
-		else
-			arc_main = 1.6 * 0.5 * (float) Nx;
-
-		if ( D_R_inside < ( Nx / 2))
-			arc_sub = 1.6 * (float) D_R_inside;
-		else
-			arc_sub = 1.6 * 0.5 * (float) Nx;
-	}
-
-	else										// F_MAIN_OUTSIDE == 0
-	{
-		reso_sub  = (float) TICK_PITCH_SUB  / (float) D_R;
-		reso_main = (float) TICK_PITCH_MAIN / (float) D_R_inside;
-
-		if ( D_R < ( Nx / 2))
-			arc_sub = 1.6 * (float) D_R;
-		else
-			arc_sub = 1.6 * 0.5 * (float) Nx;
-
-		if ( D_R_inside <  (Nx / 2)) 
-			arc_main = 1.6 * (float) D_R_inside;
-		else
-			arc_main = 1.6 * 0.5 * (float) Nx;
-	}											// End of if ( F_MAIN_OUTSIDE == 1 )
-
-	reso_sub  = 0.1 * reso_sub;
-	reso_main = 0.1 * reso_main;
-
-	H_main1 = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN )) *  2.0 );
-	L_main1 = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN )) * -1.0 );
-
-	H_main5 = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN ) / 5.0 ) * 2.00 );
-	L_main5 = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN ) / 5.0 ) * 0.75 );
-
-	L_main5 /= 2;	L_main5++;
-	L_main5 *= 2;	L_main5++;
-	L_main5 *= -1;
+static uint8_t*		dialCover;				// How much of each pixel is covered
+static int			coverRows;				// Number of rows in "dialCover"
+static uint8_t*		dotPlane;				// Where "dot()" paints (normally "dialCover")
+static int			stripLeft  = D_left;	// Columns "dot()" paints in (normally all
+static int			stripRight = D_right;	// of them; see "ScrollScale()")
+static uint16_t		blend[4][256];			// Colors for each area, inside one first
 
-	H_main10 = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN ) / 10.0 ) * 2.00 );
-	L_main10 = (int) (( arc_main / ( 0.1 * (float) TICK_PITCH_MAIN ) / 10.0 ) * 0.75 );
+static void InitBlend ( uint16_t* table, uint32_t color );
 
-	L_main10 /=  2;
-	L_main10++;
-	L_main10 *=  2;
-	L_main10 *= -1;
+#if DIAL_FIXED_POINT
+	static void dotQ ( int32_t x, int32_t y );
+#endif
 
-	H_sub1 = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB )) *  2.0 );
-	L_sub1 = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB )) * -1.0 );
 
-	H_sub5 = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB ) / 5.0) * 2.00 );
-	L_sub5 = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB ) / 5.0) * 0.75 );
-
-	L_sub5 /= 2;	L_sub5++;
-	L_sub5 *= 2;	L_sub5++;
-	L_sub5 *= -1;
-
-	H_sub10 = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB ) / 10.0 ) * 2.00 );
-	L_sub10 = (int) (( arc_sub / ( 0.1 * (float) TICK_PITCH_SUB ) / 10.0 ) * 0.75 );
-
-	L_sub10 /= 2;	L_sub10++;
-	L_sub10 *= 2;
-	L_sub10 *= -1;
+#if DIAL_CACHE
+	static void InitDialCache ( void );
+#endif
 
 
 /*
- *	Calculate the "Region settings (yry). Ah ha! Me thinks when this gets messed up,
- *	it causes the mixed up 4 sections on the display!
+ *	"InitDial()" selects the font and allocates the coverage plane. Where everything
+ *	goes on the dial is worked out by the compiler now (see "dial_geom.h").
  */
 
-	for ( xg = D_left; xg <= D_right; xg++ )
-	{
-		xf = (float) xg;
-		yf = (float) ( D_R * D_R )
-				- (xf - (float) D_center ) * ( xf - (float) D_center );
-
-		if ( yf > 0 )
-		{
-			yry[xg][0] = (int) ( 0.5 + sqrt ( yf ) - (float) D_R + (float) D_HEIGHT );
-
-			if ( yry[xg][0] < 0 )
-				yry[xg][0] = 0;
-		}
-
-		else
-		{
-			yry[xg][0] = 0;
-		}
-	}											// End of "for" loop
-
-
-	if ( F_MAIN_OUTSIDE == 1 )					// If main dial is on the outside
-		D_R_tmp = D_R - TICK_MAIN10;
-
-	else										// Sub dial is on the outside
-		D_R_tmp = D_R - TICK_SUB10;
-
-
-	for ( xg = D_left; xg <= D_right; xg++ )
-	{
-		xf = (float) xg;
-		yf = (float) ( D_R_tmp * D_R_tmp )
-				- (xf - (float) D_center ) * ( xf - (float) D_center );
-
-		if ( yf > 0 )
-		{
-			yry[xg][1] = (int) ( 0.5 + sqrt ( yf ) - (float) D_R + (float) D_HEIGHT );
-
-			if ( yry[xg][1] < 0 )
-				yry[xg][1] = 0;
-		}
+void InitDial ( void )
+{
+	Sel_font12 ();								// '12' is the default
+	if ( DIAL_FONT == 1 )	Sel_font14();		// "DIAL_FONT" is defined
+	if ( DIAL_FONT == 2 )	Sel_font16();		// in 'config.h"
 
-		else
-		{
-			yry[xg][1] = 0;
-		}
-	}											// End of "for" loop
+	coverRows = D_HEIGHT + 1;					// Nothing below that is part of the dial
+	if ( coverRows > Ny )
+		coverRows = Ny;
 
+	dialCover = (uint8_t*) ps_calloc ( Nx * coverRows, sizeof ( uint8_t ));
 
-	for ( xg = D_left; xg <= D_right; xg++ )
+	if ( F_MAIN_OUTSIDE == 1 )					// Main dial outside
 	{
-		xf = (float) xg;
-		yf = (float) (( D_R_inside + 1 ) * ( D_R_inside + 1 ))
-				- ( xf - (float) D_center ) * ( xf - (float) D_center );
-
-		if ( yf > 0 )
-		{
-			yry[xg][2] = (int) ( 0.5 + sqrt ( yf ) - (float) D_R + (float) D_HEIGHT );
-
-			if (yry[xg][2] < 0)
-				yry[xg][2] = 0;
-		}
-
-		else
-		{
-			yry[xg][2] = 0;
-		}
-	}											// End of "for" loop
-
-	if ( F_MAIN_OUTSIDE == 1 )					// Main dial is on the outside
-		D_R_tmp = D_R_inside - TICK_SUB10;
-	else										// Main dial is on the inside
-		D_R_tmp = D_R_inside - TICK_MAIN10;
+		InitBlend ( blend[0], CL_NUM_SUB );		InitBlend ( blend[1], CL_TICK_SUB );
+		InitBlend ( blend[2], CL_NUM_MAIN );	InitBlend ( blend[3], CL_TICK_MAIN );
+	}
 
-	for ( xg = D_left; xg <= D_right; xg++ )
+	else										// Main dial is inside
 	{
-		xf = (float) xg;
-		yf = (float) ( D_R_tmp * D_R_tmp )
-			- (xf - (float) D_center ) * ( xf - (float) D_center );
-
-		if ( yf > 0 )
-		{
-			yry[xg][3] = (int) ( 0.5 + sqrt ( yf ) - (float) D_R + (float) D_HEIGHT );
-
-			if ( yry[xg][3] < 0 )
-				yry[xg][3] = 0;
-		}
-
-		else
-		{
-			yry[xg][3] = 0;
-		}
-	}											// End of "for" loop
-
+		InitBlend ( blend[0], CL_NUM_MAIN );	InitBlend ( blend[1], CL_TICK_MAIN );
+		InitBlend ( blend[2], CL_NUM_SUB );		InitBlend ( blend[3], CL_TICK_SUB );
+	}
 
-	Sel_font12 ();								// '12' is the default
-	if ( DIAL_FONT == 1 )	Sel_font14();		// "DIAL_FONT" is defined
-	if ( DIAL_FONT == 2 )	Sel_font16();		// in 'config.h"
+	#if DIAL_CACHE
+		InitDialCache ();						// Allocate the scale cache
+	#endif
 }												// End of "InitDial()"
 
 
@@ -299,78 +154,206 @@ void Sel_font16 ( void )
 }
 
 
+#define ZERO_rad 128
+
+
 /*
- *	"Dial()" is the primary entry point here. It sets up the pixel map for the
- *	dial in the "GRAM" arrays.
+ *	"TickDot()" rotates one pixel of a tick mark by the angle whose sine and cosine are
+ *	"s" and "c", moves it to where the dial is on the screen and paints it if it's in
+ *	the dial area. "xg" is the distance along the dial and "yr" is the distance from
+ *	the center of rotation. "GlyphDot()" does the same thing for a pixel of one of the
+ *	numbers; "dp" says it's the decimal point, which gets painted twice on a dial with
+ *	skinny ticks so it shows up.
+ *
+ *	The position of a pixel of a number is the whole pixel "n" in the font plus "p",
+ *	the part that's the same for every pixel of that digit. "SubScale()" and
+ *	"MainScale()" work "p" out once per digit with "DIAL_POS()", and "GLYPH_POS()" adds
+ *	the two together for each pixel.
+ *
+ *	With "DIAL_FIXED_POINT" set, the sine and cosine are worked out with "sinf()" and
+ *	"cosf()" (so they're the same single precision numbers the floating point version
+ *	uses) and kept scaled by 2^30, the positions are scaled by 2^16, and "TickDot()" and
+ *	"GlyphDot()" hand "dotQ()" the rotated position scaled by 2^16. 2^30 is needed for
+ *	the sine and cosine, as on a big dial an error in the 16th bit would move the pixels
+ *	at the ends of the ticks by a visible amount. The whole pixel is taken out by
+ *	dividing by 2^16, which truncates the same as "(int)", so the dots hanging off the
+ *	edges of the dial are dropped the same way "dot()" drops them.
  */
 
-#define ZERO_rad 128
-
-void Dial ( long freq )							// "freq" is unsigned in the main program!!!
-{
-	int 	i, k;								// Loop counters
-	int 	xg;
-	int		yg;
-	int		xi;
-	int		yi;
+#if DIAL_FIXED_POINT
 
-	float 	x, y;
-	float	angle;
-	float	a;
-	float	s;
-	float	c;
-	float	xf, yf;
+	typedef	int32_t		dial_trig;				// Scaled by 2^30
+	typedef	int32_t		dial_pos;				// Scaled by 2^16
 
-	float	sin_[ZERO_rad * 2];					// Macros
-	float	cos_[ZERO_rad * 2];
+	#define	DIAL_SIN(a)			((dial_trig) ( sinf ( a ) * 1073741824.0f ))
+	#define	DIAL_COS(a)			((dial_trig) ( cosf ( a ) * 1073741824.0f ))
+	#define	DIAL_POS(v)			((dial_pos) lrint (( v ) * 65536.0 ))
+	#define	GLYPH_POS(n,p)		((dial_pos) ( n ) * 65536 + ( p ))
 
-	float	xr, yr;
-	float	fsign;
+	static inline void TickDot ( dial_trig s, dial_trig c, int xg, int yr )
+	{
+		int32_t	x, y;
+		int		xi, yi;
 
-	int 	d;
-	int		dg;
-	int		dgmax;
+		x = (int32_t) ((( (int64_t) c * xg - (int64_t) s * yr ) + ( 1 << 13 )) >> 14 );
+		y = (int32_t) ((( (int64_t) s * xg + (int64_t) c * yr ) + ( 1 << 13 )) >> 14 );
 
-	float	dgf;
-	long	fdisp;
-	long	fx, fy;
+		x = x + D_center * 65536;
+		y = y + ( D_HEIGHT - D_R ) * 65536;
 
-	int 	D_R_tmp;
+		xi = x / 65536;								// Truncates the same as "(int)"
+		yi = y / 65536;
 
-	if ( F_REV==1 )	freq = -freq;				// See "config.h"
+		if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
+			dotQ ( x, y );
+	}
 
-	if ( freq < 0 )								// Negative frequency?
+	static inline void GlyphDot ( dial_trig s, dial_trig c, dial_pos xr, dial_pos yr, bool dp )
 	{
-		freq = - freq;							// Make positive
-		fsign = -1.0;							// Multiply by -1 somewhere I assume
+		int32_t	x, y;
+		int		xi, yi;
+
+		x = (int32_t) ((( (int64_t) c * xr - (int64_t) s * yr ) + ( 1 << 29 )) >> 30 );
+		y = (int32_t) ((( (int64_t) s * xr + (int64_t) c * yr ) + ( 1 << 29 )) >> 30 );
+
+		x = x + D_center * 65536;
+		y = y + ( D_HEIGHT - D_R ) * 65536;
+
+		xi = x / 65536;
+		yi = y / 65536;
+
+		if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
+		{
+			dotQ ( x, y );
+
+			if ( dp && TICK_WIDTH == 1 )
+				dotQ ( x, y + 19661 );				// 0.3 pixels
+		}
 	}
 
-	else										// Frequency was positive
+#else
+
+	typedef	float		dial_trig;
+	typedef	double		dial_pos;
+
+	#define	DIAL_SIN(a)			sin ( a )
+	#define	DIAL_COS(a)			cos ( a )
+	#define	DIAL_POS(v)			( v )
+	#define	GLYPH_POS(n,p)		((float) ((double) ( n ) + ( p )))
+
+	static inline void TickDot ( float s, float c, int xg, int yr )
 	{
-		fsign = 1.0;							// Multiply by +1 somewhere I assume
-	}
+		float	x, y;
+		int		xi, yi;
 
+		x = c * (float) xg - s * (float) yr;
+		y = s * (float) xg + c * (float) yr;
 
-	for ( xg = D_left; xg <= D_right; xg++ )
+		x = x + (float) D_center;
+		y = y - (float) D_R + (float) D_HEIGHT;
+
+		xi = (int) x;
+		yi = (int) y;
+
+		if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
+			dot ( x, y );
+	}
+
+	static inline void GlyphDot ( float s, float c, float xr, float yr, bool dp )
 	{
-		yg = yry[xg][0];
+		float	xf, yf;
+		int		xi, yi;
+
+		xf = c * (xr) - s * (yr);
+		yf = s * (xr) + c * (yr);
+
+		xf = xf + (float) D_center;
+		yf = yf - (float) D_R + (float) D_HEIGHT;
+
+		xi = (int) xf;
+		yi = (int) yf;
 
-		for ( i = 0; i <= yg; i++ )
+		if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
 		{
-			R_GRAM[xg][i] = 0;					// Make pixel black
-			G_GRAM[xg][i] = 0;
-			B_GRAM[xg][i] = 0;
+			dot ( xf, yf );
+
+			if ( dp && TICK_WIDTH == 1 )
+				dot ( xf, yf + 0.3 );
 		}
-	}											// End of "xg" loop
+	}
+
+#endif
 
 
 /*
- *	Figure out the sub-dial:
+ *	"EdgeColumn()" says whether column "x" is one of the two at the left edge of the
+ *	screen or the one at the right edge, which always get painted again when a scale is
+ *	slid (see "ScrollScale()"). "StripColumn()" says whether "dot()" may paint column
+ *	"x"; that's the columns between "stripLeft" and "stripRight" plus those.
+ *
+ *	"InStrip()" says whether the tick at angle "a" (or its number) could paint anything
+ *	in those columns. They only leave out part of the dial when "ScrollScale()" is
+ *	painting a strip of a straight dial, where a tick is about "D_R * a" pixels to the
+ *	left of the center; "STRIP_MARGIN" allows for the width of the numbers.
  */
 
-	angle = -(float) ( freq % ( freq_tick * 10 ) ) * reso_sub / (float) freq_tick;
-	angle *= fsign;
+#define	STRIP_MARGIN	40
+
+static inline bool EdgeColumn ( int x )
+{
+	return ( x <= D_left + 1 ) || ( x >= D_right );
+}
+
+static inline bool StripColumn ( int x )
+{
+	return ( x >= stripLeft && x <= stripRight ) || EdgeColumn ( x );
+}
+
+static inline bool InStrip ( float a )
+{
+	float	x;
+
+	if ( stripLeft == D_left && stripRight == D_right )
+		return true;
+
+	x = (float) D_center - (float) D_R * a;
+
+	return ( x >= stripLeft - STRIP_MARGIN && x <= stripRight + STRIP_MARGIN )
+		|| x <= D_left + 1 + STRIP_MARGIN || x >= D_right - STRIP_MARGIN;
+}
+
+
+/*
+ *	"SubScale()" paints the sub-dial ticks and numbers and "MainScale()" does all the
+ *	same stuff for the main dial. They used to be part of "Dial()". "angle" is how far
+ *	the scale is rotated and "freq" (which is always positive by now) is only used to
+ *	figure out the numbers. Everything goes into "dotPlane" via "dot()".
+ */
+
+static void SubScale ( long freq, float fsign, float angle )
+{
+	int 	i, k;								// Loop counters
+	int 	xg;
+	int		yg;
+
+	float	a;
+	dial_trig	s;
+	dial_trig	c;
+
+	dial_trig	sin_[ZERO_rad * 2];					// Macros
+	dial_trig	cos_[ZERO_rad * 2];
+	bool		show_[ZERO_rad * 2];				// Ticks that can reach the strip
 
+	dial_pos	xoff, yoff;					// See "GLYPH_POS()"
+
+	int 	d;
+	int		dg;
+	int		dgmax;
+
+	long	fdisp;
+	long	fx, fy;
+
+	int 	D_R_tmp;
 
 /*
  *	Rotation matrix?
@@ -379,7 +362,12 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 	for ( i = -ZERO_rad + 1; i <= ZERO_rad - 1; i++ )
 	{
 		a = angle + i * reso_sub;
-		sin_[i + ZERO_rad] = sin ( a ); cos_[i + ZERO_rad] = cos ( a );
+		show_[i + ZERO_rad] = InStrip ( a );
+
+		if ( show_[i + ZERO_rad] )
+		{
+			sin_[i + ZERO_rad] = DIAL_SIN ( a ); cos_[i + ZERO_rad] = DIAL_COS ( a );
+		}
 	}
 
 
@@ -388,12 +376,17 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 	else										// Main dial is on the inside
 		D_R_tmp = D_R;
 
+	yoff = DIAL_POS ( yoff_font );
+
 	if ( F_SUBTICK10 == 1 )						// If sub-tick-1 turned on
 	{
 		for ( i = L_sub10; i <= H_sub10; i++ )	// Every 10 points
 		{
 			k = ( fsign * i * 10 ) + ZERO_rad;
 
+			if ( !show_[k] )
+				continue;
+
 			s = sin_[k];
 			c = cos_[k];
 
@@ -401,17 +394,7 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 			{
 				for ( yg = 1 + ( D_R - D_R_tmp ); yg < TICK_SUB10 + (D_R - D_R_tmp); yg++ ) 
 				{
-					x = c * (float) xg - s * ((float) D_R - (float) yg );
-					y = s * (float) xg + c * ((float) D_R - (float) yg );
-
-					x = x + (float) D_center;
-					y = y - (float) D_R + (float) D_HEIGHT;
-
-					xi = (int) x;
-					yi = (int) y;
-
-					if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-						dot ( x, y );
+					TickDot ( s, c, xg, D_R - yg );
 				}
 			}									// End of "xg" loop
 		}										// End of "i" loop
@@ -423,6 +406,9 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 		{
 			k = ( fsign * i * 5 ) + ZERO_rad;
 
+			if ( !show_[k] )
+				continue;
+
 			s = sin_[k];
 			c = cos_[k];
 
@@ -430,17 +416,7 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 			{
 				for ( yg = 1 + ( D_R - D_R_tmp ); yg < TICK_SUB5 + ( D_R - D_R_tmp ); yg++ )
 				{
-					x = c * (float) xg - s * ((float) D_R - (float) yg );
-					y = s * (float) xg + c * ((float) D_R - (float) yg );
-
-					x = x + (float) D_center;
-					y = y - (float) D_R + (float) D_HEIGHT;
-
-					xi = (int) x;
-					yi = (int) y;
-
-					if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-						dot ( x, y );
+					TickDot ( s, c, xg, D_R - yg );
 				}								// End of "yg" loop
 			}									// End of "xg" loop
 		}										// End of "i" loop
@@ -455,6 +431,9 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 			{
 				k = ( fsign * i ) + ZERO_rad;
 
+				if ( !show_[k] )
+					continue;
+
 				s = sin_[k];
 				c = cos_[k];
 
@@ -462,17 +441,7 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 				{
 					for ( yg = 1 + ( D_R - D_R_tmp ); yg < TICK_SUB1 + ( D_R - D_R_tmp ); yg++ )
 					{
-						x = c * (float) xg - s * ((float) D_R - (float) yg );
-						y = s * (float) xg + c * ((float) D_R - (float) yg );
-
-						x = x + (float) D_center;
-						y = y - (float) D_R + (float ) D_HEIGHT;
-
-						xi = (int) x;
-						yi = (int) y;
-
-              			if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-              				dot ( x, y );
+						TickDot ( s, c, xg, D_R - yg );
 					}								// End of "yg" loop
 				}									// End of "xg" loop
 			}
@@ -493,6 +462,9 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 
 				k = ( fsign * i * 10 ) + ZERO_rad;
 
+				if ( !show_[k] )
+					continue;
+
 				s = sin_[k];
 				c = cos_[k];
 
@@ -505,6 +477,15 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 				{
 					d = fdisp % 10;
 
+					if ( dgmax == 1 )
+						xoff = DIAL_POS ( -6.0 + xoff_font );		// (13-1)/2 = 6
+
+					if ( dgmax == 2 )
+						xoff = DIAL_POS ( -6.0 + xoff_font - ((float) ( dg ) - 0.5 ) * fontpitch );
+
+					if ( dgmax == 3 )
+						xoff = DIAL_POS ( -6.0 + xoff_font - ((float)( dg ) - 1.0 ) * fontpitch );
+
 					for ( xg = 0; xg < 9; xg++ )
 					{
 						fx = Dial_font[d + 0x10][xg];
@@ -515,29 +496,8 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 
 							if (( fx & fy ) == fy )
 							{
-								if ( dgmax == 1 )
-									xr = (float) xg - 6.0 + xoff_font;		// (13-1)/2 = 6
-
-								if ( dgmax == 2 )
-									xr = (float) xg - 6.0 + xoff_font - ((float) ( dg ) - 0.5 ) * fontpitch;
-
-								if ( dgmax == 3 )
-									xr = (float) xg - 6.0 + xoff_font - ((float)( dg ) - 1.0 ) * fontpitch;
-
-                  				yr = (float) ( D_R_tmp - ( yg + TNCL_SUB ) ) + yoff_font;
-
-								xf = c * (xr) - s * (yr);
-								yf = s * (xr) + c * (yr);
-
-								xf = xf + (float) D_center;
-								yf = yf - (float) D_R + (float) D_HEIGHT;
-
-								xi = (int) xf;
-								yi = (int) yf;
-									
-								if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-									dot ( xf, yf );
-
+								GlyphDot ( s, c, GLYPH_POS ( xg, xoff ),
+										   GLYPH_POS ( D_R_tmp - ( yg + TNCL_SUB ), yoff ), false );
 							}						// End of "if (( fx & fy ) == fy )"
 						}							// End of "yg" loop
 					}								// End of "xg" loop
@@ -547,20 +507,41 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 			}
 		}											// End of "i" loop
 	}
+}
 
 
-/*
- *	Now we do all the same stuff for the main dial:
- */
+static void MainScale ( long freq, float fsign, float angle )
+{
+	int 	i, k;								// Loop counters
+	int 	xg;
+	int		yg;
+
+	float	a;
+	dial_trig	s;
+	dial_trig	c;
+
+	dial_trig	sin_[ZERO_rad * 2];					// Macros
+	dial_trig	cos_[ZERO_rad * 2];
+	bool		show_[ZERO_rad * 2];				// Ticks that can reach the strip
+
+	dial_pos	xoff, yoff;					// See "GLYPH_POS()"
+
+	int 	d;
+	int		dg;
+	int		dgmax;
+
+	float	dgf;
+	long	fdisp;
+	long	fx, fy;
+
+	int 	D_R_tmp;
 
 	if ( F_MAIN_OUTSIDE == 1 )						// If the main dial is on the outside
 		D_R_tmp = D_R;								// Use outside radius
 	else											// If the main dial is on the inside
 		D_R_tmp = D_R_inside;						// Use the indise radius
 
-	angle = -(float) ( freq %  (FREQ_TICK_MAIN * 10 )) * reso_main / (float) FREQ_TICK_MAIN;
-	angle *= fsign;
-
+	yoff = DIAL_POS ( yoff_font );
 
 /*
  *	Rotation matrix?
@@ -569,7 +550,12 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 	for ( i = -ZERO_rad + 1; i <= ZERO_rad - 1; i++ ) 
 	{
 		a = angle + i * reso_main;
-		sin_[i + ZERO_rad] = sin (a); cos_[i + ZERO_rad] = cos (a);
+		show_[i + ZERO_rad] = InStrip ( a );
+
+		if ( show_[i + ZERO_rad] )
+		{
+			sin_[i + ZERO_rad] = DIAL_SIN ( a ); cos_[i + ZERO_rad] = DIAL_COS ( a );
+		}
 	}
 
 	if ( F_MAINTICK10 == 1 )						// If main tick-10 enabled
@@ -578,6 +564,9 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 		{
 			k = ( fsign * i * 10 ) + ZERO_rad;
 
+			if ( !show_[k] )
+				continue;
+
 			s = sin_[k];
 			c = cos_[k];
 
@@ -585,17 +574,7 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 			{
 				for ( yg = 1 + ( D_R - D_R_tmp ); yg < TICK_MAIN10 + ( D_R - D_R_tmp ); yg++ )
 				{
-					x = c * (float) xg - s * ((float) D_R - (float) yg );
-					y = s * (float) xg + c * ((float) D_R - (float) yg );
-
-					x = x + (float) D_center;
-					y = y - (float) D_R + (float) D_HEIGHT;
-
-					xi = (int) x;
-					yi = (int) y;
-
-					if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-						dot ( x, y );
+					TickDot ( s, c, xg, D_R - yg );
 				}									// End of "yg" loop
 			}										// End of "xg" loop
 		}											// End of "i" loop
@@ -608,6 +587,9 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 		{
 			k = ( fsign * i * 5 ) + ZERO_rad;
 
+			if ( !show_[k] )
+				continue;
+
 			s = sin_[k];
 			c = cos_[k];
 
@@ -615,17 +597,7 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 			{
 				for ( yg = 1 + ( D_R - D_R_tmp ); yg < TICK_MAIN5 + ( D_R - D_R_tmp ); yg++ )
 				{
-					x = c * (float) xg - s * ((float) D_R - (float) yg );
-					y = s * (float) xg + c * ((float) D_R - (float) yg );
-
-					x = x + (float) D_center;
-					y = y - (float) D_R + (float) D_HEIGHT;
-
-					xi = (int) x; 
-					yi = (int) y;
-
-					if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-						dot ( x, y );
+					TickDot ( s, c, xg, D_R - yg );
 				}									// End of "yg" loop
 			}										// End of "xg" loop
 		}											// End of "i" loop
@@ -640,6 +612,9 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 			{
 				k = ( fsign * i ) + ZERO_rad;
 
+				if ( !show_[k] )
+					continue;
+
 				s = sin_[k];
 				c = cos_[k];
 
@@ -647,16 +622,7 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 				{
 					for ( yg = 1 +  (D_R - D_R_tmp ); yg < TICK_MAIN1 + ( D_R - D_R_tmp ); yg++)
 					{
-						x = c * (float) xg - s * ((float) D_R - (float) yg );
-						y = s * (float) xg + c * ((float) D_R - (float) yg );
-
-						x = x + (float) D_center;
-						y = y - (float) D_R + (float) D_HEIGHT;
-
-						xi = (int) x; yi = (int) y;
-
-						if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-							dot ( x, y );
+						TickDot ( s, c, xg, D_R - yg );
 					}								// End of "yg" loop
 				}									// End of "xg" loop
 			}
@@ -680,6 +646,9 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 
 				k = ( fsign * i * 10 ) + ZERO_rad;
 
+				if ( !show_[k] )
+					continue;
+
 				s = sin_[k];
 				c = cos_[k];
 
@@ -701,6 +670,23 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 				{
 					d = fdisp % 10;
 
+					dgf = (float) dg;
+
+					if ( dg == 0 && FREQ_TICK_MAIN == 10000 )
+						dgf = (float) dg - 0.6;
+
+					if ( dgmax == 1 )
+						xoff = DIAL_POS ( -6.0 + xoff_font );		// (13-1)/2 = 6
+
+					if ( dgmax == 2 )
+						xoff = DIAL_POS ( -6.0 + xoff_font - ( dgf - 0.5 ) * fontpitch );
+
+					if ( dgmax == 3 )
+						xoff = DIAL_POS ( -6.0 + xoff_font - ( dgf - 1.0 ) * fontpitch );
+
+					if  ( dgmax == 4 )
+						xoff = DIAL_POS ( -6.0 + xoff_font - ( dgf - 1.5 ) * fontpitch );
+
 //					for ( xg = 0; xg < 13; xg++ )			// Scanning 13bit?
 					for ( xg = 0; xg < 9; xg++ )
 					{
@@ -713,36 +699,8 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 
 							if (( fx & fy ) == fy )
 							{
-								dgf = (float) dg;
-
-								if ( dg == 0 && FREQ_TICK_MAIN == 10000 )
-									dgf = (float) dg - 0.6;
-
-								if ( dgmax == 1 )
-									xr = (float) xg - 6.0 + xoff_font;		// (13-1)/2 = 6
-
-								if ( dgmax == 2 )
-									xr = (float) xg - 6.0 + xoff_font - ( dgf - 0.5 ) * fontpitch;
-
-								if ( dgmax == 3 )
-									xr = (float) xg - 6.0 + xoff_font - ( dgf - 1.0 ) * fontpitch;
-
-								if  ( dgmax == 4 )
-									xr = (float) xg - 6.0 + xoff_font - ( dgf - 1.5 ) * fontpitch;
-
-								yr = (float) ( D_R_tmp - ( yg + TNCL_MAIN )) + yoff_font;
-
-								xf = c * (xr) - s * (yr);
-								yf = s * (xr) + c * (yr);
-
-								xf = xf + (float) D_center;
-								yf = yf - (float) D_R + (float) D_HEIGHT;
-
-								xi = (int) xf;
-								yi = (int) yf;
-
-								if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-									dot ( xf, yf );
+								GlyphDot ( s, c, GLYPH_POS ( xg, xoff ),
+										   GLYPH_POS ( D_R_tmp - ( yg + TNCL_MAIN ), yoff ), false );
 							}							// End of "if (( fx & fy ) == fy )"
 						}								// End of "yg" loop
 					}									// End of "xg" loop
@@ -756,6 +714,18 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 					{
 						if ( FREQ_TICK_MAIN == 10000 )
 						{
+							if ( dgmax == 1 )
+								xoff = DIAL_POS ( 0.29 * fontpitch + xoff_point );
+
+							if ( dgmax == 2 )
+								xoff = DIAL_POS ( 0.69 * fontpitch + xoff_point );
+
+							if ( dgmax == 3 )
+								xoff = DIAL_POS ( 1.29 * fontpitch + xoff_point );
+
+							if  (dgmax == 4 )
+								xoff = DIAL_POS ( 1.69 * fontpitch + xoff_point );
+
 							for ( xg = -5; xg <= -4; xg++ )
 							{
 								for ( yg = 21; yg <= 22; yg++ )
@@ -770,36 +740,8 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 
                     				else			// Always true!
 									{
-										if ( dgmax == 1 )
-											xr = (float) xg + 0.29 * fontpitch + xoff_point;
-
-										if ( dgmax == 2 )
-											xr = (float) xg + 0.69 * fontpitch + xoff_point;
-
-										if ( dgmax == 3 )
-											xr = (float) xg + 1.29 * fontpitch + xoff_point;
-
-										if  (dgmax == 4 )
-											xr = (float) xg + 1.69 * fontpitch + xoff_point;
-
-										yr = (float) ( D_R_tmp - ( yg + TNCL_MAIN )) + yoff_font;
-
-										xf = c * (xr) - s * (yr);
-										yf = s * (xr) + c * (yr);
-
-										xf = xf + (float) D_center;
-										yf = yf - (float) D_R + (float) D_HEIGHT;
-
-										xi = (int) xf;
-										yi = (int) yf;
-
-										if ( xi >= D_left && xi <= D_right && yi >= 0 && yi <= D_HEIGHT )
-										{
-											dot ( xf, yf );
-
-											if ( TICK_WIDTH == 1 )
-												dot ( xf, yf + 0.3 );
-										}
+										GlyphDot ( s, c, GLYPH_POS ( xg, xoff ),	// Decimal point gets painted twice
+												   GLYPH_POS ( D_R_tmp - ( yg + TNCL_MAIN ), yoff ), true );
 									}					// End of goofy "if"/else"
 								}						// End of "yg" loop
 							}							// End of "xg" loop
@@ -811,200 +753,479 @@ void Dial ( long freq )							// "freq" is unsigned in the main program!!!
 			}											// End of "if (fdisp >= 0)"
 		}												// End of "i" loop				
 	}													// End of MAINNUM handling
+}
+
 
+#if DIAL_CACHE
 
 /*
- *	Now the coloring:
+ *	The dial cache (see "DIAL_CACHE" in "config.h"). What "SubScale()" or "MainScale()"
+ *	paints depends only on how far the scale is rotated and on which numbers are printed
+ *	on it, so once a scale has been painted, we keep a list of the pixels it touched and
+ *	how much it added to each of them. The next time the scale is in the same place with
+ *	the same numbers, we just add the list back into "dialCover"; no "sin()", "cos()" or
+ *	"dot()" needed.
+ *
+ *	"dot()" limits each pixel to 0xFF as it adds to it, and since the amounts it adds
+ *	are never negative, it doesn't matter what order things get added in. That's why
+ *	adding the saved list gives exactly the same result as painting the scale again.
+ *
+ *	The rotation is rounded to "bucketSize", which is 1/DIAL_CACHE_SUBPIX of a pixel
+ *	at the outer edge of the dial. The numbers only depend on "freq / period" where
+ *	"period" is the frequency range of one numbered tick to the next.
  */
 
-unsigned int	cR,  cG,  cB;						// Red, green and
-unsigned int	dcR, dcG, dcB;						// blue stuff
-int 			ccR, ccG, ccB;
-float 			kido;
+typedef struct
+{
+	bool		valid;						// Entry contains a painted scale
+	long		bucket;						// Rotation in units of "bucketSize"
+	long		base;						// "freq / period" (determines the numbers)
+	uint32_t	lastUse;					// For replacing the least recently used one
+	uint16_t	count;						// Number of entries in "points"
+	uint32_t*	points;						// ( offset << 8 ) | amount
+} dial_cache;
 
-	dcR = ( CL_DIAL_BG >> 16 ) & 0xFF;				// Split dial background
-	dcG = ( CL_DIAL_BG >>  8 ) & 0xFF;				// into RGB components
-	dcB = ( CL_DIAL_BG) & 0xFF;
+static dial_cache	subCache[DIAL_CACHE_SLOTS];		// Sub-dial positions
+static dial_cache	mainCache[DIAL_CACHE_SLOTS];	// Main dial positions
+
+static uint8_t*		dialScratch;			// Scales get painted in here first
+static dial_cache*	dotList = NULL;			// Where "dot()" lists new scratch pixels
+static float		bucketSize;				// Rotation resolution (radians)
+static uint32_t		cacheClock = 0;			// Incremented for each lookup
+
+uint32_t	dialCacheHits   = 0;			// Statistics for the host benchmark
+uint32_t	dialCacheMisses = 0;
+uint32_t	dialScrolls     = 0;
+
+
+/*
+ *	"InitDialCache()" allocates the cache and the scratch plane from the PSRAM.
+ */
 
-	if ( F_MAIN_OUTSIDE == 1 )						// Main dial outside
+static void InitDialCache ( void )
+{
+	int		ix;
+
+	bucketSize = 1.0 / ((float) D_R * (float) DIAL_CACHE_SUBPIX );
+
+	dialScratch = (uint8_t*) ps_calloc ( Nx * coverRows, sizeof ( uint8_t ));
+
+	for ( ix = 0; ix < DIAL_CACHE_SLOTS; ix++ )
 	{
-		cR = ( CL_TICK_MAIN >> 16 ) & 0xFF;			// Split main dial tick
-		cG = ( CL_TICK_MAIN >>  8 ) & 0xFF;			// color into RGB
-		cB = CL_TICK_MAIN & 0xFF;					// Components
+		subCache[ix].valid   = false;
+		subCache[ix].points  = (uint32_t*) ps_malloc ( DIAL_CACHE_POINTS * sizeof ( uint32_t ));
+
+		mainCache[ix].valid  = false;
+		mainCache[ix].points = (uint32_t*) ps_malloc ( DIAL_CACHE_POINTS * sizeof ( uint32_t ));
 	}
+}
+
+
+#if DIAL_SCROLL
+
+/*
+ *	"ScrollScale()" is what "CachedScale()" tries when none of the cache entries are in
+ *	exactly the right place (see "DIAL_SCROLL" in "config.h"). A tick "x" pixels from
+ *	the center of the dial moves down by about x * shift / D_R pixels when the dial
+ *	turns "shift" pixels, so on a straight dial an entry can be slid sideways by up to
+ *	"SCROLL_MAX" pixels before the ticks at the edges are half a "bucketSize" out. On
+ *	the curved dials "SCROLL_MAX" is zero.
+ *
+ *	The entry has to be a whole number of pixels away, give or take half a bucket (so
+ *	the result is never more than a bucket from the right place), and
+ *	the closest one is used. Its pixels are added to "dialCover" moved over, then the
+ *	scale is painted again with "dot()" only allowed to paint the columns that slid onto
+ *	the screen. "paint" gets the angle the entry was painted at plus the whole pixels,
+ *	so the strip lines up with the rest.
+ *
+ *	"dot()" throws away a dot that hangs off either side of the screen, and one just
+ *	left of the screen lands on the first two columns, so those columns and the last
+ *	one aren't what a full paint would give once they're slid. The pixels that were in
+ *	them aren't slid, and the strip is one column wider on the inside to cover where
+ *	they went. The edge columns themselves are always painted again.
+ *
+ *	The numbers don't need any special handling; they move with their ticks.
+ */
+
+#define	SCROLL_MAX	( D_R / ( Nx * DIAL_CACHE_SUBPIX ))
 
-	else											// Main dial is inside
+static bool ScrollScale ( dial_cache* cache, void ( *paint )( long, float, float ),
+							long freq, float fsign, long period, float resoHz )
+{
+	int			ix;
+	int			off;
+	int			cols;							// Columns to move the entry right
+	long		shift = 0;						// Pixels the scale has turned
+	long		px;
+	double		where;							// Scale position in buckets
+	double		moved;
+	double		perBucket;						// Buckets from one period to the next
+	uint32_t	dat;
+	uint32_t	pt;
+	dial_cache*	entry = NULL;
+
+	if ( SCROLL_MAX < 1 )
+		return false;
+
+	perBucket = (double) period * resoHz / bucketSize;
+	where     = (double) freq * resoHz / bucketSize;
+
+	for ( ix = 0; ix < DIAL_CACHE_SLOTS; ix++ )
 	{
-		cR = ( CL_TICK_SUB >> 16 ) & 0xFF;			// Split sub dial tick
-		cG = ( CL_TICK_SUB >>  8 ) & 0xFF;			// color into RGB
-		cB = CL_TICK_SUB & 0xFF;					// Components
+		if ( !cache[ix].valid )
+			continue;
+
+		moved = where - ( cache[ix].base * perBucket + cache[ix].bucket );
+		px    = lround ( moved / DIAL_CACHE_SUBPIX );
+
+		if ( px == 0 || labs ( px ) > SCROLL_MAX || fabs ( moved - px * DIAL_CACHE_SUBPIX ) > 0.5 )
+			continue;
+
+		if ( !entry || labs ( px ) < labs ( shift ))
+		{
+			entry = &cache[ix];
+			shift = px;
+		}
 	}
-  
-	for ( xg = D_left; xg <= D_right; xg++ )
+
+	if ( !entry )
+		return false;
+
+	dialScrolls++;
+	entry->lastUse = cacheClock;
+
+
+/*
+ *	Slide the saved pixels over. "dialCover" has all the rows for one column together,
+ *	so moving a pixel "cols" columns is just adding "cols * coverRows" to its offset.
+ */
+
+	cols = shift * (long) fsign;
+
+	for ( ix = 0; ix < entry->count; ix++ )
 	{
-		for ( i = yry[xg][1]; i <= yry[xg][0]; i++ )
-		{
-			if ( R_GRAM[xg][i] != 0 )
-			{
-				kido = (float) R_GRAM[xg][i] / (float) 255.0;
-				ccR  = (int) ( kido * (float) cR + ( 1.0 - kido ) * (float) dcR + 0.5 );
-				ccG  = (int) ( kido * (float )cG + ( 1.0 - kido ) * (float) dcG + 0.5 );
-				ccB  = (int) ( kido * (float) cB + ( 1.0 - kido ) * (float) dcB + 1.0 );
-
-				if ( ccR > 0xFF ) ccR = 0xFF;
-				if ( ccG > 0xFF ) ccG = 0xFF;
-				if ( ccB > 0xFF ) ccB = 0xFF;
-
-				R_GRAM[xg][i] = (unsigned char) ccR;
-				G_GRAM[xg][i] = (unsigned char) ccG;
-				B_GRAM[xg][i] = (unsigned char) ccB;
-			}
-		}										// End of "i" loop
-	}											// End of "xg" loop
+		pt  = entry->points[ix];
+		off = ( pt >> 8 ) + cols * coverRows;
+
+		if ( off < 0 || off >= Nx * coverRows )
+			continue;
+
+		if ( EdgeColumn ( (int) ( pt >> 8 ) / coverRows ) || EdgeColumn ( off / coverRows ))
+			continue;
+
+		dat = dialCover[off] + ( pt & 0xFF );
+		dialCover[off] = ( dat > 0xFF ) ? 0xFF : dat;
+	}
 
 
 /*
- *	Do the outside scale numbers:
+ *	And paint the strip that slid on:
  */
 
-	if ( F_MAIN_OUTSIDE == 1 )						// If main dial on the outside
+	if ( cols > 0 )
 	{
-		cR = ( CL_NUM_MAIN >> 16 ) & 0xFF;
-		cG = ( CL_NUM_MAIN >>  8 ) & 0xFF;
-		cB = CL_NUM_MAIN & 0xFF;
+		stripLeft  = D_left;
+		stripRight = D_left + cols + 1;
 	}
 
-	else											// Main dial is inside
+	else
 	{
-		cR = ( CL_NUM_SUB >> 16 ) & 0xFF;
-		cG = ( CL_NUM_SUB >>  8 ) & 0xFF;
-		cB = CL_NUM_SUB & 0xFF;
+		stripLeft  = D_right + cols;
+		stripRight = D_right;
 	}
 
-	for ( xg = D_left; xg <= D_right; xg++ )
+	moved = entry->base * perBucket + entry->bucket + shift * DIAL_CACHE_SUBPIX
+				- ( freq / period ) * perBucket;
+
+	paint ( freq, fsign, -(float) ( moved * bucketSize ) * fsign );
+
+	stripLeft  = D_left;
+	stripRight = D_right;
+
+	return true;
+}
+
+#endif
+
+
+/*
+ *	"CachedScale()" puts one of the scales into "dialCover" using the cache. "paint" is
+ *	"SubScale()" or "MainScale()", "period" is the frequency range between numbered
+ *	ticks and "resoHz" is how many radians the scale turns for each Hz.
+ */
+
+static void CachedScale ( dial_cache* cache, void ( *paint )( long, float, float ),
+							long freq, float fsign, long period, float resoHz )
+{
+	int			ix;
+	int			off;
+	long		bucket;
+	long		base;
+	uint32_t	dat;
+	uint32_t	pt;
+	dial_cache*	entry  = NULL;					// Matching entry (if any)
+	dial_cache*	oldest = &cache[0];				// Least recently used entry
+
+	bucket = (long) ((float) ( freq % period ) * resoHz / bucketSize + 0.5 );
+	base   = freq / period;
+
+	cacheClock++;
+
+	for ( ix = 0; ix < DIAL_CACHE_SLOTS; ix++ )
 	{
-		for ( i = yry[xg][2]; i < yry[xg][1]; i++ )
+		if ( cache[ix].valid && cache[ix].bucket == bucket && cache[ix].base == base )
 		{
-			if ( R_GRAM[xg][i] != 0 )
-			{
-				kido = (float) R_GRAM[xg][i] / (float) 255.0;
-				ccR  = (int) ( kido * (float) cR + ( 1.0 - kido ) * (float) dcR + 0.5 );
-				ccG  = (int) ( kido * (float) cG + ( 1.0 - kido ) * (float) dcG + 0.5 );
-				ccB  = (int) ( kido * (float) cB + ( 1.0 - kido ) * (float) dcB + 1.0 );
-
-				if ( ccR > 0xFF ) ccR = 0xFF;
-				if ( ccG > 0xFF ) ccG = 0xFF;
-				if ( ccB > 0xFF ) ccB = 0xFF;
-
-				R_GRAM[xg][i] = (unsigned char) ccR;
-				G_GRAM[xg][i] = (unsigned char) ccG;
-				B_GRAM[xg][i] = (unsigned char) ccB;
-			}
-		}											// End of "i" loop
-	}												// End of "xg" loop
+			entry = &cache[ix];
+			break;
+		}
+
+		if ( !cache[ix].valid )
+			oldest = &cache[ix];
+
+		else if ( oldest->valid && cache[ix].lastUse < oldest->lastUse )
+			oldest = &cache[ix];
+	}
 
 
 /*
- *	Ticks on the inside scale:
+ *	If we have it, add the saved pixels to "dialCover" and we're done:
  */
 
-	if ( F_MAIN_OUTSIDE == 1 )						// If the main dial is outside
+	if ( entry )
 	{
-		cR = ( CL_TICK_SUB >> 16 ) & 0xFF;
-		cG = ( CL_TICK_SUB >>  8 ) & 0xFF;
-		cB = CL_TICK_SUB & 0xFF;
+		dialCacheHits++;
+		entry->lastUse = cacheClock;
+
+		for ( ix = 0; ix < entry->count; ix++ )
+		{
+			pt  = entry->points[ix];
+			off = pt >> 8;
+			dat = dialCover[off] + ( pt & 0xFF );
+
+			dialCover[off] = ( dat > 0xFF ) ? 0xFF : dat;
+		}
+
+		return;
 	}
 
-	else											// Main dial is inside
+	#if DIAL_SCROLL
+
+		if ( ScrollScale ( cache, paint, freq, fsign, period, resoHz ))
+			return;
+
+	#endif
+
+
+/*
+ *	If not, paint the scale into the scratch plane with "dot()" adding the location of
+ *	each pixel it touches for the first time to the oldest cache entry. Then we add
+ *	what was painted to "dialCover", fill in the amounts in the cache entry and clear the
+ *	scratch plane for next time.
+ *
+ *	If there are more pixels than will fit in an entry, the entry is not used, and we
+ *	have to look at the whole scratch plane to find them all.
+ */
+
+	dialCacheMisses++;
+
+	dotList  = oldest;
+	dotPlane = dialScratch;
+	oldest->count = 0;
+
+	paint ( freq, fsign, -(float) bucket * bucketSize * fsign );
+
+	dotPlane = dialCover;
+	dotList  = NULL;
+
+	oldest->bucket  = bucket;
+	oldest->base    = base;
+	oldest->lastUse = cacheClock;
+	oldest->valid   = ( oldest->count < DIAL_CACHE_POINTS );
+
+	if ( oldest->valid )
 	{
-		cR = ( CL_TICK_MAIN >> 16 ) & 0xFF;
-		cG = ( CL_TICK_MAIN >>  8 ) & 0xFF;
-		cB = CL_TICK_MAIN & 0xFF;
+		for ( ix = 0; ix < oldest->count; ix++ )
+		{
+			pt  = oldest->points[ix];
+			off = pt >> 8;
+			dat = dialCover[off] + dialScratch[off];
+
+			dialCover[off] = ( dat > 0xFF ) ? 0xFF : dat;
+			oldest->points[ix] = pt | dialScratch[off];
+			dialScratch[off] = 0;
+		}
 	}
 
-	for ( xg = D_left; xg <= D_right; xg++ )
+	else											// Too big to cache
 	{
-		for  (i = yry[xg][3]; i < yry[xg][2]; i++ )
+		for ( off = 0; off < Nx * coverRows; off++ )
 		{
-			if ( R_GRAM[xg][i] != 0 )
+			if ( dialScratch[off] )
 			{
-				kido = (float) R_GRAM[xg][i] / (float) 255.0;
-				ccR  = (int) ( kido * (float) cR + ( 1.0 - kido ) * (float) dcR + 0.5 );
-				ccG  = (int) ( kido * (float) cG + ( 1.0 - kido ) * (float) dcG + 0.5 );
-				ccB  = (int) ( kido * (float) cB + ( 1.0 - kido ) * (float) dcB + 1.0 );
-
-				if ( ccR > 0xFF ) ccR = 0xFF;
-				if ( ccG > 0xFF ) ccG = 0xFF;
-				if ( ccB > 0xFF ) ccB = 0xFF;
-
-				R_GRAM[xg][i] = (unsigned char) ccR;
-				G_GRAM[xg][i] = (unsigned char) ccG;
-				B_GRAM[xg][i] = (unsigned char) ccB;
+				dat = dialCover[off] + dialScratch[off];
+				dialCover[off] = ( dat > 0xFF ) ? 0xFF : dat;
+				dialScratch[off] = 0;
 			}
-		}											// End of "i" loop
-	}												// End of "xg" loop
+		}
+	}
+}
+
+#endif
 
 
 /*
- *	Numbers on the inside scale:
+ *	"InitBlend()" fills in one of the "blend" tables (see "Colorize()") with the mix of
+ *	"color" and the dial background for every amount of coverage. The mix is worked
+ *	out exactly the way it was when it was done for every pixel. Pixels that aren't
+ *	covered at all get the dial background color.
  */
 
-	if ( F_MAIN_OUTSIDE == 1 )						// If the main dial is outside
+static void InitBlend ( uint16_t* table, uint32_t color )
+{
+	int				i;									// Loop counter
+	unsigned int	cR,  cG,  cB;						// Red, green and
+	unsigned int	dcR, dcG, dcB;						// blue stuff
+	int 			ccR, ccG, ccB;
+	float 			kido;
+
+	cR = ( color >> 16 ) & 0xFF;						// Split the color
+	cG = ( color >>  8 ) & 0xFF;						// into RGB components
+	cB = color & 0xFF;
+
+	dcR = ( CL_DIAL_BG >> 16 ) & 0xFF;					// Same for the dial
+	dcG = ( CL_DIAL_BG >>  8 ) & 0xFF;					// background
+	dcB = ( CL_DIAL_BG) & 0xFF;
+
+	table[0] = Color65k ( CL_DIAL_BG );
+
+	for ( i = 1; i < 256; i++ )
 	{
-		cR = ( CL_NUM_SUB >> 16 ) & 0xFF;
-		cG = ( CL_NUM_SUB >>  8 ) & 0xFF;
-		cB = CL_NUM_SUB & 0xFF;
+		kido = (float) i / (float) 255.0;
+		ccR  = (int) ( kido * (float) cR + ( 1.0 - kido ) * (float) dcR + 0.5 );
+		ccG  = (int) ( kido * (float) cG + ( 1.0 - kido ) * (float) dcG + 0.5 );
+		ccB  = (int) ( kido * (float) cB + ( 1.0 - kido ) * (float) dcB + 1.0 );
+
+		if ( ccR > 0xFF ) ccR = 0xFF;
+		if ( ccG > 0xFF ) ccG = 0xFF;
+		if ( ccB > 0xFF ) ccB = 0xFF;
+
+		table[i] = RGB65k ( ccR, ccG, ccB );
 	}
+}
+
 
-	else											// Main dial is inside
+/*
+ *	"Colorize()" turns the coverage in column "xg" of the dial into colors in "GRAM65k".
+ *	From the outside edge of the dial in, there are the outside scale's ticks, its
+ *	numbers, the inside scale's ticks and its numbers; "yry" has where each of those
+ *	areas starts in the column. Each area has its own color, and its "blend" table
+ *	has the finished color for each amount of coverage, so there's just one table
+ *	lookup per pixel.
+ */
+
+static void Colorize ( int xg )
+{
+	int				i = 0;
+	int				n;
+	const uint16_t*	lut;
+	uint16_t*		pixel = GRAM65k + xg * Ny;
+	const uint8_t*	cover = dialCover + xg * coverRows;
+	const int		top[4] = { yry[xg][3], yry[xg][2], yry[xg][1], yry[xg][0] + 1 };
+
+	for ( n = 0; n < 4; n++ )
 	{
-		cR = ( CL_NUM_MAIN >> 16) & 0xFF;
-		cG = ( CL_NUM_MAIN >>  8 ) & 0xFF;
-		cB = CL_NUM_MAIN & 0xFF;
+		lut = blend[n];
+
+		for ( ; i < top[n]; i++ )
+			pixel[i] = lut[cover[i]];
 	}
+}
 
-	for ( xg = D_left; xg <= D_right; xg++ )
-	{
-		for ( i = 0; i < yry[xg][3]; i++ )
-		{
-			if ( R_GRAM[xg][i] != 0 )
-			{
-				kido = (float)R_GRAM[xg][i] / (float) 255.0;
-				ccR  = (int) ( kido * (float) cR + ( 1.0 - kido ) * (float) dcR + 0.5 );
-				ccG  = (int) ( kido * (float) cG + ( 1.0 - kido ) * (float) dcG + 0.5 );
-				ccB  = (int) ( kido * (float) cB + ( 1.0 - kido ) * (float) dcB + 1.0 );
-
-				if ( ccR > 0xFF ) ccR = 0xFF;
-				if ( ccG > 0xFF ) ccG = 0xFF;
-				if ( ccB > 0xFF ) ccB = 0xFF;
-
-				R_GRAM[xg][i] = (unsigned char) ccR;
-				G_GRAM[xg][i] = (unsigned char) ccG;
-				B_GRAM[xg][i] = (unsigned char) ccB;
-			}
-		}											// End of "i" loop
-	}												// End of "xg" loop
 
+/*
+ *	"Dial()" is the primary entry point here. It paints the dial into "GRAM65k".
+ */
+
+void Dial ( long freq )							// "freq" is unsigned in the main program!!!
+{
+	int 	xg;
+	int		yg;
+	float	fsign;
+
+	#if !DIAL_CACHE
+		float	angle;							// How far the scales are turned
+	#endif
+
+	dotPlane = dialCover;						// Normally "dot()" paints the real thing
 
 /*
- *	Dial base:
+ *	The dial looks the same every time it's painted for the same frequency. The pointer
+ *	can go below "D_HEIGHT" (see "DP_POS").
  */
 
-	for ( xg = D_left; xg <= D_right; xg++ )
+	AddDamage ( 0, 0, Nx - 1, D_HEIGHT + DP_POS, (uint32_t) freq );
+
+	if ( F_REV==1 )	freq = -freq;				// See "config.h"
+
+	if ( freq < 0 )								// Negative frequency?
 	{
-		yg = yry[xg][0];
+		freq = - freq;							// Make positive
+		fsign = -1.0;							// Multiply by -1 somewhere I assume
+	}
 
-		for ( i = 0; i <= yg; i++ )
-		{
-			if (( R_GRAM[xg][i] == 0 ) && ( G_GRAM[xg][i] == 0 ) && ( B_GRAM[xg][i] == 0 ))
-			{
-				R_GRAM[xg][i] = dcR;
-				G_GRAM[xg][i] = dcG;
-				B_GRAM[xg][i] = dcB;
-			}
-		}
+	else										// Frequency was positive
+	{
+		fsign = 1.0;							// Multiply by +1 somewhere I assume
 	}
 
+	memset ( dialCover, 0, Nx * coverRows );	// Nothing covered yet
+
+
+/*
+ *	Figure out the sub-dial:
+ */
+
+	#if DIAL_CACHE
+
+		CachedScale ( subCache, SubScale, freq, fsign,
+						freq_tick * 10, reso_sub / (float) freq_tick );
+
+	#else
+
+		angle = -(float) ( freq % ( freq_tick * 10 ) ) * reso_sub / (float) freq_tick;
+		angle *= fsign;
+
+		SubScale ( freq, fsign, angle );
+
+	#endif
+
+
+/*
+ *	Now we do all the same stuff for the main dial:
+ */
+
+	#if DIAL_CACHE
+
+		CachedScale ( mainCache, MainScale, freq, fsign,
+						FREQ_TICK_MAIN * 10, reso_main / (float) FREQ_TICK_MAIN );
+
+	#else
+
+		angle = -(float) ( freq %  (FREQ_TICK_MAIN * 10 )) * reso_main / (float) FREQ_TICK_MAIN;
+		angle *= fsign;
+
+		MainScale ( freq, fsign, angle );
+
+	#endif
+
+
+/*
+ *	Now the coloring:
+ */
+
+	for ( xg = D_left; xg <= D_right; xg++ )
+		Colorize ( xg );
+
 
 /*
  *	Pointer:
@@ -1017,11 +1238,7 @@ float 			kido;
 	for ( xg = D_center - ( DP_WIDTH - 1 ); xg <= D_center + ( DP_WIDTH - 1 ); xg++ )
 	{
 		for ( yg = ypt; yg < ( D_HEIGHT + DP_POS ); yg++ )
-		{
-			R_GRAM[xg][yg] = ( CL_POINTER >> 16 ) & 0xFF;
-			G_GRAM[xg][yg] = ( CL_POINTER >>  8 ) & 0xFF;
-			B_GRAM[xg][yg] = ( CL_POINTER) & 0xFF;
-		}
+			GRAM65k[xg * Ny + yg] = Color65k ( CL_POINTER );
 	}
 
 
@@ -1031,41 +1248,75 @@ float 			kido;
  */
 
 	for ( yg = 0; yg < yry[0][0] ; yg++ )
-	{
-		R_GRAM[0][yg] = CL_DIAL_BG;
-		G_GRAM[0][yg] = CL_DIAL_BG;
-		B_GRAM[0][yg] = CL_DIAL_BG;
-	}
+		GRAM65k[0 * Ny + yg] = Color65k ( CL_DIAL_BG );
 
 	for ( yg = 0; yg < yry[1][0] ; yg++ )
-	{      
-		R_GRAM[1][yg] = CL_DIAL_BG;
-		G_GRAM[1][yg] = CL_DIAL_BG;
-		B_GRAM[1][yg] = CL_DIAL_BG;
-	}
+		GRAM65k[1 * Ny + yg] = Color65k ( CL_DIAL_BG );
 
 	for ( xg = 0; xg < Nx; xg++ )
 	{
-		R_GRAM[xg][0] = CL_DIAL_BG;
-		G_GRAM[xg][0] = CL_DIAL_BG;
-		B_GRAM[xg][0] = CL_DIAL_BG;
-			
-		R_GRAM[xg][1] = CL_DIAL_BG;
-		G_GRAM[xg][1] = CL_DIAL_BG;
-		B_GRAM[xg][1] = CL_DIAL_BG;
+		GRAM65k[xg * Ny + 0] = Color65k ( CL_DIAL_BG );
+		GRAM65k[xg * Ny + 1] = Color65k ( CL_DIAL_BG );
 	}
 }													// End of "Dial()"
 
 
 /*
- *	"dot()" sets the color of a single pixel someplace on the display image:
+ *	When "CachedScale()" is painting a scale into the scratch plane, "DOT_LIST" adds
+ *	each pixel to the cache entry the first time "dot()" changes it from zero.
+ */
+
+#if DIAL_CACHE
+
+	#define	DOT_LIST(off,dat)									\
+		if ( dotList && dat && !dotPlane[off] )					\
+		{														\
+			if ( dotList->count < DIAL_CACHE_POINTS )			\
+				dotList->points[dotList->count++] = off << 8;	\
+			else												\
+				dotList->count = DIAL_CACHE_POINTS;				\
+		}
+
+#else
+
+	#define	DOT_LIST(off,dat)
+
+#endif
+
+
+/*
+ *	"Brighten()" adds "amount" to the pixel at "x", "y" in "dotPlane" if it's in the
+ *	dial area (and "StripColumn()" allows it), limiting the result to 0xFF.
+ */
+
+static inline void Brighten ( int x, int y, int amount )
+{
+	unsigned int	dat;
+	int				off;
+
+	if ( x < D_left || x > D_right || !StripColumn ( x ) || y < 0 || y >= coverRows )
+		return;
+
+	off = x * coverRows + y;
+	dat = (int) dotPlane[off] + amount;
+
+	if ( dat > 0xFF )	dat = 0xFF;
+
+	DOT_LIST ( off, dat );
+	dotPlane[off] = (unsigned char) dat;
+}
+
+
+/*
+ *	"dot()" sets the color of a single pixel someplace on the display image. Actually,
+ *	it adds to the brightness of the four pixels around "x", "y" in "dotPlane", which
+ *	is normally "dialCover"; "Dial()" turns those into real colors later:
  */
 
 void dot ( float x, float y )
 {
 	int				xd, yd, xu, yu;
 	float			Rxu, Rxd, Ryu, Ryd;
-	unsigned int	dat;
 
 	y = y + 0.5 * (float) ( TICK_WIDTH );
 
@@ -1082,28 +1333,59 @@ void dot ( float x, float y )
 		Ryd = ((float) yu - y );
 		Ryu = ( y - (float) yd );
 
-		dat = (int) R_GRAM[xd][yd] + (int) ( Rxd * Ryd * 256.0 );
+		Brighten ( xd, yd, (int) ( Rxd * Ryd * 256.0 ));
+		Brighten ( xu, yd, (int) ( Rxu * Ryd * 256.0 ));
+		Brighten ( xd, yu, (int) ( Rxd * Ryu * 256.0 ));
+		Brighten ( xu, yu, (int) ( Rxu * Ryu * 256.0 ));
+	}
+}													// End of "dot()"
 
-		if ( dat > 0xFF )	dat = 0xFF;
 
-		R_GRAM[xd][yd] = (unsigned char) dat;
+#if DIAL_FIXED_POINT
 
-		dat = (unsigned int) R_GRAM[xu][yd] + (unsigned int)  (Rxu * Ryd * 256.0 );
+/*
+ *	"dotQ()" is the fixed point version of "dot()". "x" and "y" are scaled by 2^16,
+ *	and what's left over after taking out the whole pixels is the fraction used to
+ *	split the brightness among the four pixels. It truncates the same as "(int)" does
+ *	in "dot()", so it drops the same dots at the edges of the screen, and the shares
+ *	are divided rather than shifted, so a dot hanging off the left edge (where one
+ *	share is less than 0) comes out the same too.
+ *
+ *	Past 256 pixels a float only has 2^-15 of a pixel to work with, so "dot()" sees a
+ *	dot that's 2^-16 short of the last column as right on it, and drops it. "dotQ()"
+ *	does the same; otherwise that dot would paint almost all of itself in the last
+ *	column.
+ */
 
-		if ( dat > 0xFF)	dat = 0xFF;
+static void dotQ ( int32_t x, int32_t y )
+{
+	int				xd, yd, xu, yu;
+	int32_t			Rxu, Rxd, Ryu, Ryd;
 
-		R_GRAM[xu][yd] = (unsigned char) dat;
+	y = y + TICK_WIDTH * 32768;
 
-		dat = (unsigned int) R_GRAM[xd][yu] + (unsigned int) ( Rxd * Ryu * 256.0 );
+	if ( x == ( Nx - 1 ) * 65536 - 1 )				// See above
+		x++;
 
-		if ( dat > 0xFF )	dat = 0xFF;
+	xd = x / 65536;									// Truncates the same as "(int)"
+	yd = y / 65536;
 
-		R_GRAM[xd][yu] = (unsigned char) dat;
+	if ( xd >= 0 && xd < Nx - 1 && yd >= 0 && yd < Ny - 1 )
+	{
+		xu = xd + 1; yu = yd + 1;
 
-		dat = (unsigned int) R_GRAM[xu][yu] + (unsigned int) ( Rxu * Ryu * 256.0 );
+		Rxu = x - xd * 65536;
+		Rxd = 65536 - Rxu;
 
-		if ( dat > 0xFF )	dat = 0xFF;
+		Ryu = y - yd * 65536;
+		Ryd = 65536 - Ryu;
 
-		R_GRAM[xu][yu] = (unsigned char) dat;
+		Brighten ( xd, yd, (int) (( (int64_t) Rxd * Ryd ) / 16777216 ));
+		Brighten ( xu, yd, (int) (( (int64_t) Rxu * Ryd ) / 16777216 ));
+		Brighten ( xd, yu, (int) (( (int64_t) Rxd * Ryu ) / 16777216 ));
+		Brighten ( xu, yu, (int) (( (int64_t) Rxu * Ryu ) / 16777216 ));
 	}
-}													// End of "dot()"
+}													// End of "dotQ()"
+
+#endif
+
@@ -0,0 +1,168 @@
+/*
+ *	"dial_geom.h"
+ *
+ *	"dial_geom.h" has the shape of the dial: where the center is, how far apart the
+ *	ticks are, how many of them fit on the screen and "yry", which says where each of
+ *	the four areas of the dial starts in each column. These used to be worked out by
+ *	"InitDial()" when the program started, but they only depend on the display size
+ *	and the dial settings in "config.h", so now the compiler works them out and "yry"
+ *	is a constant table in the flash.
+ *
+ *	The expressions are the same ones "InitDial()" used, done in the same order with
+ *	the same "float" and "double" roundings, so the numbers come out the same.
+ */
+
+#ifndef _DIAL_GEOM_H_
+#define _DIAL_GEOM_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// Dial size and tick settings
+#include "display.h"					// For "Nx"
+
+
+/*
+ *	Where the dial is across the screen and the radius of the inside scale:
+ */
+
+constexpr int	D_left     = 0;							// Left & right limits
+constexpr int	D_right    = Nx - 1;
+constexpr int	D_center   = ( Nx >> 1 );				// Center is width / 2
+constexpr int	D_R_inside = D_R - DIAL_SPACE;			// Radius of inside scale
+
+
+/*
+ *	"reso_sub" and "reso_main" are how many radians the scales turn from one tick to the
+ *	next. "DialArc()" is how much of the scale on radius "r" we paint ticks on, and
+ *	"DialTicks()" is how many ticks that is.
+ */
+
+constexpr float DialArc ( int r )
+{
+	return ( r < ( Nx / 2 )) ? (float) ( 1.6 * (float) r ) : (float) ( 1.6 * 0.5 * (float) Nx );
+}
+
+constexpr double DialTicks ( float arc, int pitch )
+{
+	return arc / ( 0.1 * (float) pitch );
+}
+
+constexpr int	D_R_main = ( F_MAIN_OUTSIDE == 1 ) ? D_R : D_R_inside;		// Main scale radius
+constexpr int	D_R_sub  = ( F_MAIN_OUTSIDE == 1 ) ? D_R_inside : D_R;		// Sub scale radius
+
+constexpr float	reso_sub  = (float) ( 0.1 * ((float) TICK_PITCH_SUB  / (float) D_R_sub ));
+constexpr float	reso_main = (float) ( 0.1 * ((float) TICK_PITCH_MAIN / (float) D_R_main ));
+
+constexpr double	ticks_main = DialTicks ( DialArc ( D_R_main ), TICK_PITCH_MAIN );
+constexpr double	ticks_sub  = DialTicks ( DialArc ( D_R_sub ),  TICK_PITCH_SUB );
+
+
+/*
+ *	The first ("L_") and last ("H_") tick painted for each kind of tick. The first 5
+ *	has to be an odd number (the even ones are 10s) and the first 10 an even one.
+ */
+
+constexpr int DialLow5  ( int n )	{ return -(( n / 2 + 1 ) * 2 + 1 ); }
+constexpr int DialLow10 ( int n )	{ return -(( n / 2 + 1 ) * 2 ); }
+
+constexpr int	H_main1  = (int) ( ticks_main * 2.0 );
+constexpr int	L_main1  = (int) ( ticks_main * -1.0 );
+constexpr int	H_main5  = (int) ( ticks_main / 5.0 * 2.00 );
+constexpr int	L_main5  = DialLow5 ((int) ( ticks_main / 5.0 * 0.75 ));
+constexpr int	H_main10 = (int) ( ticks_main / 10.0 * 2.00 );
+constexpr int	L_main10 = DialLow10 ((int) ( ticks_main / 10.0 * 0.75 ));
+
+constexpr int	H_sub1  = (int) ( ticks_sub * 2.0 );
+constexpr int	L_sub1  = (int) ( ticks_sub * -1.0 );
+constexpr int	H_sub5  = (int) ( ticks_sub / 5.0 * 2.00 );
+constexpr int	L_sub5  = DialLow5 ((int) ( ticks_sub / 5.0 * 0.75 ));
+constexpr int	H_sub10 = (int) ( ticks_sub / 10.0 * 2.00 );
+constexpr int	L_sub10 = DialLow10 ((int) ( ticks_sub / 10.0 * 0.75 ));
+
+
+/*
+ *	"yry[x][n]" is the row where area "n" of the dial starts in column "x". From the
+ *	outside edge in, the areas are the outside scale's ticks, its numbers, the inside
+ *	scale's ticks and its numbers, and "DIAL_ARC0" to "DIAL_ARC3" are the radii of the
+ *	arcs between them. Ah ha! Me thinks when this gets messed up, it causes the mixed
+ *	up 4 sections on the display!
+ *
+ *	Each entry is where the arc crosses the column, rounded to the nearest row and
+ *	moved to where the dial is on the screen; 0 if the arc doesn't get that far down.
+ *	"DialRoot()" does the rounded square root exactly with integers; the biggest "r"
+ *	with r * ( r - 1 ) < n is "sqrt ( n )" rounded to the nearest whole number.
+ */
+
+#define	DIAL_ARC0	( D_R )
+#define	DIAL_ARC1	( D_R - (( F_MAIN_OUTSIDE == 1 ) ? TICK_MAIN10 : TICK_SUB10 ))
+#define	DIAL_ARC2	( D_R_inside + 1 )
+#define	DIAL_ARC3	( D_R_inside - (( F_MAIN_OUTSIDE == 1 ) ? TICK_SUB10 : TICK_MAIN10 ))
+
+#if ( D_HEIGHT ) < 256
+	typedef	uint8_t		yry_t;					// Rows fit in a byte
+#else
+	typedef	uint16_t	yry_t;
+#endif
+
+constexpr long DialRoot ( int64_t n, long lo, long hi )
+{
+	return ( lo == hi ) ? lo
+		: (( (int64_t) (( lo + hi + 1 ) / 2 ) * (( lo + hi + 1 ) / 2 - 1 )) < n )
+			? DialRoot ( n, ( lo + hi + 1 ) / 2, hi )
+			: DialRoot ( n, lo, ( lo + hi + 1 ) / 2 - 1 );
+}
+
+constexpr long DialRow ( long root )
+{
+	return ( root + ( D_HEIGHT ) - D_R < 0 ) ? 0 : root + ( D_HEIGHT ) - D_R;
+}
+
+constexpr int64_t DialArcSq ( long r, long x )
+{
+	return (int64_t) r * r - (int64_t) ( x - D_center ) * ( x - D_center );
+}
+
+constexpr yry_t DialArcRow ( long r, long x )
+{
+	return ( DialArcSq ( r, x ) <= 0 ) ? 0 : (yry_t) DialRow ( DialRoot ( DialArcSq ( r, x ), 0, r ));
+}
+
+
+/*
+ *	The compiler makes the table from a list of the column numbers, 0 to Nx - 1, which
+ *	"MakeDialSeq" puts together half at a time so it doesn't have to go very deep.
+ */
+
+template <int... X> struct DialSeq {};
+
+template <class A, class B> struct DialJoin;
+
+template <int... A, int... B> struct DialJoin<DialSeq<A...>, DialSeq<B...>>
+{
+	typedef	DialSeq<A..., ( (int) sizeof... ( A ) + B )...>	type;
+};
+
+template <int N> struct MakeDialSeq
+{
+	typedef	typename DialJoin<typename MakeDialSeq<N / 2>::type,
+							  typename MakeDialSeq<N - N / 2>::type>::type	type;
+};
+
+template <> struct MakeDialSeq<0>	{ typedef DialSeq<>  type; };
+template <> struct MakeDialSeq<1>	{ typedef DialSeq<0> type; };
+
+template <class S> struct DialArcs;
+
+template <int... X> struct DialArcs<DialSeq<X...>>
+{
+	static const yry_t	yry[sizeof... ( X )][4];
+};
+
+template <int... X> const yry_t DialArcs<DialSeq<X...>>::yry[sizeof... ( X )][4] =
+{
+	{ DialArcRow ( DIAL_ARC0, X ), DialArcRow ( DIAL_ARC1, X ),
+	  DialArcRow ( DIAL_ARC2, X ), DialArcRow ( DIAL_ARC3, X ) }...
+};
+
+static const yry_t	( &yry )[Nx][4] = DialArcs<MakeDialSeq<Nx>::type>::yry;
+
+#endif							// _DIAL_GEOM_H_
@@ -2,18 +2,23 @@
  *	"display.cpp"
  *
  *	"display.cpp" contains the functions which actually update the display. As described
- *	in the documentation, updating the display is a three step process.
+ *	in the documentation, updating the display is a two step process.
  *
- *	The main program file and the "dial.cpp" module build a pixel map in 3 separate
- *	"GRAM" arrays (one for the red component, one for the green component and one for
- *	the blue component.
- *
- *	Once those are complete, the "trans65k" function combines the data in the 3 separate
- *	"GRAM" arrays into the "GRAM65k" array as a 16 bit color value for each pixel on the
- *	screen.
+ *	The main program file and the "dial.cpp" module build a pixel map in the "GRAM65k"
+ *	array, which has the 16 bit color of each pixel on the screen in the form the
+ *	display wants it.
  *
  *	Once that array is complete, the "Transfer_Image" function copies the contents of
- *	that array to the display's memory.
+ *	that array to the display's memory. It only sends the parts of the screen that
+ *	changed since the last time (see "damage.cpp").
+ *
+ *	There are actually two of those arrays. When "Transfer_Image()" is called, the one
+ *	that was just painted becomes "GRAMsend" and the other one becomes "GRAM65k", so the
+ *	main program can start painting the next screen while this one is being sent.
+ *
+ *	There used to be 3 separate "GRAM" arrays (one each for the red, green and blue
+ *	components) and a "trans65k" function that combined them into "GRAM65k" for every
+ *	update. Painting straight into "GRAM65k" saves that step and a lot of memory.
  *
  *	This has been heavily modified from TJ Uebo's original code.
  *
@@ -41,16 +46,45 @@
 #include "config.h"					// Hardware configuration
 #include "display.h"				// Display handling functions
 #include "graph.h"					// Has string and line display functions
+#include "damage.h"					// Tracks which parts of the screen changed
+#include "latency.h"				// Times the screens with new frequencies on them
 #include <TFT_eSPI.h>				// From: https://github.com/Bodmer/TFT_eSPI
 
-extern uint8_t**  	R_GRAM;			// Red component of pixels
-extern uint8_t**  	B_GRAM;			// Blue component of pixels
-extern uint8_t**  	G_GRAM;			// Green component of pixels
+#if DISPLAY_DMA
+	#include <esp_heap_caps.h>		// For "heap_caps_malloc()"
+#endif
 
-extern	uint16_t*	GRAM65k;		// 16 bit version of the color of a pixel
+extern	uint16_t*	GRAM65k;		// Image being painted
+extern	uint16_t*	GRAMsend;		// Image being sent to the display
 
 TFT_eSPI	tft;					// Create the display object
 
+static damage_rect	sendRect[DAMAGE_RECTS];	// Areas "Transfer_Image()" has to send
+static int			sendCount;				// Number of them
+
+
+/*
+ *	With "DISPLAY_DMA", the areas are sent a piece at a time. Each piece is a number of
+ *	"x" columns of one of the areas, copied from "GRAMsend" into one of the "dmaBuf"s.
+ *	While one piece is going out, the next one is copied into the other buffer.
+ *
+ *	If the buffers can't be had, "useDma" stays "false" and everything is sent the way
+ *	it is without "DISPLAY_DMA".
+ */
+
+#if DISPLAY_DMA
+
+static bool			useDma = false;			// Got the buffers
+static uint16_t*	dmaBuf[2];				// Internal memory the DMA can read
+static int			dmaNext = 0;			// Buffer the next piece goes in
+static int			sendIx;					// Area the next piece comes from
+static int			sendX;					// First column of the next piece
+static int32_t		pieceX, pieceY;			// Where the next piece goes on the
+static int32_t		pieceW, pieceH;			// display; "pieceH" is 0 if no more
+static bool			sending = false;		// True until the last piece is done
+
+#endif
+
 
 /*
  *	"InitDisplay()", initializes the display:
@@ -61,45 +95,187 @@ void InitDisplay ( void )
 	tft.begin ();								// Initialize the TFT
 	tft.setRotation ( TFT_MODE );				// 0 & 2 Portrait. 1 & 3 landscape
 	tft.fillScreen  ( CL_BG );					// Fill screen with standard background
+
+	#if DISPLAY_DMA
+
+		dmaBuf[0] = (uint16_t*) heap_caps_malloc ( DMA_PIXELS * sizeof ( uint16_t ), MALLOC_CAP_DMA );
+		dmaBuf[1] = (uint16_t*) heap_caps_malloc ( DMA_PIXELS * sizeof ( uint16_t ), MALLOC_CAP_DMA );
+
+		if ( dmaBuf[0] && dmaBuf[1] )
+		{
+			tft.initDMA ();						// Get the SPI DMA ready
+			useDma = true;
+		}
+
+		else									// Do without it
+		{
+			heap_caps_free ( dmaBuf[0] );
+			heap_caps_free ( dmaBuf[1] );
+		}
+
+	#endif
 }
 
 
+#if DISPLAY_DMA
+
 /*
- *	"Transfer_Image()" copies the pixel map from the ESP32 memory to the display
- *	memory.
+ *	"NextPiece()" copies as many columns of the area being sent as will fit into
+ *	"dmaBuf[dmaNext]" and works out where they go on the display. A column is never
+ *	more than "DISP_H" pixels, which is a lot less than "DMA_PIXELS".
+ */
+
+static void NextPiece ( void )
+{
+	int				ix;
+	damage_rect*	r;
+
+	pieceH = 0;
+
+	if ( sendIx >= sendCount )					// All done?
+		return;
+
+	r = &sendRect[sendIx];
+
+	pieceX = r->y_min;							// Flip-flopped, same as
+	pieceY = sendX;								// below
+	pieceW = r->y_max - r->y_min + 1;
+	pieceH = DMA_PIXELS / pieceW;
+
+	if ( pieceH > r->x_max - sendX + 1 )		// Rest of the area fits?
+		pieceH = r->x_max - sendX + 1;
+
+	for ( ix = 0; ix < pieceH; ix++ )
+		memcpy ( dmaBuf[dmaNext] + ix * pieceW, GRAMsend + ( sendX + ix ) * DISP_H + r->y_min,
+					pieceW * sizeof ( uint16_t ));
+
+	sendX += pieceH;
+
+	if ( sendX > r->x_max )						// Finished this area?
+	{
+		sendIx++;
+
+		if ( sendIx < sendCount )
+			sendX = sendRect[sendIx].x_min;
+	}
+}
+
+#endif
+
+
+/*
+ *	"Transfer_Image()" swaps the images and starts sending the one that was just painted
+ *	to the display. It must not be called until "Transfer_Done()" says the last one has
+ *	been sent, and "loop()" must not paint anything while it's being called (that's what
+ *	"redrawScreen" takes care of).
  *
  *	For whatever reason, this only works with the width and height arguments flip-flopped
  *	from what it indicates in the "TFT_eSPI.h" library header.
+ *
+ *	Only the areas that changed are sent. The "GRAM65k" array has all the "y"
+ *	values for each "x" together, and that's how the display gets them too, so when
+ *	only part of the screen is sent, each "x" column of it is one "pushPixels()".
+ *
+ *	Without "DISPLAY_DMA" (or the memory for it), everything is sent before it returns.
  */
 
 void Transfer_Image( void )
 {
-	tft.pushRect ( 0, 0, DISP_H, DISP_W, GRAM65k );		// Pretty simple, eh?
+	uint16_t*	temp;
+
+	temp     = GRAMsend;								// The one we just painted
+	GRAMsend = GRAM65k;									// gets sent and the old
+	GRAM65k  = temp;									// one gets painted next
+
+	sendCount = TakeDamage ( sendRect );
+
+	LatencyMark ( LAT_SEND );
+
+#if DISPLAY_DMA
+
+	if ( useDma )
+	{
+		sendIx = 0;
+		sendX  = sendRect[0].x_min;
+
+		tft.startWrite ();								// Hang on to the SPI bus
+
+		NextPiece ();									// Get the first piece ready
+		sending = true;
+
+		Transfer_Done ();								// And start it
+		return;
+	}
+
+#endif
+
+	int		ix, xps;
+	int		w, h;
+
+	if ( sendCount == 1 && sendRect[0].x_min == 0 && sendRect[0].x_max == DISP_W - 1
+					&& sendRect[0].y_min == 0 && sendRect[0].y_max == DISP_H - 1 )
+	{
+		tft.pushRect ( 0, 0, DISP_H, DISP_W, GRAMsend );	// Pretty simple, eh?
+		LatencyMark ( LAT_SENT );
+		return;
+	}
+
+	tft.startWrite ();
+
+	for ( ix = 0; ix < sendCount; ix++ )
+	{
+		w = sendRect[ix].y_max - sendRect[ix].y_min + 1;	// Flip-flopped here too
+		h = sendRect[ix].x_max - sendRect[ix].x_min + 1;
+
+		tft.setAddrWindow ( sendRect[ix].y_min, sendRect[ix].x_min, w, h );
+
+		for ( xps = sendRect[ix].x_min; xps <= sendRect[ix].x_max; xps++ )
+			tft.pushPixels ( GRAMsend + xps * DISP_H + sendRect[ix].y_min, w );
+	}
+
+	tft.endWrite ();
+	LatencyMark ( LAT_SENT );
 }
 
 
 /*
- *	"trans65k()" takes the RGB components from the individual "GRAM" arrays and creates
- *	the 16 bit colors.
+ *	"Transfer_Done()" keeps the transfer started by "Transfer_Image()" going and returns
+ *	"true" once all of it has been sent. It never waits for the DMA; if the last piece
+ *	is still on its way, it just returns "false", so it has to be called regularly
+ *	("task0()" does it every time around).
  */
 
-void trans65k ( void )
+bool Transfer_Done ( void )
 {
-	int xps, yps;
+#if DISPLAY_DMA
 
-	uint16_t col16;
+	if ( !sending )										// Nothing going on
+		return true;
 
-	for  (xps = 0; xps < DISP_W; xps++ )					// Column loop
+	if ( tft.dmaBusy ())								// Still sending the last piece
+		return false;
+
+	if ( pieceH == 0 )									// That was the last one
 	{
-		for ( yps = 0; yps < DISP_H; yps++ )				// Row loop
-		{
-			col16= ( 0xf800 & ( R_GRAM[xps][yps] <<8 ))
-				 | ( 0x07E0 & ( G_GRAM[xps][yps] <<3 ))
-				 | ( 0x001F & ( B_GRAM[xps][yps] >>3 ));
+		tft.endWrite ();
+		sending = false;
+		LatencyMark ( LAT_SENT );
 
-			*( GRAM65k + xps * DISP_H + yps ) = ( col16 >> 8 ) | ( col16 << 8 );
-		}
+		return true;
 	}
+
+	tft.pushImageDMA ( pieceX, pieceY, pieceW, pieceH, dmaBuf[dmaNext] );
+
+	dmaNext ^= 1;										// Fill the other buffer
+	NextPiece ();										// while that one goes out
+
+	return false;
+
+#else
+
+	return true;										// Already sent it all
+
+#endif
 }
 
 
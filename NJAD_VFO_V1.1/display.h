@@ -24,9 +24,11 @@
 #ifndef _DISPLAY_H_
 #define _DISPLAY_H_
 
+#include <Arduino.h>					// For "uint16_t", etc.
 #include "config.h"						// Defines the display size and other stuff
 
 
+
 /*
  *	Note there are four different versions of the display size! "DISP_H" and "DISP_W"
  *	are defined in "config.h" and are used to define the alternate versions. One of these
@@ -46,7 +48,29 @@
 
 void InitDisplay ( void );			// Initialize the display
 void Transfer_Image ( void );		// Put the image on the screen
-void trans65k ( void );				// Converts separate RGB arrays to 65K color array
+bool Transfer_Done ( void );		// Keeps it going; true when it's all there
+
 void PaintSplash ();				// Paints the splash screen
 
+
+/*
+ *	The screen image ("GRAM65k") holds 16 bit (RGB565) colors with the bytes already
+ *	swapped the way the display wants them. "RGB65k()" makes one of those out of 8 bit
+ *	red, green and blue values and "Color65k()" does the same for one of the 24 bit
+ *	colors defined in "config.h".
+ */
+
+inline uint16_t RGB65k ( unsigned int r, unsigned int g, unsigned int b )
+{
+	uint16_t col16 = ( 0xF800 & ( r << 8 )) | ( 0x07E0 & ( g << 3 )) | ( 0x001F & ( b >> 3 ));
+
+	return ( col16 >> 8 ) | ( col16 << 8 );
+}
+
+inline uint16_t Color65k ( uint32_t color )
+{
+	return RGB65k (( color >> 16 ) & 0xFF, ( color >> 8 ) & 0xFF, color & 0xFF );
+}
+
+
 #endif
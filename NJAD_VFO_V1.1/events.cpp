@@ -0,0 +1,146 @@
+/*
+ *	"events.cpp"
+ *
+ *	"events.cpp" is the queue between the interrupt handlers for the frequency and
+ *	clarifier encoders and the PTT line, and "task0()" which acts on what they saw.
+ *
+ *	The interrupt handlers used to count encoder steps in "freqCount" and "task0()"
+ *	took them out with "count = freqCount / ENCDR_FCTR; freqCount %= ENCDR_FCTR",
+ *	which isn't one operation; a step that came in between the two got lost. Now each
+ *	handler just puts an event in the queue with the time it happened and "task0()"
+ *	takes them out in order.
+ *
+ *	Only the interrupt handlers put events in and only "task0()" takes them out, so
+ *	no locking is needed. "head" is only changed by the handlers and "tail" only by
+ *	"task0()"; each side fills in or reads the slot before moving its own index on,
+ *	and the "__atomic" stores and loads make sure the other processor core sees the
+ *	slot before it sees the new index. The handlers all run on core #1 at the same
+ *	interrupt level, so they never interrupt each other.
+ *
+ *	"task0()" doesn't poll the queue; it sleeps in "WaitEvents()" until "PutEvent()"
+ *	or "WakeEvents()" gives it a FreeRTOS task notification, or the time it's
+ *	willing to wait runs out.
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include "config.h"							// User customization stuff
+#include "events.h"							// Our function prototypes
+#include "trace.h"							// Recording the inputs
+
+#if ( EVENT_QUEUE & ( EVENT_QUEUE - 1 ))
+	#error "EVENT_QUEUE" has to be a power of 2
+#endif
+
+static input_event	queue[EVENT_QUEUE];
+static uint32_t		head = 0;				// Next slot to fill (counts forever)
+static uint32_t		tail = 0;				// Next slot to empty
+static uint32_t		lost = 0;				// Events that didn't fit
+
+static TaskHandle_t	waiting = NULL;			// The task to notify ("task0()")
+
+
+/*
+ *	"PutEvent()" is called from the interrupt handlers. If the queue is full, the
+ *	event is dropped and counted. With "TRACE_INPUT" on, it's recorded either way.
+ */
+
+#if TRACE_INPUT
+	static const char	traceType[] = { TR_FREQ, TR_CLAR, TR_PTT };	// For EV_FREQ, etc.
+#endif
+
+
+IRAM_ATTR bool PutEvent ( uint8_t type, int8_t value )
+{
+	uint32_t	us = micros ();
+	uint32_t	h  = head;
+	uint32_t	t  = __atomic_load_n ( &tail, __ATOMIC_ACQUIRE );
+
+	#if TRACE_INPUT
+		TraceRecord ( traceType[type], value, us );
+	#endif
+
+	if (( h - t ) >= EVENT_QUEUE )			// Full?
+	{
+		lost++;
+		return false;
+	}
+
+	input_event&	ev = queue[h & ( EVENT_QUEUE - 1 )];
+
+	ev.us    = us;
+	ev.type  = type;
+	ev.value = value;
+
+	__atomic_store_n ( &head, h + 1, __ATOMIC_RELEASE );
+
+	if ( waiting )							// Wake up "task0()"
+	{
+		BaseType_t	woken = pdFALSE;
+
+		vTaskNotifyGiveFromISR ( waiting, &woken );
+
+		if ( woken )
+			portYIELD_FROM_ISR ();
+	}
+
+	return true;
+}
+
+
+/*
+ *	"GetEvent()" takes the oldest event out of the queue. It returns "false" if
+ *	there isn't one.
+ */
+
+bool GetEvent ( input_event* ev )
+{
+	uint32_t	t = tail;
+	uint32_t	h = __atomic_load_n ( &head, __ATOMIC_ACQUIRE );
+
+	if ( h == t )							// Empty?
+		return false;
+
+	*ev = queue[t & ( EVENT_QUEUE - 1 )];
+
+	__atomic_store_n ( &tail, t + 1, __ATOMIC_RELEASE );
+
+	return true;
+}
+
+
+uint32_t EventsLost ( void )
+{
+	return lost;
+}
+
+
+/*
+ *	"WaitEvents()" is called by "task0()" to sleep until there's something in the
+ *	queue, something else wakes it, or "ms" milliseconds go by. The first call tells
+ *	us which task to wake up.
+ */
+
+void WaitEvents ( uint32_t ms )
+{
+	if ( waiting == NULL )
+		waiting = xTaskGetCurrentTaskHandle ();
+
+	if ( __atomic_load_n ( &head, __ATOMIC_ACQUIRE ) != tail )	// Already something there
+		return;
+
+	ulTaskNotifyTake ( pdTRUE, pdMS_TO_TICKS ( ms ));
+}
+
+
+/*
+ *	"WakeEvents()" wakes "task0()" up from outside an interrupt handler; "loop()"
+ *	calls it when it's painted a new screen or changed something "task0()" needs
+ *	to act on.
+ */
+
+void WakeEvents ( void )
+{
+	if ( waiting )
+		xTaskNotifyGive ( waiting );
+}
+
@@ -0,0 +1,48 @@
+/*
+ *	"events.h"
+ *
+ *	"events.h" contains the definitions and function prototypes for the "events.cpp"
+ *	module, which passes what the encoder and PTT interrupt handlers see to "task0()".
+ */
+
+#ifndef _EVENTS_H_
+#define _EVENTS_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "EVENT_QUEUE"
+
+
+/*
+ *	The kinds of events:
+ */
+
+#define	EV_FREQ		0					// Frequency encoder step ("value" is +1 or -1)
+#define	EV_CLAR		1					// Clarifier encoder step ("value" is +1 or -1)
+#define	EV_PTT		2					// PTT line changed ("value" is the pin level)
+
+
+/*
+ *	One event, with the time ("micros()") the interrupt handler saw it:
+ */
+
+struct input_event
+{
+	uint32_t	us;						// When it happened
+	uint8_t		type;					// EV_FREQ, etc.
+	int8_t		value;
+};
+
+
+/*
+ *	Function prototypes:
+ */
+
+bool	 PutEvent ( uint8_t type, int8_t value );	// From the interrupt handlers
+bool	 GetEvent ( input_event* ev );				// From "task0()"
+uint32_t EventsLost ( void );						// Events dropped because the queue was full
+
+void	 WaitEvents ( uint32_t ms );				// "task0()" sleeps until something happens
+void	 WakeEvents ( void );						// Something other than an event happened
+
+
+#endif
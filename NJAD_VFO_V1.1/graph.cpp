@@ -5,16 +5,21 @@
  *	or not). The only modification from TJ's original code other than cleaning up the
  *	formatting and adding some comments is the addition of the "setPixel" function which
  *	eliminated a lot of redundent code.
+ *
+ *	Everything here that paints something also tells "AddDamage()" where it was painted
+ *	so only the parts of the screen that change get sent to the display (see "damage.cpp").
+ *
+ *	The 12, 16 and 20 pixel fonts are painted from a glyph atlas instead of straight from
+ *	the font tables (see "PaintString()").
  */
 
 #include <Arduino.h>						// General Arduino definitions
 #include "display.h"						// Display in use definitions
 #include "graph.h"							// Our function prototypes
 #include "font.h"							// Font definitions
+#include "damage.h"							// Tracks what changed on the screen
 
-extern uint8_t**  R_GRAM;					// Red component of pixels
-extern uint8_t**  B_GRAM;					// Blue component of pixels
-extern uint8_t**  G_GRAM;					// Green component of pixels
+extern uint16_t*  GRAM65k;					// The screen image
 
 
 /*
@@ -40,10 +45,14 @@ void BoxFill ( int x_min, int y_min, int x_max, int y_max, uint32_t color )
 	if ( y_min < 0 )	y_min = 0;				// are on the screen, otherwise
 	if ( x_max >= Nx )	x_max = Nx-1;			// we'll write outside the GRAM
 	if ( y_max >= Ny)	y_max = Ny-1;			// array limits (causing havoc)!
-    
+
+	uint16_t c65k = Color65k ( color );			// Only convert the color once
+
 	for ( k = x_min; k <= x_max; k++ )			// Horizontal counter
 		for ( j = y_min; j <= y_max; j++ )		// Vertical counter
-			setPixel ( k, j, color );			// Turn pixel on
+			GRAM65k[k * Ny + j] = c65k;			// Turn pixel on
+
+	AddDamage ( x_min, y_min, x_max, y_max, color );
 }
 
 
@@ -59,6 +68,9 @@ void Line ( int xs, int ys, int xe, int ye, uint32_t color )
 	int ystep =  ye > ys ? 1 : -1;					// direction
 	int j;											// Loop index
 
+	AddDamage ( xs, ys, xe, ye, color				// Which way it goes matters
+				| (( xe < xs ) << 24 ) | (( ye < ys ) << 25 ));	// for a diagonal line
+
 	if ( dx == 0 && dy == 0)						// Zero length line?
 		setPixel ( xs, ys, color );
 
@@ -181,69 +193,332 @@ void disp_str8 ( char *s, int x, int y, uint32_t color )	// 5x7
 		N = disp_chr8 ( c, N, y, color );			// Paint the character
 		N += 1;										// 1 pixel space?
 	}
+
+	AddDamage ( x, y, N - 1, y + 7, DamageSig ( s, color ^ ( 8 << 24 )));
 }
 
 
-void disp_str12 ( char *s, int x, int y, uint32_t color )	// Font12
+/*
+ *	The 12, 16 and 20 pixel fonts go through a glyph atlas, which is made from the font
+ *	tables the first time one of them is used. In the tables, each character is a list
+ *	of columns, with the bits of each column (low order bit at the top) saying which
+ *	pixels are painted. Since all the rows for one "x" are together in "GRAM65k", a
+ *	run of painted pixels in a column is a run of consecutive words, so the atlas keeps
+ *	each character as a list of those runs instead of bits.
+ *
+ *	"PaintString()" works out how wide the string is first; if it's all on the screen
+ *	(which it nearly always is), the runs are copied straight in without checking each
+ *	one. If not, the rows that are off the screen are worked out once for the string
+ *	and each run is cut down to fit.
+ *
+ *	If there isn't room in the PSRAM for the runs, the atlas only has the widths and
+ *	"PaintString()" goes through the font table a bit at a time the old way.
+ */
+
+#define	GLYPHS		95								// ' ' to '~'
+
+struct glyph_run
 {
-	unsigned char	c;								// A single character
-	int				k;								// Loop counter
-	int				N;								// Next "X" position in pixels
+	uint8_t		col;								// Column in the character
+	uint8_t		row;								// First painted row
+	uint8_t		len;								// Number of rows painted
+};
 
-	N = x;											// "X" Coordinate
+struct glyph_atlas
+{
+	uint8_t		height;								// Rows in the font
+	uint8_t		width[GLYPHS];						// Columns in each character
+	uint16_t	first[GLYPHS + 1];					// First run of each character
+	glyph_run*	runs;								// "NULL" if there wasn't room
+};
 
-	for  ( k=0; k < 128; k++ )						// 128 character limit?
+static glyph_atlas	atlas12, atlas16, atlas20;
+static bool			atlasReady = false;
+
+
+/*
+ *	"BuildAtlas()" makes the atlas for one font. "end" is the value that marks the end of
+ *	a character in the font table. It goes through the table twice; first to count the
+ *	runs, then to fill them in (or just count them again if the memory for them couldn't
+ *	be had).
+ */
+
+template <typename T, int N>
+static void BuildAtlas ( glyph_atlas* atlas, const T ( *font )[N], int height, uint32_t end )
+{
+	int			g, k, j;							// Loop counters
+	int			pass;
+	int			count;
+	uint32_t	f;
+
+	atlas->height = height;
+	atlas->runs   = NULL;
+
+	for ( pass = 0; pass < 2; pass++ )
 	{
-		c = *( s + k );								// Next character
+		count = 0;
 
-		if ( c == 0 )								// NULL string terminator?
-			break;									// Yep, we're done
+		for ( g = 0; g < GLYPHS; g++ )
+		{
+			atlas->first[g] = count;
 
-		N = disp_chr12 ( c, N, y, color );			// Paint the character
-		N += 1;										// 1 pixel space?
+			for ( k = 0; k < N; k++ )
+			{
+				f = (uint32_t) font[g][k];
+
+				if ( height <= 16 )
+					f &= 0xFFFF;					// The tables are used as 16 bits
+
+				if ( f == end )
+					break;
+
+				for ( j = 0; j < height; j++ )
+				{
+					if ((( f >> j ) & 1 ) && ( j == 0 || !(( f >> ( j - 1 )) & 1 )))
+					{
+						if ( atlas->runs )
+						{
+							atlas->runs[count].col = k;
+							atlas->runs[count].row = j;
+							atlas->runs[count].len = 0;
+						}
+
+						count++;
+					}
+
+					if ((( f >> j ) & 1 ) && atlas->runs )
+						atlas->runs[count - 1].len++;
+				}
+			}
+
+			atlas->width[g] = k;
+		}
+
+		atlas->first[GLYPHS] = count;
+
+		if ( pass == 0 )
+			atlas->runs = (glyph_run*) ps_malloc ( count * sizeof ( glyph_run ));
 	}
 }
 
+static void BuildAtlases ( void )
+{
+	BuildAtlas ( &atlas12, font12, 12, 0x0fff );
+	BuildAtlas ( &atlas16, font16, 16, 0xffff );
+	BuildAtlas ( &atlas20, font20, 20, 0xfffff );
 
-void disp_str16 ( char *s, int x, int y, uint32_t color )	//Font16
+	atlasReady = true;
+}
+
+
+/*
+ *	"Glyph()" turns a character into an index in the atlas. Backslashes are painted as
+ *	spaces, and so is anything that isn't in the font.
+ */
+
+static inline int Glyph ( unsigned char c )
 {
-	unsigned char	c;								// A single character
-	int				k;								// Loop counter
-	int				N;								// Next "X" position in pixels
+	if ( c == '\\' || c < 0x20 || c >= 0x20 + GLYPHS )
+		return 0;
 
-	N = x;											// "X" Coordinate
+	return c - 0x20;
+}
 
-	for  ( k=0; k < 128; k++ )						// 128 character limit?
+
+/*
+ *	"StringWidth()" is how far "PaintString()" moves along for the string: each
+ *	character plus 2 pixels of space after it.
+ */
+
+static int StringWidth ( const glyph_atlas* atlas, const char* s )
+{
+	int		k;
+	int		width = 0;
+
+	for ( k = 0; k < 128 && s[k]; k++ )				// 128 character limit?
+		width += atlas->width[Glyph ( s[k] )] + 2;
+
+	return width;
+}
+
+
+/*
+ *	"PaintBits()" is what "PaintString()" does when the atlas has no runs. It paints "s"
+ *	from the font table, checking that each pixel is on the screen.
+ */
+
+template <typename T, int N>
+static int PaintBits ( const glyph_atlas* atlas, const T ( *font )[N], const char* s,
+						int x, int y, uint32_t color )
+{
+	int			k, col, j;							// Loop counters
+	int			g;									// Character in the atlas
+	uint32_t	f;
+	uint16_t	c65k = Color65k ( color );			// Only convert the color once
+
+	for ( k = 0; k < 128 && s[k]; k++ )				// 128 character limit?
 	{
-		c = *( s + k );								// Next character
+		g = Glyph ( s[k] );
 
-		if ( c == 0 )								// NULL string terminator?
-			break;									// Yep, we're done
+		for ( col = 0; col < atlas->width[g]; col++ )
+		{
+			f = (uint32_t) font[g][col];
 
-		N = disp_chr16 ( c, N, y, color );			// Paint the character
-		N += 1;										// 1 pixel space?
+			if ( x + col < 0 || x + col >= Nx )
+				continue;
+
+			for ( j = 0; j < atlas->height; j++ )
+			{
+				if ((( f >> j ) & 1 ) && y + j >= 0 && y + j < Ny )
+					GRAM65k[( x + col ) * Ny + y + j] = c65k;
+			}
+		}
+
+		x += atlas->width[g] + 2;					// 2 pixels between characters
 	}
+
+	return x;
 }
 
 
-void disp_str20 ( char *s, int x, int y, uint32_t color )	//Font20
+/*
+ *	"PaintString()" paints "s" with its top left corner at "x", "y" and returns the "x"
+ *	coordinate after it (including the space after the last character).
+ */
+
+static int PaintString ( const glyph_atlas* atlas, const char* s, int x, int y, uint32_t color )
 {
-	unsigned char	c;								// A single character
-	int				k;								// Loop counter
-	int				N;								// Next "X" position in pixels
+	int					k, r;							// Loop counters
+	int					g;								// Character in the atlas
+	int					col;
+	int					from, to;
+	int					top    = 0;						// Rows of the font that
+	int					bottom = atlas->height - 1;		// are on the screen
+	bool				inside;
+	uint16_t*			p;
+	uint16_t*			stop;
+	const glyph_run*	run;
+	uint16_t			c65k = Color65k ( color );		// Only convert the color once
+
+	if ( atlas->runs == NULL )							// No room for the atlas
+	{
+		if ( atlas->height == 12 )	return PaintBits ( atlas, font12, s, x, y, color );
+		if ( atlas->height == 16 )	return PaintBits ( atlas, font16, s, x, y, color );
 
-	N = x;											// "X" Coordinate
+		return PaintBits ( atlas, font20, s, x, y, color );
+	}
 
-	for  ( k=0; k < 128; k++ )						// 128 character limit?
+	if ( y < 0 )				top    = -y;
+	if ( y + bottom >= Ny )		bottom = Ny - 1 - y;
+
+	inside = ( x >= 0 ) && ( x + StringWidth ( atlas, s ) <= Nx )
+				&& ( top == 0 ) && ( bottom == atlas->height - 1 );
+
+	for ( k = 0; k < 128 && s[k]; k++ )					// 128 character limit?
 	{
-		c = *( s + k );								// Next character
+		g = Glyph ( s[k] );
 
-		if ( c == 0 )								// NULL string terminator?
-			break;									// Yep, we're done
+		for ( r = atlas->first[g]; r < atlas->first[g + 1]; r++ )
+		{
+			run  = &atlas->runs[r];
+			col  = x + run->col;
+			from = run->row;
+			to   = run->row + run->len - 1;
 
-		N = disp_chr20 ( c, N, y, color );			// Paint the character
-		N += 1;										// 1 pixel space?
+			if ( !inside )
+			{
+				if ( col < 0 || col >= Nx )
+					continue;
+
+				if ( from < top )		from = top;
+				if ( to > bottom )		to   = bottom;
+
+				if ( to < from )
+					continue;
+			}
+
+			p    = GRAM65k + col * Ny + y + from;
+			stop = p + ( to - from );
+
+			while ( p <= stop )
+				*p++ = c65k;
+		}
+
+		x += atlas->width[g] + 2;						// 2 pixels between characters
 	}
+
+	return x;
+}
+
+
+void disp_str12 ( char *s, int x, int y, uint32_t color )	// Font12
+{
+	int		N;										// Next "X" position in pixels
+
+	if ( !atlasReady )
+		BuildAtlases ();
+
+	N = PaintString ( &atlas12, s, x, y, color );
+
+	AddDamage ( x, y, N - 1, y + 11, DamageSig ( s, color ^ ( 12 << 24 )));
+}
+
+
+void disp_str16 ( char *s, int x, int y, uint32_t color )	//Font16
+{
+	int		N;										// Next "X" position in pixels
+
+	if ( !atlasReady )
+		BuildAtlases ();
+
+	N = PaintString ( &atlas16, s, x, y, color );
+
+	AddDamage ( x, y, N - 1, y + 15, DamageSig ( s, color ^ ( 16 << 24 )));
+}
+
+
+void disp_str20 ( char *s, int x, int y, uint32_t color )	//Font20
+{
+	int		N;										// Next "X" position in pixels
+
+	if ( !atlasReady )
+		BuildAtlases ();
+
+	N = PaintString ( &atlas20, s, x, y, color );
+
+	AddDamage ( x, y, N - 1, y + 19, DamageSig ( s, color ^ ( 20 << 24 )));
+}
+
+
+/*
+ *	These return the width of a string in pixels as "disp_str12()", etc. would paint
+ *	it, including the 2 pixels of space after the last character:
+ */
+
+int disp_width12 ( const char* s )
+{
+	if ( !atlasReady )
+		BuildAtlases ();
+
+	return StringWidth ( &atlas12, s );
+}
+
+
+int disp_width16 ( const char* s )
+{
+	if ( !atlasReady )
+		BuildAtlases ();
+
+	return StringWidth ( &atlas16, s );
+}
+
+
+int disp_width20 ( const char* s )
+{
+	if ( !atlasReady )
+		BuildAtlases ();
+
+	return StringWidth ( &atlas20, s );
 }
 
 
@@ -287,112 +562,42 @@ int disp_chr8 ( char c, int x, int y, uint32_t color )	// 5x7
 }
 
 
+/*
+ *	"disp_chr12()", "disp_chr16()" and "disp_chr20()" paint one character from the atlas
+ *	and return the "x" coordinate for the next one, less the 1 pixel of space that the
+ *	string functions used to add.
+ */
+
 int disp_chr12 ( char c, int x, int y, uint32_t color )		//Font12
 {
-	int 				k, j, yj;							// Loop indicies
-	unsigned short int	f12;								// Word from the font array
-
-	if ( c == '\\' )	c = ' ';							// Backslashes => spaces
-
-	for ( k = 0; k < 24; k++ )								// Font array index
-	{
-		f12 = (unsigned short int) font12[c-0x20][k];
+	char	s[2] = { c, 0 };
 
-		if ( f12 == 0x0fff)
-			break;
+	if ( !atlasReady )
+		BuildAtlases ();
 
-		if ( x >= 0 )
-		{
-			for ( j = 0; j < 12; j++ )						// Font height
-			{
-				yj = y + j;
-
-				if (( f12 &0x0001 ) == 0x0001)				// Low bit on?
-				{
-					if ( x >= 0 && x < Nx
-							&& yj >= 0 && yj < Ny )			// On the screen?
-						setPixel ( x, yj, color );
-				}
-
-				f12 >>= 1;				// Next bit
-			}
-		}
-
-		x++;							// Next "X" coordinate
-	}
-	return ( x + 1 );					// Add 1 and send it back
+	return PaintString ( &atlas12, s, x, y, color ) - 1;
 }
 
 
 int disp_chr16 ( char c, int x, int y, uint32_t color )	// Font 16
 {
-	int 				k, j, yj;						// Loop indicies
-	unsigned short int	f16;							// Word from the font array
+	char	s[2] = { c, 0 };
 
-	if ( c == '\\' )	c = ' ';						// Backslashes => spaces
-
-	for ( k = 0; k < 24; k ++ )							// Font array index
-	{
-		f16 = (unsigned short int) font16 [c-0x20][k];	// Get a word from the array
+	if ( !atlasReady )
+		BuildAtlases ();
 
-		if ( f16 == 0xffff )
-			break;
-
-		if ( x >= 0 )									// On the display?
-		{
-			for ( j = 0; j < 16; j++ )					// Font height
-			{
-				yj = y + j;
-
-				if (( f16 & 0x0001 ) == 0x0001 )		// low order bit on?
-				{
-					if ( x >= 0 && x < Nx				// Still on the screen
-							&& yj >= 0 && yj < Ny )
-						setPixel ( x, yj, color );
-				}
-
-				f16 >>= 1;						// Next bit
-			}
-		}
-		x++;									// Next "X" coordinate
-	}
-	return ( x + 1 );							// Add 1 more & return it
+	return PaintString ( &atlas16, s, x, y, color ) - 1;
 }
 
 
 int disp_chr20 ( char c, int x, int y, uint32_t color )		// Font20
-{	
-	int				k, j, yj;								// Loop indicies
-	unsigned long	f20;									// From the font array
-
-	if ( c == '\\' )	c = ' ';							// Backslashes => spaces
-
-	for ( k = 0; k < 24; k++ )								// Font array index
-	{
-		f20 = (unsigned long) font20[c-0x20][k];			// Get font for the character
-
-		if ( f20 == 0xfffff )
-			break;
-
-		if ( x >= 0 )										// On the display?
-		{
-			for ( j = 0; j < 20; j++ )						// Font height
-			{
-				yj = y + j;
+{
+	char	s[2] = { c, 0 };
 
-				if (( f20 & 0x00001) == 0x00001 )			// Low order bit on?
-				{
-					if ( x >= 0 && x < Nx					// Still on-screen?
-							&& yj >= 0 && yj < Ny )
-						setPixel ( x, yj, color );
-				}
+	if ( !atlasReady )
+		BuildAtlases ();
 
-				f20 >>= 1;					// Next bit
-			}
-		}
-		x++;								// Next "X" coordinate
-	}
-	return ( x + 1 );						// Add one & return it
+	return PaintString ( &atlas20, s, x, y, color ) - 1;
 }
 
 
@@ -416,7 +621,5 @@ unsigned char bitrev8 ( unsigned char x )
 
 void setPixel ( int x, int y, uint32_t color )
 {
-	R_GRAM[x][y] = ( color & 0xFF0000 ) >> 16;		// Set the individual RGB
-	G_GRAM[x][y] = ( color & 0x00FF00 ) >> 8;		// components in the 
-	B_GRAM[x][y] = ( color & 0x0000FF );			// appropriate arrays
+	GRAM65k[x * Ny + y] = Color65k ( color );		// Straight into the screen image
 }
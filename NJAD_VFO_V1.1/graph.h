@@ -11,7 +11,7 @@
 #ifndef _GRAPH_H_
 #define _GRAPH_H_     								// Avoid double include
 
-void ClearGRAM ( void );							// Clears the color arrays
+void ClearGRAM ( void );							// Clears the screen image
 void Line ( int, int, int, int, uint32_t );			// Draw a line
 void BoxFill ( int, int, int, int, uint32_t );		// Draw a filled box
 void Box ( int, int, int, int, uint32_t );			// Draw an un-filled box
@@ -21,6 +21,10 @@ void disp_str12 ( char*, int, int, uint32_t );		// various font sizes
 void disp_str16 ( char*, int, int, uint32_t );
 void disp_str20 ( char*, int, int, uint32_t );
 
+int disp_width12 ( const char* );					// Width of a string
+int disp_width16 ( const char* );					// in pixels
+int disp_width20 ( const char* );
+
 int disp_chr8	( char, int, int, uint32_t );		// Paint a single
 int disp_chr12	( char, int, int, uint32_t );		// character in
 int disp_chr16	( char, int, int, uint32_t );		// various font sizes
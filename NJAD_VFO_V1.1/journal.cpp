@@ -0,0 +1,399 @@
+/*
+ *	"journal.cpp"
+ *
+ *	"journal.cpp" saves what the radio is doing (band, frequencies, mode, frequency
+ *	increment, split and clarifier) in the flash, so it starts up where it was left
+ *	instead of on the first band in "bandData" every time. The EEPROM library is
+ *	really a block of flash too, and rewriting the same place every time something
+ *	changed would wear it out, so this works more like a log:
+ *
+ *		Each save is a new 24 byte record added after the last one, with a sequence
+ *		number and a CRC, so a record that was only partly written when the power
+ *		went off is just ignored.
+ *
+ *		"JOURNAL_SECTORS" 4K sectors of the "JOURNAL_PARTITION" partition are used
+ *		in turn. When one is full, the next one is erased and the latest record
+ *		for every band is copied to the start of it, then it carries on from
+ *		there. Each sector only gets erased once every "JOURNAL_SECTORS" times 170
+ *		saves.
+ *
+ *		Each sector starts with a header that has a CRC of the band edges in
+ *		"bandData"; if the bands are changed and the program loaded again, what
+ *		was saved for the old bands is ignored.
+ *
+ *	"JournalBegin()" reads all the records once at startup and remembers where the
+ *	latest one for each band is. The main program decides when to save (see
+ *	"SaveState()"); it waits until things have stopped changing for a while so
+ *	turning the knob doesn't write a record for every step.
+ *
+ *	Erasing a sector takes around 40mS on the ESP32, and neither core can run code
+ *	from the flash while it's going on, so the tuning stops for a moment once
+ *	every 170 or so saves.
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include <esp_partition.h>					// Flash partition access
+#include "config.h"							// User customization stuff
+#include "journal.h"						// Our function prototypes
+
+#if ( JOURNAL_SECTORS < 2 )
+	#error "JOURNAL_SECTORS" has to be at least 2
+#endif
+
+#define	MAGIC		0x314C4E4AUL			// "JNL1"
+#define	SECTOR		SPI_FLASH_SEC_SIZE		// 4K bytes
+#define	NO_RECORD	0xFFFF					// In "where"
+#define	JS_COPY		0x80					// In "flags"; copied to a new sector, not saved
+
+
+/*
+ *	The sector header and the records:
+ */
+
+struct journal_head
+{
+	uint32_t	magic;
+	uint32_t	seq;						// Sequence number (the highest is the newest)
+	uint32_t	bandsCrc;					// CRC of the band edges
+	uint32_t	crc;						// CRC of the above
+};
+
+struct journal_rec
+{
+	uint32_t		seq;					// Sequence number
+	journal_state	st;
+	uint16_t		spare;
+	uint16_t		crc;					// CRC of the above
+};
+
+#define	SLOTS		(( SECTOR - sizeof ( journal_head )) / sizeof ( journal_rec ))
+
+static const esp_partition_t*	part = NULL;	// The flash partition
+
+static uint8_t		nbrBands;				// Number of bands
+static uint32_t		bandsCrc;				// CRC of their edges
+static uint16_t		where[256];				// Where the latest record for each band is
+static int			last = -1;				// Band of the latest record
+static int			sector = -1;			// Sector being added to (-1 if none)
+static uint16_t		nextSlot = 0;			// Next free record in it
+static uint32_t		nextSeq  = 1;			// Next sequence number
+
+
+/*
+ *	"CRC16()" is the CRC-16/CCITT of "len" bytes, starting from "crc".
+ */
+
+static uint16_t CRC16 ( const void* data, size_t len, uint16_t crc = 0xFFFF )
+{
+	const uint8_t*	p = (const uint8_t*) data;
+
+	while ( len-- )
+	{
+		crc ^= *p++ << 8;
+
+		for ( int bit = 0; bit < 8; bit++ )
+			crc = ( crc & 0x8000 ) ? ( crc << 1 ) ^ 0x1021 : crc << 1;
+	}
+
+	return crc;
+}
+
+
+/*
+ *	Where things are in the partition, and reading them. A header is any good if its
+ *	CRC is right (whatever bands it was written for), and a record if its CRC is right
+ *	and it's for one of our bands.
+ */
+
+static size_t HeadAddr ( int sec )
+{
+	return sec * SECTOR;
+}
+
+static size_t RecAddr ( uint16_t slot )				// "slot" counts across all the sectors
+{
+	return ( slot / SLOTS ) * SECTOR + sizeof ( journal_head ) + ( slot % SLOTS ) * sizeof ( journal_rec );
+}
+
+static bool ReadHead ( int sec, journal_head* h )
+{
+	if ( esp_partition_read ( part, HeadAddr ( sec ), h, sizeof ( *h )) != ESP_OK )
+		return false;
+
+	return ( h->magic == MAGIC ) && ( h->crc == CRC16 ( h, offsetof ( journal_head, crc )));
+}
+
+static bool ReadRec ( uint16_t slot, journal_rec* r )
+{
+	if ( esp_partition_read ( part, RecAddr ( slot ), r, sizeof ( *r )) != ESP_OK )
+		return false;
+
+	return ( r->crc == CRC16 ( r, offsetof ( journal_rec, crc ))) && ( r->st.band < nbrBands );
+}
+
+static bool Erased ( const journal_rec* r )
+{
+	const uint8_t*	p = (const uint8_t*) r;
+
+	for ( size_t ix = 0; ix < sizeof ( *r ); ix++ )
+		if ( p[ix] != 0xFF )
+			return false;
+
+	return true;
+}
+
+
+/*
+ *	"JournalBegin()" finds the partition and reads what's in it. It returns "false"
+ *	if there's no partition to use or too many bands to fit in a sector.
+ */
+
+bool JournalBegin ( const band_data* bands, uint8_t count )
+{
+	journal_head	h;
+	journal_rec		r;
+	uint32_t		headSeq[JOURNAL_SECTORS];
+	uint32_t		newest = 0;
+
+	part = esp_partition_find_first ( ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+										JOURNAL_PARTITION );
+
+	if (( part == NULL ) || ( part->size < JOURNAL_SECTORS * SECTOR ) || ( count > SLOTS / 2 ))
+	{
+		Serial.println ( "\nCan't save the band and frequency settings" );
+		part = NULL;
+		return false;
+	}
+
+	nbrBands = count;
+	bandsCrc = CRC16 ( &count, 1 );
+
+	for ( int ix = 0; ix < count; ix++ )
+	{
+		bandsCrc = CRC16 ( &bands[ix].lowLimit, sizeof ( uint32_t ), bandsCrc );
+		bandsCrc = CRC16 ( &bands[ix].topLimit, sizeof ( uint32_t ), bandsCrc );
+	}
+
+	memset ( where, 0xFF, sizeof ( where ));
+	last     = -1;
+	sector   = -1;
+	nextSlot = 0;
+	nextSeq  = 1;
+
+
+/*
+ *	Sectors written for a different set of bands are erased, so that if the bands are
+ *	changed back again, what was saved before doesn't come back and replace what was
+ *	saved since. Their sequence numbers still count though; every record in a sector
+ *	comes after its header and before the next sector's, so none of them is more than
+ *	"SLOTS" past the header's.
+ */
+
+	for ( int sec = 0; sec < JOURNAL_SECTORS; sec++ )
+	{
+		headSeq[sec] = 0;
+
+		if ( !ReadHead ( sec, &h ))
+			continue;
+
+		if ( h.bandsCrc == bandsCrc )
+			headSeq[sec] = h.seq;
+
+		else
+		{
+			nextSeq = max ( nextSeq, (uint32_t) ( h.seq + SLOTS + 1 ));
+			esp_partition_erase_range ( part, HeadAddr ( sec ), SECTOR );
+		}
+	}
+
+
+/*
+ *	Go through the sectors oldest first, so each band ends up with its latest record.
+ *	The newest sector is the one to carry on adding to.
+ */
+
+	for ( int pass = 0; pass < JOURNAL_SECTORS; pass++ )
+	{
+		int		sec = -1;							// Oldest one not done yet
+
+		for ( int ix = 0; ix < JOURNAL_SECTORS; ix++ )
+			if ( headSeq[ix] && (( sec < 0 ) || ( headSeq[ix] < headSeq[sec] )))
+				sec = ix;
+
+		if ( sec < 0 )								// All done
+			break;
+
+		nextSeq  = max ( nextSeq, headSeq[sec] + 1 );
+		headSeq[sec] = 0;
+		sector   = sec;
+		nextSlot = SLOTS;
+
+		for ( uint16_t ix = 0; ix < SLOTS; ix++ )
+		{
+			uint16_t	slot = sec * SLOTS + ix;
+
+			if ( ReadRec ( slot, &r ))
+			{
+				where[r.st.band] = slot;
+				nextSeq = max ( nextSeq, r.seq + 1 );
+
+				if (( r.seq >= newest ) && !( r.st.flags & JS_COPY ))
+				{
+					newest = r.seq;
+					last   = r.st.band;
+				}
+			}
+
+			else if ( Erased ( &r ))				// End of what's been written
+			{
+				nextSlot = ix;
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+/*
+ *	"JournalBand()" gets the latest record for a band, and "JournalLast()" the latest
+ *	one for any band. They return "false" if there isn't one.
+ */
+
+bool JournalBand ( uint8_t band, journal_state* st )
+{
+	journal_rec		r;
+
+	if (( part == NULL ) || ( band >= nbrBands ) || ( where[band] == NO_RECORD ))
+		return false;
+
+	if ( !ReadRec ( where[band], &r ))
+		return false;
+
+	*st = r.st;
+	st->flags &= ~JS_COPY;
+	return true;
+}
+
+bool JournalLast ( journal_state* st )
+{
+	return ( last >= 0 ) && JournalBand ( last, st );
+}
+
+
+/*
+ *	"Write()" adds a record at "nextSlot". Copies made when starting a new sector are
+ *	marked so they aren't taken for the latest save.
+ */
+
+static bool Write ( const journal_state* st, bool copy = false )
+{
+	journal_rec		r;
+	uint16_t		slot = sector * SLOTS + nextSlot++;
+
+	memset ( &r, 0, sizeof ( r ));
+
+	r.seq          = nextSeq++;
+	r.st.rxFreq    = st->rxFreq;
+	r.st.txFreq    = st->txFreq;
+	r.st.clarCount = st->clarCount;
+	r.st.band      = st->band;
+	r.st.mode      = st->mode;
+	r.st.incr      = st->incr;
+	r.st.flags     = st->flags | ( copy ? JS_COPY : 0 );
+	r.crc          = CRC16 ( &r, offsetof ( journal_rec, crc ));
+
+	if ( esp_partition_write ( part, RecAddr ( slot ), &r, sizeof ( r )) != ESP_OK )
+		return false;
+
+	where[st->band] = slot;
+
+	if ( !copy )
+		last = st->band;
+
+	return true;
+}
+
+
+/*
+ *	"NextSector()" erases the next sector and copies the latest record for each
+ *	band into it. They're read before the erase in case the sector being erased
+ *	has the only copy of some of them (if the power went off while the last sector
+ *	was being started). The band that was saved last goes in last, as a save rather
+ *	than a copy, so it's still the latest save once the sector it was in is erased.
+ *
+ *	Nothing changes over to the new sector until it's been erased and has its header.
+ *	If that doesn't work, we carry on with the old one; it's still full, so the next
+ *	save tries again. Only the records that were in the erased sector are forgotten.
+ */
+
+static bool NextSector ( void )
+{
+	journal_state*	keep = (journal_state*) malloc ( nbrBands * sizeof ( journal_state ));
+	bool			ok   = true;
+	uint8_t			kept = 0;
+	int				next = ( sector + 1 ) % JOURNAL_SECTORS;
+	journal_head	h;
+
+	if ( keep == NULL )
+		return false;
+
+	for ( uint8_t band = 0; band < nbrBands; band++ )
+		if (( band != last ) && JournalBand ( band, &keep[kept] ))
+			kept++;
+
+	if (( last >= 0 ) && JournalBand ( last, &keep[kept] ))
+		kept++;
+
+	h.magic    = MAGIC;
+	h.seq      = nextSeq++;
+	h.bandsCrc = bandsCrc;
+	h.crc      = CRC16 ( &h, offsetof ( journal_head, crc ));
+
+	ok = ( esp_partition_erase_range ( part, HeadAddr ( next ), SECTOR ) == ESP_OK );
+
+	for ( int band = 0; band < nbrBands; band++ )		// Those records are gone now
+		if (( where[band] != NO_RECORD ) && ( where[band] / SLOTS == (uint16_t) next ))
+			where[band] = NO_RECORD;
+
+	ok = ok && ( esp_partition_write ( part, HeadAddr ( next ), &h, sizeof ( h )) == ESP_OK );
+
+	if ( ok )
+	{
+		sector   = next;
+		nextSlot = 0;
+	}
+
+	for ( uint8_t ix = 0; ok && ( ix < kept ); ix++ )
+		ok = Write ( &keep[ix], keep[ix].band != last );
+
+	free ( keep );
+
+	return ok;
+}
+
+
+/*
+ *	"JournalSave()" adds a record, unless it's the same as the last one.
+ */
+
+bool JournalSave ( const journal_state* st )
+{
+	journal_state	old;
+
+	if (( part == NULL ) || ( st->band >= nbrBands ))
+		return false;
+
+	if (( last == st->band ) && JournalLast ( &old )
+			&& ( old.rxFreq == st->rxFreq ) && ( old.txFreq == st->txFreq )
+			&& ( old.clarCount == st->clarCount ) && ( old.mode == st->mode )
+			&& ( old.incr == st->incr ) && ( old.flags == st->flags ))
+		return true;
+
+	if (( sector < 0 ) || ( nextSlot >= SLOTS ))
+		if ( !NextSector ())
+			return false;
+
+	return Write ( st );
+}
@@ -0,0 +1,45 @@
+/*
+ *	"journal.h"
+ *
+ *	"journal.h" contains the definitions and function prototypes for the "journal.cpp"
+ *	module, which saves the band, frequencies, mode, etc. in the flash so the radio
+ *	comes back where it was when it's turned on again.
+ */
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "band_data" and "JOURNAL_SECTORS"
+
+
+/*
+ *	What's saved for a band. The last one saved also says which band was in use
+ *	and the split and clarifier settings.
+ */
+
+struct journal_state
+{
+	uint32_t	rxFreq;					// VFO-A frequency
+	uint32_t	txFreq;					// VFO-B frequency
+	int16_t		clarCount;				// Clarifier offset (in 10Hz steps)
+	uint8_t		band;					// Index to "bandData"
+	uint8_t		mode;					// Index to "modeData"
+	uint8_t		incr;					// Index to "incrList"
+	uint8_t		flags;					// JS_SPLIT, etc.
+};
+
+#define	JS_SPLIT	0x01				// Split mode on
+#define	JS_CLAR		0x02				// Clarifier on
+
+
+/*
+ *	Function prototypes:
+ */
+
+bool JournalBegin ( const band_data* bands, uint8_t count );	// Find what's been saved
+bool JournalBand ( uint8_t band, journal_state* st );			// Last saved for a band
+bool JournalLast ( journal_state* st );							// Last saved for any band
+bool JournalSave ( const journal_state* st );					// Save a new one
+
+#endif
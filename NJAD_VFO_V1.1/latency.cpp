@@ -0,0 +1,251 @@
+/*
+ *	"latency.cpp"
+ *
+ *	"latency.cpp" times how long it takes from a step of the frequency encoder to the
+ *	new frequency getting to the Si5351 and to the new screen getting to the display,
+ *	so we can tell whether what limits the feel of the tuning is the Si5351 bus, the
+ *	painting or the SPI bus to the display.
+ *
+ *	The time of each step is the one the interrupt handler put on the event. A change
+ *	of frequency is timed from the oldest step that went into it, and goes two ways
+ *	from there:
+ *
+ *		"task0()" works out the VFO frequency ("LAT_VFO") and sends it to the Si5351
+ *		("LAT_SI5351").
+ *
+ *		"loop()" paints a screen with the new frequency on it ("LAT_DIAL", "LAT_PAINT")
+ *		and "task0()" sends it to the display ("LAT_SEND", "LAT_SENT"). If the
+ *		frequency changes again before the screen is painted, the screen is timed
+ *		from the oldest step it shows.
+ *
+ *	Everything is timed with "micros()" rather than the processor's cycle counter;
+ *	the two cores each have their own cycle counter and they don't agree, and the
+ *	times here go from one core to the other.
+ *
+ *	Each stage has a histogram with 4 buckets for every doubling of the time, which
+ *	is enough to get the 99th percentile to within 25%, plus the shortest, longest
+ *	and average times. Each stage is only ever updated from one core, so they don't
+ *	need locking. The times are printed by "LatencyDump()" when "#LT;" is sent on
+ *	the serial port (see "CheckLocal()" in the main program):
+ *
+ *		#LATENCY uS from the encoder step
+ *		<stage> <count> <min> <avg> <p99> <max>
+ *		#END
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include "config.h"							// User customization stuff
+#include "latency.h"						// Our function prototypes
+
+#if LATENCY_TRACE
+
+#define	BUCKETS		96						// Up to about 16 seconds
+
+struct lat_stage
+{
+	uint32_t	count;
+	uint32_t	min;
+	uint32_t	max;
+	uint64_t	total;
+	uint32_t	bucket[BUCKETS];
+};
+
+static lat_stage	stages[LAT_STAGES];
+
+static const char*	stageName[LAT_STAGES] =
+	{ "vfoFreq", "Si5351", "Dial", "Painted", "Sending", "Sent" };
+
+
+/*
+ *	Where each change is timed from. 0 means there's nothing to time. "stepUs" and
+ *	"tuneUs" only belong to "task0()", "frameUs" only to "loop()". The other two
+ *	pass a time from one to the other.
+ */
+
+static uint32_t		stepUs  = 0;			// Oldest step not in "rxFreq" yet
+static uint32_t		tuneUs  = 0;			// The steps in the new VFO frequency
+static uint32_t		paintUs = 0;			// The steps waiting to be painted
+static uint32_t		frameUs = 0;			// The steps in the screen being painted
+static uint32_t		readyUs = 0;			// The steps in the screen waiting to be sent
+static uint32_t		sendUs  = 0;			// The steps in the screen being sent
+
+
+/*
+ *	"Bucket()" works out which histogram bucket a time goes in, and "BucketTop()"
+ *	the longest time that goes in a bucket.
+ */
+
+static uint8_t Bucket ( uint32_t us )
+{
+	if ( us < 4 )
+		return us;
+
+	uint8_t		top = 31 - __builtin_clz ( us );		// Highest bit set (2 or more)
+	uint32_t	b   = 4 * ( top - 1 ) + (( us >> ( top - 2 )) & 3 );
+
+	return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+static uint32_t BucketTop ( uint8_t b )
+{
+	if ( b < 4 )
+		return b;
+
+	uint8_t		top = b / 4 + 1;
+
+	return ((( 4 + b % 4 ) + 1 ) << ( top - 2 )) - 1;
+}
+
+
+static void Record ( uint8_t stage, uint32_t fromUs )
+{
+	lat_stage&	s  = stages[stage];
+	uint32_t	us = micros () - fromUs;
+
+	if (( s.count == 0 ) || ( us < s.min ))
+		s.min = us;
+
+	if ( us > s.max )
+		s.max = us;
+
+	s.total += us;
+	s.bucket[Bucket ( us )]++;
+	s.count++;
+}
+
+
+/*
+ *	"LatencyStep()" is called by "task0()" for each step of the frequency encoder with
+ *	the time the interrupt handler saw it. Only the oldest one that hasn't got into
+ *	"rxFreq" yet is kept.
+ */
+
+void LatencyStep ( uint32_t us )
+{
+	if ( us == 0 )								// 0 means nothing to time
+		us = 1;
+
+	if ( stepUs == 0 )
+		stepUs = us;
+}
+
+
+/*
+ *	"LatencyNewFreq()" is called by "task0()" after it changes "rxFreq". The steps
+ *	are now waiting to get to the Si5351 and to be painted. "loop()" might be about to
+ *	paint, so "rxFreq" has to be changed before "paintUs" is set.
+ */
+
+void LatencyNewFreq ( void )
+{
+	if ( stepUs == 0 )
+		return;
+
+	tuneUs = stepUs;
+
+	uint32_t	none = 0;						// Keep the oldest one waiting
+
+	__atomic_compare_exchange_n ( &paintUs, &none, stepUs, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED );
+
+	stepUs = 0;
+}
+
+
+/*
+ *	"LatencyFrame()" is called by "loop()" before it looks at "rxFreq" to paint a
+ *	new screen.
+ */
+
+void LatencyFrame ( void )
+{
+	frameUs = __atomic_exchange_n ( &paintUs, 0, __ATOMIC_ACQUIRE );
+}
+
+
+/*
+ *	"LatencyMark()" records the time to one of the stages, if there was a frequency
+ *	change on its way through it.
+ */
+
+void LatencyMark ( uint8_t stage )
+{
+	switch ( stage )
+	{
+		case LAT_VFO:							// From "task0()"
+			if ( tuneUs )
+				Record ( stage, tuneUs );
+			break;
+
+		case LAT_SI5351:
+			if ( tuneUs )
+				Record ( stage, tuneUs );
+
+			tuneUs = 0;
+			break;
+
+		case LAT_DIAL:							// From "loop()"
+			if ( frameUs )
+				Record ( stage, frameUs );
+			break;
+
+		case LAT_PAINT:
+			if ( frameUs )
+				Record ( stage, frameUs );
+
+			__atomic_store_n ( &readyUs, frameUs, __ATOMIC_RELEASE );
+			frameUs = 0;
+			break;
+
+		case LAT_SEND:							// From "task0()"
+			sendUs = __atomic_exchange_n ( &readyUs, 0, __ATOMIC_ACQUIRE );
+
+			if ( sendUs )
+				Record ( stage, sendUs );
+			break;
+
+		case LAT_SENT:
+			if ( sendUs )
+				Record ( stage, sendUs );
+
+			sendUs = 0;
+			break;
+	}
+}
+
+
+/*
+ *	"LatencyDump()" prints the times and starts again. The stages "task0()" looks
+ *	after might change while they're being printed, so a line can be a little off.
+ */
+
+void LatencyDump ( void )
+{
+	Serial.printf ( "#LATENCY uS from the encoder step\n" );
+
+	for ( uint8_t ix = 0; ix < LAT_STAGES; ix++ )
+	{
+		lat_stage&	s   = stages[ix];
+		uint32_t	p99 = 0;
+		uint32_t	sum = 0;
+
+		for ( uint8_t b = 0; b < BUCKETS; b++ )
+		{
+			sum += s.bucket[b];
+
+			if ( sum * 100ULL >= s.count * 99ULL )
+			{
+				p99 = min ( BucketTop ( b ), s.max );
+				break;
+			}
+		}
+
+		Serial.printf ( "%-8s %7u %7u %7u %7u %7u\n", stageName[ix], s.count, s.min,
+							s.count ? (uint32_t) ( s.total / s.count ) : 0, p99, s.max );
+
+		memset ( &s, 0, sizeof ( s ));
+	}
+
+	Serial.printf ( "#END\n" );
+}
+
+#endif
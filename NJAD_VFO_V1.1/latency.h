@@ -0,0 +1,52 @@
+/*
+ *	"latency.h"
+ *
+ *	"latency.h" contains the definitions and function prototypes for the "latency.cpp"
+ *	module, which times how long it takes a turn of the tuning knob to get to the
+ *	Si5351 and onto the screen.
+ */
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "LATENCY_TRACE"
+
+
+/*
+ *	The stages that are timed. Each one is timed from the encoder step that caused it:
+ */
+
+#define	LAT_VFO			0				// "task0()" has the new VFO frequency
+#define	LAT_SI5351		1				// "Set_VFO_Freq()" has sent it to the Si5351
+#define	LAT_DIAL		2				// "loop()" has painted the dial with it
+#define	LAT_PAINT		3				// "loop()" has painted the whole screen
+#define	LAT_SEND		4				// "Transfer_Image()" has started sending it
+#define	LAT_SENT		5				// It's all on the display
+
+#define	LAT_STAGES		6
+
+
+/*
+ *	Function prototypes. With "LATENCY_TRACE" turned off, they don't do anything.
+ */
+
+#if LATENCY_TRACE
+
+void LatencyStep ( uint32_t us );		// "task0()" got an encoder step from time "us"
+void LatencyNewFreq ( void );			// "task0()" changed "rxFreq" for the steps
+void LatencyFrame ( void );				// "loop()" is starting to paint a screen
+void LatencyMark ( uint8_t stage );		// Got to one of the stages
+void LatencyDump ( void );				// Print the times on "Serial" and start again
+
+#else
+
+inline void LatencyStep ( uint32_t us ) {}
+inline void LatencyNewFreq ( void ) {}
+inline void LatencyFrame ( void ) {}
+inline void LatencyMark ( uint8_t stage ) {}
+inline void LatencyDump ( void ) {}
+
+#endif
+
+#endif
@@ -0,0 +1,279 @@
+/*
+ *	"sched.cpp"
+ *
+ *	"sched.cpp" runs the things "loop()" does every so often. Each of the functions
+ *	that read the band and mode switches, the buttons, the battery and CAT control
+ *	used to be called every time around "loop()" and compare "millis()" with the last
+ *	time it really did anything; now each one is a job with a period, and "loop()"
+ *	runs whatever is due and sleeps until the next one is (or something wakes it up
+ *	with "SchedWake()"). Core #1 then spends most of its time idle, and every job
+ *	runs on the same beat ("first", "first + period", and so on) instead of whenever
+ *	"loop()" happened to come round after it was due.
+ *
+ *	The jobs are kept in a timer wheel; one slot for each millisecond, "SCHED_WHEEL"
+ *	slots round. A job goes in the slot for the millisecond it's due, so finding what
+ *	to run only means looking at the slots for the milliseconds that have gone by
+ *	since last time, and the next job due is in the first slot after now that has
+ *	one in it. Jobs due more than "SCHED_WHEEL" milliseconds away go round more than
+ *	once, so their time is checked too. Jobs due at the same time run in the order
+ *	they were added.
+ *
+ *	A job with a period of 0 isn't on the wheel; it only runs when "SchedRunJob()" is
+ *	called (that's how "loop()" paints the screen, so that's timed with the others).
+ *
+ *	Each job's runs, average and longest times and how late it's been are kept, and
+ *	"SchedDump()" prints them when "#SC;" is sent on the serial port (see "CheckLocal()"
+ *	in the main program):
+ *
+ *		#SCHED <mS since the last one>
+ *		<job> <period> <runs> <avg uS> <max uS> <max late mS> <% of core #1>
+ *		#END <% of core #1 busy>
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include "config.h"							// User customization stuff
+#include "sched.h"							// Our function prototypes
+
+#if ( SCHED_WHEEL & ( SCHED_WHEEL - 1 ))
+	#error "SCHED_WHEEL" has to be a power of 2
+#endif
+
+#define	NONE		0xFF					// End of a slot's list
+
+struct sched_job
+{
+	const char*	name;
+	void		( *job )( void );
+	uint32_t	period;						// mS (0 if only run when asked)
+	uint32_t	due;						// "millis()" it's next due
+	uint8_t		next;						// Next job in the same slot
+
+	uint32_t	runs;						// Times it ran
+	uint64_t	totalUs;					// Time it took altogether
+	uint32_t	maxUs;						// Longest time it took
+	uint32_t	maxLate;					// Latest it's started (mS)
+};
+
+static sched_job	jobs[SCHED_JOBS];
+static uint8_t		nbrJobs = 0;
+
+static uint8_t		wheel[SCHED_WHEEL];		// First job in each slot
+static uint32_t		lastTick;				// Last millisecond looked at
+static bool			started = false;
+
+static TaskHandle_t	sleeper = NULL;			// The task to wake up ("loop()")
+static uint32_t		sinceMs;				// When the times were last cleared
+
+
+/*
+ *	"Insert()" puts a job in the slot for the time it's due.
+ */
+
+static void Insert ( uint8_t ix )
+{
+	uint8_t&	slot = wheel[jobs[ix].due & ( SCHED_WHEEL - 1 )];
+
+	jobs[ix].next = slot;
+	slot = ix;
+}
+
+
+/*
+ *	"SchedAdd()" adds a job that runs every "period" milliseconds, starting "first"
+ *	milliseconds from now. It returns the job's number for "SchedRunJob()", or -1 if
+ *	there are already "SCHED_JOBS" of them.
+ */
+
+int SchedAdd ( const char* name, void ( *job )( void ), uint32_t period, uint32_t first )
+{
+	if ( !started )
+	{
+		memset ( wheel, NONE, sizeof ( wheel ));
+		lastTick = millis () - 1;					// So jobs can be due now
+		sinceMs  = lastTick;
+		started  = true;
+	}
+
+	if ( nbrJobs >= SCHED_JOBS )
+	{
+		Serial.printf ( "Too many jobs for the scheduler; \"%s\" won't run\n", name );
+		return -1;
+	}
+
+	sched_job&	j = jobs[nbrJobs];
+
+	memset ( &j, 0, sizeof ( j ));
+
+	j.name   = name;
+	j.job    = job;
+	j.period = period;
+	j.due    = millis () + first;
+
+	if ((int32_t) ( j.due - lastTick ) <= 0 )		// Its slot has been looked at
+		j.due = lastTick + 1;
+
+	if ( period )
+		Insert ( nbrJobs );
+
+	return nbrJobs++;
+}
+
+
+/*
+ *	"Run()" runs a job and keeps track of the time it took.
+ */
+
+static void Run ( uint8_t ix, uint32_t late )
+{
+	sched_job&	j = jobs[ix];
+	uint32_t	start = micros ();
+
+	j.job ();
+
+	uint32_t	us = micros () - start;
+
+	j.runs++;
+	j.totalUs += us;
+	j.maxUs    = max ( j.maxUs, us );
+	j.maxLate  = max ( j.maxLate, late );
+}
+
+void SchedRunJob ( int job )
+{
+	if (( job >= 0 ) && ( job < nbrJobs ))
+		Run ( job, 0 );
+}
+
+
+/*
+ *	"SchedRun()" runs every job that's due. It takes the ones that are due out of
+ *	the slots for the milliseconds since last time (all of them if it's been round
+ *	the wheel), runs them in order and puts them back for their next time. A job
+ *	that's missed some of its times altogether skips them but stays on its beat.
+ */
+
+void SchedRun ( void )
+{
+	uint32_t	now   = millis ();
+	uint32_t	ticks = min ( now - lastTick, (uint32_t) SCHED_WHEEL );
+	uint8_t		ready[SCHED_JOBS];
+	uint8_t		count = 0;
+
+	for ( uint32_t t = 1; t <= ticks; t++ )
+	{
+		uint8_t*	link = &wheel[( lastTick + t ) & ( SCHED_WHEEL - 1 )];
+
+		while ( *link != NONE )
+		{
+			uint8_t		ix = *link;
+
+			if ((int32_t) ( jobs[ix].due - now ) > 0 )		// Not this time round
+			{
+				link = &jobs[ix].next;
+				continue;
+			}
+
+			*link = jobs[ix].next;							// Take it out
+
+			int		pos = count++;							// And keep them in order
+
+			for ( ; ( pos > 0 ) && ( ready[pos - 1] > ix ); pos-- )
+				ready[pos] = ready[pos - 1];
+
+			ready[pos] = ix;
+		}
+	}
+
+	lastTick = now;
+
+	for ( uint8_t r = 0; r < count; r++ )
+	{
+		sched_job&	j    = jobs[ready[r]];
+		uint32_t	late = now - j.due;
+
+		Run ( ready[r], late );
+
+		j.due += ( late / j.period + 1 ) * j.period;		// Next time after now
+		Insert ( ready[r] );
+	}
+}
+
+
+/*
+ *	"SchedSleep()" is called by "loop()" when it has nothing to do. It sleeps until
+ *	the next job is due, or until "SchedWake()" is called. If nothing is due for a
+ *	whole turn of the wheel, it comes back after that.
+ */
+
+void SchedSleep ( void )
+{
+	uint32_t	next = lastTick + SCHED_WHEEL;		// If nothing's due before then
+
+	if ( sleeper == NULL )
+		sleeper = xTaskGetCurrentTaskHandle ();
+
+	for ( uint32_t tick = lastTick + 1; tick != next; tick++ )
+	{
+		uint8_t		ix = wheel[tick & ( SCHED_WHEEL - 1 )];
+
+		while (( ix != NONE ) && ((int32_t) ( jobs[ix].due - tick ) > 0 ))	// Later time round
+			ix = jobs[ix].next;
+
+		if ( ix != NONE )
+		{
+			next = tick;
+			break;
+		}
+	}
+
+	int32_t		wait = next - millis ();
+
+	if ( wait > 0 )
+		ulTaskNotifyTake ( pdTRUE, pdMS_TO_TICKS ( wait ));
+}
+
+
+/*
+ *	"SchedWake()" wakes "loop()" up; "task0()" calls it when there's a new screen to
+ *	paint.
+ */
+
+void SchedWake ( void )
+{
+	if ( sleeper )
+		xTaskNotifyGive ( sleeper );
+}
+
+
+/*
+ *	"SchedDump()" prints the times for each job and starts again. The percentages
+ *	are of the time since the last "SchedDump()".
+ */
+
+void SchedDump ( void )
+{
+	uint32_t	ms   = millis () - sinceMs;
+	uint64_t	busy = 0;
+
+	Serial.printf ( "#SCHED %u\n", ms );
+
+	for ( uint8_t ix = 0; ix < nbrJobs; ix++ )
+	{
+		sched_job&	j = jobs[ix];
+
+		Serial.printf ( "%-10s %6u %7u %7u %7u %5u %6.2f\n", j.name, j.period, j.runs,
+						j.runs ? (uint32_t) ( j.totalUs / j.runs ) : 0, j.maxUs, j.maxLate,
+						ms ? j.totalUs / ( 10.0 * ms ) : 0 );
+
+		busy += j.totalUs;
+
+		j.runs    = 0;
+		j.totalUs = 0;
+		j.maxUs   = 0;
+		j.maxLate = 0;
+	}
+
+	Serial.printf ( "#END %.2f\n", ms ? busy / ( 10.0 * ms ) : 0 );
+
+	sinceMs = millis ();
+}
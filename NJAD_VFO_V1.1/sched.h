@@ -0,0 +1,27 @@
+/*
+ *	"sched.h"
+ *
+ *	"sched.h" contains the function prototypes for the "sched.cpp" module, which runs
+ *	the jobs "loop()" does every so often (reading the switches, CAT control, etc.)
+ *	when they're due and lets "loop()" sleep in between.
+ */
+
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "SCHED_JOBS"
+
+
+/*
+ *	Function prototypes:
+ */
+
+int	 SchedAdd ( const char* name, void ( *job )( void ), uint32_t period, uint32_t first = 0 );
+void SchedRun ( void );					// Run the jobs that are due
+void SchedRunJob ( int job );			// Run one now
+void SchedSleep ( void );				// Sleep until the next job is due or "SchedWake()"
+void SchedWake ( void );				// Wake "loop()" up
+void SchedDump ( void );				// Print the times on "Serial" and start again
+
+#endif
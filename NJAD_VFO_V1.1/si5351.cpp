@@ -37,6 +37,7 @@
 #include <Arduino.h>						// General Arduino definitions
 #include "config.h"							// Configuration definitions
 #include "si5351.h"							// Si5351 stuff
+#include <soc/gpio_struct.h>				// The ESP32 GPIO registers
 
 volatile uint32_t oMf = 0;
 volatile uint32_t oMc = 0;
@@ -44,10 +45,115 @@ volatile uint32_t oMc = 0;
 static	 uint32_t xFreq = SI_XTAL;			// Default to setting in "config.h"
 static	 int32_t  xtalCorr;					// Crystal correction factor
 
+
+/*
+ *	The correction factor is in parts per billion. Rather than correct every frequency
+ *	we're asked for, "DoTheMath" uses the crystal frequency the correction implies,
+ *	which is "xtalDen / xtalNum" Hz. "SetXtalFreq" and "SetCorrection" work it out.
+ */
+
+static	 uint64_t xtalNum = 1000000000ULL;					// 1e9 + correction
+static	 uint64_t xtalDen = SI_XTAL * 1000000000ULL;		// Nominal crystal frequency * 1e9
+
+
+/*
+ *	"DoTheMath" remembers the "M" and "R" it used last for each of the outputs in
+ *	these unless the caller gives it a plan of its own.
+ */
+
+static	 SI_plan  vfoPlan;
+static	 SI_plan  carrierPlan;
+
+
+/*
+ *	We keep a copy of what we've written to each of the Si5351 registers, so that
+ *	"upd_si5351" only has to send the ones that are changing. Most of the time when
+ *	the frequency changes, only a few of the PLL-B registers are different. Until a
+ *	register has been written, "regKnown" says we don't know what's in it.
+ */
+
+static	 uint8_t  regShadow[256];			// What we last wrote to each register
+static	 uint8_t  regKnown[256 / 8];		// One bit per register
+
+/*
+ *	The Si5351 bus is "bit-banged"; the program wiggles the pins itself. Doing that with
+ *	"digitalWrite()" and "delayMicroseconds()" is a lot slower than it needs to be, so
+ *	the pins are set and cleared directly with the ESP32's GPIO "write 1 to set" and
+ *	"write 1 to clear" registers and the timing is done by counting processor clock
+ *	cycles. "SetSDA()", "SetSCL()" and "BusWait()" are the only things that know
+ *	about that, and on the host the GPIO registers are simulated so the pin changes
+ *	can be recorded and checked.
+ *
+ *	The times (in nanoseconds) come from the I2C specification for the speed selected
+ *	by "SI_I2C_SPEED" in "config.h", with a little to spare:
+ *
+ *		low		Minimum time SCL is LOW (and the data set up time is less than that)
+ *		high	Minimum time SCL is HIGH
+ *		start	SDA going LOW to SCL going LOW for a START
+ *		stop	SCL going HIGH to SDA going HIGH for a STOP
+ *		idle	Bus free time between a STOP and the next START
+ *
+ *	"low" + "high" is never less than one cycle at the rated clock speed.
+ */
+
+typedef struct
+{
+	uint16_t	low;
+	uint16_t	high;
+	uint16_t	start;
+	uint16_t	stop;
+	uint16_t	idle;
+} bus_timing;
+
+static const bus_timing busTiming[] =
+{
+	{ 5000, 5000, 4200, 4200, 5000 },			// SI_I2C_STANDARD (100KHz)
+	{ 1500, 1000,  700,  700, 1500 }			// SI_I2C_FAST (400KHz)
+};
+
+static const bus_timing& bus = busTiming[SI_I2C_SPEED];
+
+static uint32_t cpuMHz;							// Processor clock (for "BusWait()")
+
+static inline void SetSDA ( uint8_t level )
+{
+	#if SI_SDA < 32
+		if ( level )	GPIO.out_w1ts = 1UL << SI_SDA;
+		else			GPIO.out_w1tc = 1UL << SI_SDA;
+	#else
+		if ( level )	GPIO.out1_w1ts.val = 1UL << ( SI_SDA - 32 );
+		else			GPIO.out1_w1tc.val = 1UL << ( SI_SDA - 32 );
+	#endif
+}
+
+static inline void SetSCL ( uint8_t level )
+{
+	#if SI_SCL < 32
+		if ( level )	GPIO.out_w1ts = 1UL << SI_SCL;
+		else			GPIO.out_w1tc = 1UL << SI_SCL;
+	#else
+		if ( level )	GPIO.out1_w1ts.val = 1UL << ( SI_SCL - 32 );
+		else			GPIO.out1_w1tc.val = 1UL << ( SI_SCL - 32 );
+	#endif
+}
+
+static inline void BusWait ( uint32_t ns )
+{
+	uint32_t start  = ESP.getCycleCount ();
+	uint32_t cycles = ( ns * cpuMHz + 999 ) / 1000;
+
+	while (( ESP.getCycleCount () - start ) < cycles )
+		;
+}
+
+
 /*
  *	wr_I2C sends a byte of data to the Si5351. The bits are sent in order from
  *	the high order bit (0x80) to the low order bit (0x01). In other words, it
  *	is basically a  parallel to serial converter.
+ *
+ *	SCL is LOW coming in and going out. Each bit is put on SDA just after SCL goes
+ *	LOW and stays there until after SCL has been HIGH.
  */
 
 void wr_I2C ( uint8_t d )
@@ -56,28 +162,60 @@ void wr_I2C ( uint8_t d )
 
 	for ( k = 0; k < 8; k++ )					// One bit at a time
 	{
-        if ( d & 0x80 )							// Is the current bit a '1'?
-			digitalWrite ( SI_SDA, HIGH );		// Yes, then send a '1'
- 
-		else
-			digitalWrite ( SI_SDA, LOW );		// Otherwise send a '0'
+		SetSDA ( d & 0x80 );						// Send the current bit
+		BusWait ( bus.low );
+
+		SetSCL ( HIGH );							// Clock the bit into the Si5351
+		BusWait ( bus.high );
+		SetSCL ( LOW );
+
+		d <<= 1;								// Next bit please!
+	}
 
-		delayMicroseconds ( 1 );				// Timeout
+	SetSDA ( LOW );								// One final pulse on the clock
+	BusWait ( bus.low );							// for the acknowledge bit
+	SetSCL ( HIGH );
+	BusWait ( bus.high );
+	SetSCL ( LOW );
+}
 
-		digitalWrite ( SI_SCL, HIGH );			// Clock the bit into the Si5351
-		delayMicroseconds ( 1 );
 
-		digitalWrite ( SI_SCL, LOW );			// Pulsing the clock pin
-		delayMicroseconds ( 1 );
+/*
+ *	"blk_si5351" sends "count" bytes from "d" to a block of consecutive Si5351
+ *	registers starting at "reg_No" in one transaction; the Si5351 moves on to the
+ *	next register by itself after each byte. The PLL and multisynth parameters are
+ *	8 register blocks, so this takes a lot less time than sending them one at a
+ *	time and the Si5351 has a half-changed configuration for less time.
+ */
 
-        digitalWrite ( SI_SDA, LOW );			// Data pin back to a LOW
+void blk_si5351 ( uint8_t reg_No, const uint8_t* d, uint8_t count )
+{
+	int	k;										// Loop counter
 
-		d <<= 1;								// Next bit please!
+	SetSDA ( LOW );								// START; SDA goes LOW while
+	BusWait ( bus.start );							// SCL is HIGH
+
+	SetSCL ( LOW );								// and then the clock pin LOW
+
+	wr_I2C ( SI_I2C_ADDR << 1 );				// Send I2C Address
+	wr_I2C ( reg_No );							// Select the first register
+
+	for ( k = 0; k < count; k++ )
+	{
+		wr_I2C ( d[k] );						// Send the data bytes
+
+		regShadow[reg_No + k] = d[k];			// Remember what's in there now
+		regKnown[( reg_No + k ) >> 3] |= 1 << (( reg_No + k ) & 7 );
 	}
 
-	digitalWrite ( SI_SCL, HIGH );				// One final pulse on the clock
-	delayMicroseconds ( 1 );    
-	digitalWrite ( SI_SCL, LOW );       
+	SetSDA ( LOW );								// STOP; SDA goes HIGH while
+	BusWait ( bus.low );							// SCL is HIGH
+
+	SetSCL ( HIGH );
+	BusWait ( bus.stop );
+
+	SetSDA ( HIGH );
+	BusWait ( bus.idle );							// Bus has to rest before the next one
 }
 
 
@@ -89,23 +227,71 @@ void wr_I2C ( uint8_t d )
 
 void cmd_si5351 ( uint8_t reg_No, uint8_t d )
 {
-	digitalWrite ( SI_SDA, LOW );				// Start with the data pin LOW
-	delayMicroseconds ( 1 );
+	blk_si5351 ( reg_No, &d, 1 );
+}
 
-	digitalWrite ( SI_SCL, LOW );				// and the clock pin LOW
-	delayMicroseconds ( 1 );
 
-	wr_I2C ( SI_I2C_ADDR << 1 );				// Send I2C Address
-	wr_I2C ( reg_No );							// Select the proper register
-	wr_I2C ( d );								// Send the command byte
+/*
+ *	"upd_si5351" is the same as "cmd_si5351" except it doesn't bother sending the
+ *	data if the register already has that value in it. It must not be used for
+ *	registers that do something every time they're written, like the PLL reset
+ *	register (177).
+ */
+
+static inline bool Known ( int reg_No, uint8_t d )
+{
+	return ( regKnown[reg_No >> 3] & ( 1 << ( reg_No & 7 ))) && ( regShadow[reg_No] == d );
+}
 
-	delayMicroseconds ( 1 );
+void upd_si5351 ( uint8_t reg_No, uint8_t d )
+{
+	if ( Known ( reg_No, d ))
+		return;									// Already there
+
+	cmd_si5351 ( reg_No, d );
+}
+
+
+/*
+ *	"upd_blk_si5351" does the same for a block of registers; only the part of the
+ *	block from the first register that's different to the last one that's different
+ *	gets sent (in one transaction).
+ */
+
+void upd_blk_si5351 ( uint8_t reg_No, const uint8_t* d, uint8_t count )
+{
+	int	first = 0;								// First one that changed
+	int	last  = count - 1;						// And the last one
+
+	while (( first < count ) && Known ( reg_No + first, d[first] ))
+		first++;
+
+	if ( first == count )						// None of them changed
+		return;
 
-	digitalWrite ( SI_SCL, HIGH );				// Stop the transaction
-	delayMicroseconds ( 1 );
+	while ( Known ( reg_No + last, d[last] ))
+		last--;
 
-	digitalWrite ( SI_SDA, HIGH );
-	delayMicroseconds ( 10 );					// Bigger delay here
+	blk_si5351 ( reg_No + first, d + first, last - first + 1 );
+}
+
+
+/*
+ *	"PackParams" puts "P1", "P2" and "P3" into the 8 register format used for
+ *	both the PLL and the multisynth parameters. For the multisynths, "extra" has
+ *	the "R" divider and "DIVBY4" bits that share a register with "P1[17:16]".
+ */
+
+static void PackParams ( uint8_t* blk, uint32_t P1, uint32_t P2, uint32_t P3, uint8_t extra )
+{
+	blk[0] = ( P3 >> 8 ) & 0xFF;						// Px_P3[15:8]
+	blk[1] = P3 & 0xFF;									// Px_P3[7:0]
+	blk[2] = extra | (( P1 >> 16 ) & 0x03 );			// Rx_DIV[2:0], MSx_DIVBY4[1:0], Px_P1[17:16]
+	blk[3] = ( P1 >> 8 ) & 0xFF;						// Px_P1[15:8]
+	blk[4] = P1 & 0xFF;									// Px_P1[7:0]
+	blk[5] = (( P3 >> 12 ) & 0xF0 ) | (( P2 >> 16 ) & 0x0F );	// Px_P3[19:16], Px_P2[19:16]
+	blk[6] = ( P2 >> 8 ) & 0xFF;						// Px_P2[15:8]
+	blk[7] = P2 & 0xFF;									// Px_P2[7:0]
 }
 
 
@@ -116,6 +302,7 @@ void cmd_si5351 ( uint8_t reg_No, uint8_t d )
 void SetCorrection ( int32_t corr )
 {
 	xtalCorr = corr;
+	xtalNum  = 1000000000LL + xtalCorr;
 }
 
 
@@ -127,7 +314,8 @@ void SetCorrection ( int32_t corr )
 
 void SetXtalFreq ( uint32_t freq )
 {
-	xFreq = freq;
+	xFreq   = freq;
+	xtalDen = xFreq * 1000000000ULL;
 }
 
 
@@ -153,20 +341,21 @@ void SetXtalFreq ( uint32_t freq )
 
 void Set_Carrier_Freq ( uint32_t freq, uint8_t MODE, enum clk_drive dr, uint8_t RST )
 {
-	int		k;										// Loop counter
+	uint8_t	outputs;								// Output enable register value
+	uint8_t	regs[16];								// Register blocks
 	SI_math	SI = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };		// All the calculation variables
 
 	if ( MODE )										// Oscillator mode (non-zero = enabled)
 	{
-		cmd_si5351 ( 16, ( 0x4C | dr ));			// CLK0 control register
-		cmd_si5351 ( 17, ( 0x4C | dr ));			// CLK1 control register
+		upd_si5351 ( 16, ( 0x4C | dr ));			// CLK0 control register
 
 		if ( MODE == C_OSC_QUAD_R )					// Invert CLK1?
-		{
-			cmd_si5351 ( 17, 0x5C | dr );			// Yes - Different CLK1 register value
- 		}
+			upd_si5351 ( 17, 0x5C | dr );			// Yes - Different CLK1 register value
+
+		else
+			upd_si5351 ( 17, ( 0x4C | dr ));		// CLK1 control register
 
-		freq = DoTheMath ( freq, &SI );				// Get adjusted frequency and set all the 
+		freq = DoTheMath ( freq, &SI, &carrierPlan );	// Get adjusted frequency and set all the 
 													// computational variables
 													
 /*
@@ -178,71 +367,27 @@ void Set_Carrier_Freq ( uint32_t freq, uint8_t MODE, enum clk_drive dr, uint8_t
  *		Use ClockBuilder Desktop Software to Determine These Register Values.
  */
 
-		cmd_si5351 ( 26, ( SI.P3 >> 8 ) & 0xFF );			//MSNA_P3[15:8]
-		cmd_si5351 ( 27, SI.P3 & 0xFF );					//MSNA_P3[7:0]
-		cmd_si5351 ( 28, ( SI.P1 >> 16 ) & 0x03 );			//MSNA_P1[17:16]
-		cmd_si5351 ( 29, ( SI.P1 >>  8 ) & 0xFF );			//MSNA_P1[15:8]
-		cmd_si5351 ( 30, SI.P1 & 0xFF );					//MSNA_P1[7:0]
-		cmd_si5351 ( 31, ( SI.P3 >> 12 ) & 0xF0
-						| ( SI.P2 >> 16 ) & 0x0F );			//MSNA_P3[19:16], MSNA_P2[19:16]
-		cmd_si5351 ( 32, ( SI.P2 >> 8 ) & 0xFF );			//MSNA_P2[15:8]
-		cmd_si5351 ( 33, SI.P2 & 0xFF );					//MSNA_P2[7:0]
+		PackParams ( regs, SI.P1, SI.P2, SI.P3, 0 );		// MSNA_P1, P2 & P3
+		upd_blk_si5351 ( 26, regs, 8 );						// Registers 26 - 33
 
 
 /*
- *	Set MS0 & MS1
+ *	Set MS0 & MS1 (registers 42 - 49 and 50 - 57, which we send together)
  *
  *		a=M, b=0, c=1 ---> P1=128*M-512, P2=0, P3=1
  */
 
 		if ( SI.M == 4 )
-		{
-			SI.P1=0;
-			cmd_si5351 ( 42, 0 );					//MS0_P3[15:8]
-			cmd_si5351 ( 43, 1 );					//MS0_P3[7:0]
-			cmd_si5351 ( 44, 0b00001100 );			//0, R0_DIV[2:0], MS0_DIVBY4[1:0], MS0_P1[17:16]
-			cmd_si5351 ( 45, 0 );					//MS0_P1[15:8]
-			cmd_si5351 ( 46, 0 );					//MS0_P1[7:0]
-			cmd_si5351 ( 47, 0 );					//MS0_P3[19:16], MS0_P2[19:16]
-			cmd_si5351 ( 48, 0 );					//MS0_P2[15:8]
-			cmd_si5351 ( 49, 0 );					//MS0_P2[7:0]
-
-			cmd_si5351 ( 50, 0 );					//MS1_P3[15:8]
-			cmd_si5351 ( 51, 1 );					//MS1_P3[7:0]
-			cmd_si5351 ( 52, 0b00001100 );			//0, R1_DIV[2:0], MS1_DIVBY4[1:0], MS1_P1[17:16]
-			cmd_si5351 ( 53, 0 );					//MS1_P1[15:8]
-			cmd_si5351 ( 54, 0 );					//MS1_P1[7:0]
-			cmd_si5351 ( 55, 0 );					//MS1_P3[19:16], MS0_P2[19:16]
-			cmd_si5351 ( 56, 0 );					//MS1_P2[15:8]
-			cmd_si5351 ( 57, 0 );					//MS1_P2[7:0]	
-		}
+			PackParams ( regs, 0, 0, 1, 0b00001100 );		// MS0_DIVBY4 = 11
 
-		else											// SI.M != 4
-		{
-			SI.P1 = 128 * SI.M - 512;
-			cmd_si5351 ( 42, 0 );						//MS0_P3[15:8]
-			cmd_si5351 ( 43, 1 );						//MS0_P3[7:0]
-			cmd_si5351 ( 44, ( SI.R << 4 )
-				& 0x70 | ( SI.P1 >> 16 ) & 0x03 );		//0, R0_DIV[2:0], MS0_DIVBY4[1:0], MS0_P1[17:16]
-			cmd_si5351 ( 45, ( SI.P1 >> 8 ) & 0xFF );	//MS0_P1[15:8]
-			cmd_si5351 ( 46, SI.P1 & 0xFF );			//MS0_P1[7:0]
-			cmd_si5351 ( 47, 0 );						//MS0_P3[19:16], MS0_P2[19:16]
-			cmd_si5351 ( 48, 0 );						//MS0_P2[15:8]
-			cmd_si5351 ( 49, 0 );						//MS0_P2[7:0]
-
-			cmd_si5351 ( 50, 0 );						//MS1_P3[15:8]
-			cmd_si5351 ( 51, 1 );						//MS1_P3[7:0]
-			cmd_si5351 ( 52, ( SI.R << 4 )
-				& 0x70 | ( SI.P1 >> 16 ) & 0x03 );		//0, R1_DIV[2:0], MS1_DIVBY4[1:0], MS1_P1[17:16]
-			cmd_si5351 ( 53, ( SI.P1 >> 8 ) & 0xFF );	//MS1_P1[15:8]
-			cmd_si5351 ( 54, SI.P1 & 0xFF );			//MS1_P1[7:0]
-			cmd_si5351 ( 55, 0 );						//MS1_P3[19:16], MS0_P2[19:16]
-			cmd_si5351 ( 56, 0 );						//MS1_P2[15:8]
-			cmd_si5351 ( 57, 0 );						//MS1_P2[7:0]
-		}
+		else												// SI.M != 4
+			PackParams ( regs, 128 * SI.M - 512, 0, 1, ( SI.R << 4 ) & 0x70 );	// R0_DIV
+
+		memcpy ( regs + 8, regs, 8 );						// MS1 is the same as MS0
+		upd_blk_si5351 ( 42, regs, 16 );
 
-		cmd_si5351 ( 165, 0 );							// CLK0 Initial Phase Offset
-		cmd_si5351 ( 166, SI.M );						// CLK1 Initial Phase Offset
+		upd_si5351 ( 165, 0 );							// CLK0 Initial Phase Offset
+		upd_si5351 ( 166, SI.M );						// CLK1 Initial Phase Offset
 
 		if( (oMc != SI.M ) || ( RST == 1 ))
 		{
@@ -260,13 +405,15 @@ void Set_Carrier_Freq ( uint32_t freq, uint8_t MODE, enum clk_drive dr, uint8_t
  */
 
 
-	cmd_si5351 ( 3, 0x00 );							// Enable all clocks
+	outputs = 0x00;									// Enable all clocks
 
 	if ( MODE == C_OSC_CLK0 )						// Carrier oscillator on CLK0 Only?
-		cmd_si5351 ( 3, 0x02 );						// Yes, then turn off CLK1
+		outputs = 0x02;								// Yes, then turn off CLK1
 
 	if ( MODE == C_OSC_CLK1 )						// CLK1 Only?
-		cmd_si5351 ( 3, 0x01 );						// Yes, then turn off CLK0
+		outputs = 0x01;								// Yes, then turn off CLK0
+
+	upd_si5351 ( 3, outputs );						// Only sent if it changed
 
 }													// End of "Set_Carrier_Freq"
 
@@ -290,13 +437,16 @@ void Set_Carrier_Freq ( uint32_t freq, uint8_t MODE, enum clk_drive dr, uint8_t
  *	I'll try to consolidate once I have my Si5351 hooked up.
  */
 
-void Set_VFO_Freq ( uint32_t freq, enum clk_drive )
+void Set_VFO_Freq ( uint32_t freq, enum clk_drive, SI_plan* plan )
 {
-	int			k;									// Loop counter
+	uint8_t		regs[8];							// Register block
 
 	SI_math	SI = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };		// All the calculation variables
 
-	freq = DoTheMath ( freq, &SI );					// Get adjusted frequency and
+	if ( plan == NULL )								// Caller doesn't keep one
+		plan = &vfoPlan;
+
+	freq = DoTheMath ( freq, &SI, plan );			// Get adjusted frequency and
 													// Set all the computational
 													// variables
 
@@ -310,49 +460,23 @@ void Set_VFO_Freq ( uint32_t freq, enum clk_drive )
  *		Use ClockBuilder Desktop Software to Determine These Register Values.
  */
 
-	cmd_si5351 ( 34, ( SI.P3 >> 8 ) & 0xFF);			//MSNB_P3[15:8]
-	cmd_si5351 ( 35, SI.P3 & 0xFF );					//MSNB_P3[7:0]
-	cmd_si5351 ( 36, ( SI.P1 >> 16 ) & 0x03 );			//MSNB_P1[17:16]
-	cmd_si5351 ( 37,( SI.P1 >>  8 ) & 0xFF );			//MSNB_P1[15:8]
-	cmd_si5351 ( 38, SI.P1 & 0xFF );					//MSNB_P1[7:0]
-	cmd_si5351 ( 39, ( SI.P3 >> 12 ) & 0xF0
-				| ( SI.P2 >> 16 ) & 0x0F );				//MSNB_P3[19:16], MSNB_P2[19:16]
-	cmd_si5351 ( 40, ( SI.P2 >> 8 ) & 0xFF );			//MSNB_P2[15:8]
-	cmd_si5351 ( 41, SI.P2 & 0xFF );					//MSNB_P2[7:0]
+	PackParams ( regs, SI.P1, SI.P2, SI.P3, 0 );		// MSNB_P1, P2 & P3
+	upd_blk_si5351 ( 34, regs, 8 );						// Registers 34 - 41
 
 
 /*
- *	Set MS2
+ *	Set MS2 (registers 58 - 65)
  *
  *		a=M, b=0, c=1 ---> P1=128*M-512, P2=0, P3=1
  */
 
 	if ( SI.M == 4 )
-	{
-		SI.P1 = 0;
-		cmd_si5351 ( 58, 0 );                   	//MS2_P3[15:8]
-		cmd_si5351 ( 59, 1 );						//MS2_P3[7:0]
-		cmd_si5351 ( 60, 0b00001100 );				//0, R0_DIV[2:0], MS2_DIVBY4[1:0], MS2_P1[17:16]
-		cmd_si5351 ( 61, 0 );						//MS2_P1[15:8]
-		cmd_si5351 ( 62, 0 );						//MS2_P1[7:0]
-		cmd_si5351 ( 63, 0 );						//MS2_P3[19:16], MS2_P2[19:16]
-		cmd_si5351 ( 64, 0 );						//MS2_P2[15:8]
-		cmd_si5351 ( 65, 0 );						//MS2_P2[7:0]
-	}
+		PackParams ( regs, 0, 0, 1, 0b00001100 );			// MS2_DIVBY4 = 11
 
 	else											// M != 4
-	{
-        SI.P1 = 128 * SI.M - 512;
-		cmd_si5351 ( 58, 0 );						//MS2_P3[15:8]
-		cmd_si5351 ( 59, 1 );						//MS2_P3[7:0]
-		cmd_si5351 (60, (SI.R << 4 ) & 0x70
-				| ( SI.P1 >> 16 ) & 0x03 );			//0, R0_DIV[2:0], MS2_DIVBY4[1:0], MS2_P1[17:16]
-		cmd_si5351 ( 61, ( SI.P1 >> 8 ) & 0xFF );	//MS2_P1[15:8]
-		cmd_si5351 ( 62, SI.P1 & 0xFF);				//MS2_P1[7:0]
-		cmd_si5351 ( 63, 0 );						//MS2_P3[19:16], MS2_P2[19:16]
-		cmd_si5351 ( 64, 0 );						//MS2_P2[15:8]
-		cmd_si5351 ( 65, 0 );						//MS2_P2[7:0]
-	}
+		PackParams ( regs, 128 * SI.M - 512, 0, 1, ( SI.R << 4 ) & 0x70 );	// R2_DIV
+
+	upd_blk_si5351 ( 58, regs, 8 );
 
 	if ( oMf != SI.M )
 	{
@@ -375,8 +499,12 @@ void Si5351_Init ( enum clk_drive dr )
 	digitalWrite ( SI_SDA, HIGH );					// Both HIGH to begin
 	digitalWrite ( SI_SCL, HIGH );
 
+	cpuMHz = ESP.getCpuFreqMHz ();					// For the bus timing
+
 	delay ( 10 );
 
+	memset ( regKnown, 0, sizeof ( regKnown ));		// Don't know what's in any of them
+
 	cmd_si5351 ( 183, 0b10010010 );					// CL = 8pF
 	cmd_si5351 ( 16, 0x80 );						// Disable CLK0
 	cmd_si5351 ( 17, 0x80 );						// Disable CLK1
@@ -398,23 +526,166 @@ void Si5351_Init ( enum clk_drive dr )
  *
  *		It returns the modified frequency and sets the values of all the 
  *		parameters needed to program the Si5351 in the structure.
+ *
+ *	It's all done in integers now. The float version lost the bottom few bits of "b"
+ *	above a few MHz, which is a few tenths of a Hz at the output. Now "b" is always the
+ *	closest it can be to the exact answer.
+ *
+ *	The table sets the values of "M" and "R" which are used to manipulate the real
+ *	frequency into what the Si5351 needs to be fed to produce it. Each entry is good
+ *	for frequencies from "lowest" up to (but not including) the "lowest" of the
+ *	entry above it.
+ */
+
+typedef struct
+{
+	uint32_t	lowest;
+	uint16_t	M;
+	uint8_t		R;
+} mr_range;
+
+static const mr_range mrRange[] =
+{
+	{ 150000001,    4, 0 },				// Over 150.0 MHz
+	{  63000000,    6, 0 },				//  63.0 MHz
+	{  27500000,   14, 0 },				//  27.5 MHz
+	{  13000000,   30, 0 },				//	13.0 MHz
+	{   6500000,   62, 0 },				//	 6.5 MHz
+	{   3000000,  126, 0 },				//	 3.0 MHz
+	{   1500000,  280, 0 },				//	 1.5 MHz
+	{    700000,  600, 0 },				// 700.0 KHz
+	{    330000, 1280, 0 },				// 330.0 KHz
+	{    150000, 1300, 1 },				// 150.0 KHz
+	{     67000, 1500, 2 },				//  67.0 KHz
+	{     30300, 1600, 3 },				//  30.3 KHz
+	{     14000, 1800, 4 },				//  14.0 KHz
+	{      7000, 1800, 5 },				//   7.0 KHz
+	{      3500, 1800, 6 },				//	 3.5 KHz
+	{         0, 1800, 7 }				// None of the above!
+};
+
+
+/*
+ *	"SetPlan" looks up "M" and "R" for a frequency and fills in the plan:
  */
 
-uint32_t DoTheMath ( uint32_t freq, SI_math* params )
+static void SetPlan ( uint32_t freq, SI_plan* plan )
 {
+	uint32_t	high = 280000000;					// Top of the first range
+
+	for ( uint8_t ix = 0; ix < sizeof ( mrRange ) / sizeof ( mrRange[0] ); ix++ )
+	{
+		if ( freq >= mrRange[ix].lowest )
+		{
+			plan->low  = mrRange[ix].lowest;
+			plan->high = high;
+			plan->M    = mrRange[ix].M;
+			plan->R    = mrRange[ix].R;
+			plan->mult = (uint32_t) plan->M << plan->R;
+			return;
+		}
+
+		high = mrRange[ix].lowest - 1;				// Top of the next one down
+	}
+}
+
 
 /*
- *	Local variables used to compute "M" and "R". The final results will
- *	be copied to the "freqData" structure.
+ *	"SetBandPlan" finds one "M" and "R" that will do for every frequency from "low"
+ *	to "high" without taking the PLL outside the 600 to 900MHz range it's specified
+ *	for. It picks the biggest "M" it can with the smallest "R", which puts the top
+ *	of the band as close to 900MHz as it will go. "M" has to be even (for integer
+ *	mode) and no more than 1800; 4 is only allowed for outputs over 150MHz.
+ *
+ *	The plan covers everything that keeps the PLL in range, which is usually a
+ *	bit more than the band. If nothing fits (a band wider than about 3 to 2), the
+ *	plan is left for "DoTheMath" to fill in and it returns "false".
  */
 
-	uint32_t	M;				// Used in converting the frequency into
-	uint32_t	R;				// What the Si5351 needs to set it
+#define	VCO_MIN		600000000ULL
+#define	VCO_MAX		900000000ULL
+
+bool SetBandPlan ( uint32_t low, uint32_t high, SI_plan* plan )
+{
+	memset ( plan, 0, sizeof ( SI_plan ));
+
+	if (( low == 0 ) || ( low > high ))
+		return false;
+
+	for ( uint8_t R = 0; R <= 7; R++ )
+	{
+		uint64_t	M = VCO_MAX / ((uint64_t) high << R );	// Highest "M" for the top
+
+		M &= ~1ULL;									// Make it even
+
+		if ( M > 1800 )
+			M = 1800;
 
-	freq = freq + (int32_t) (((( ((int64_t)xtalCorr) << 31 ) / 1000000000LL ) * freq ) >> 31 );
+		if (( M < 4 ) || (( M == 4 ) && ( low <= 150000000 )))
+			return false;							// Too high for the Si5351
 
-//	Serial.print ( "\nCalculated frequency is: " );
-//	Serial.println ( freq );
+		if ((( low * M ) << R ) < VCO_MIN )			// Bottom of the band too low?
+			continue;								// Try dividing by more
+
+		plan->M     = M;
+		plan->R     = R;
+		plan->mult  = M << R;
+		plan->low   = ( VCO_MIN + plan->mult - 1 ) / plan->mult;
+		plan->high  = VCO_MAX / plan->mult;
+		plan->fixed = true;
+
+		return true;
+	}
+
+	return false;
+}
+
+
+/*
+ *	"Fraction" returns "num * c / den" rounded to the nearest whole number, where "c" is
+ *	0xFFFFF and "num" is less than "den". "num * c" doesn't fit in 64 bits, so it's done
+ *	by long division, one bit at a time. That's quicker than a 64 bit divide on the
+ *	ESP32 anyway.
+ */
+
+static uint32_t Fraction ( uint64_t num, uint64_t den )
+{
+	uint64_t	rem = num;
+	uint32_t	q   = 0;
+
+	for ( uint8_t bit = 0; bit < 20; bit++ )		// q = num * 2^20 / den
+	{
+		rem <<= 1;
+		q   <<= 1;
+
+		if ( rem >= den )
+		{
+			rem -= den;
+			q |= 1;
+		}
+	}
+
+	if ( rem >= num )								// num * ( 2^20 - 1 ) is "num" less
+		rem -= num;
+
+	else
+	{
+		rem += den - num;
+		q--;
+	}
+
+	if ( rem >= den - rem )							// Round up if half or more is left
+		q++;
+
+	return q;
+}
+
+
+uint32_t DoTheMath ( uint32_t freq, SI_math* params, SI_plan* plan )
+{
+	uint64_t	num;						// Exact multisynth ratio is "num / xtalDen"
+	uint64_t	rem;
+	SI_plan		spare;
 
 	if ( freq < 1500 )
 		freq=1500;
@@ -422,46 +693,43 @@ uint32_t DoTheMath ( uint32_t freq, SI_math* params )
 	else if ( freq > 280000000 )
 		freq=280000000;
 
-/*
- *	This chain of comparisons sets the values of "M" and "R" which are used
- *	to manipulate the real frequency into what the Si5351 needs to be fed
- *	to produce it. This same sequence is used in "Set_VFO_Freq()", so it is one
- *	candidate for consolidation.
- */
+	if (( freq < plan->low ) || ( freq > plan->high ))		// Need a different "M" and "R"?
+	{
+		if ( plan->fixed )						// Outside the band's plan
+		{
+			SetPlan ( freq, &spare );			// Use the table, but keep the band's plan
+			plan = &spare;
+		}
+
+		else
+			SetPlan ( freq, plan );
+	}
+
+	params->M = plan->M;				// Update the structure	
+	params->R = plan->R;
+
+	freq *= plan->mult;					// Multiply frequency by "M" and shift left by "R"
 
-	if		( freq > 150000000 ) { M =    4; R = 0; }	// 150.0 MHz
-	else if ( freq >= 63000000 ) { M =    6; R = 0; }	//  63.0 MHz
-	else if ( freq >= 27500000 ) { M =   14; R = 0; }	//  27.5 MHz
-	else if ( freq >= 13000000 ) { M =   30; R = 0; }	//	13.0 MHz
-	else if ( freq >=  6500000 ) { M =   62; R = 0; }	//	 6.5 MHz
-	else if ( freq >=  3000000 ) { M =  126; R = 0; }	//	 3.0 MHz
-	else if ( freq >=  1500000 ) { M =  280; R = 0; }	//	 1.5 MHz
-	else if ( freq >=   700000 ) { M =  600; R = 0; }	// 700.0 KHz
-	else if ( freq >=   330000 ) { M = 1280; R = 0; }	// 330.0 KHz
-	else if ( freq >=   150000 ) { M = 1300; R = 1; }	// 150.0 KHz
-	else if ( freq >=    67000 ) { M = 1500; R = 2; }	//  67.0 KHz
-	else if ( freq >=    30300 ) { M = 1600; R = 3; }	//  30.3 KHz
-	else if ( freq >=    14000 ) { M = 1800; R = 4; }	//  14.0 KHz
-	else if ( freq >=     7000 ) { M = 1800; R = 5; }	//   7.0 KHz
-	else if ( freq >=     3500 ) { M = 1800; R = 6; }	//	 3.5 KHz
-	else						 { M = 1800; R = 7; }	// None of the above!
-
-    freq  *= M;					// Multiply frequency by "M"
-    freq <<= R;					// and shift left by "R"
-
-	params->M = M;				// Update the structure	
-	params->R = R;
 
 /*
- *	More calculations that I won't understand until I memorize the datasheet!
- *
- *	But again, these same computations are performed in "Set_VFO_Freq()".
+ *	The PLL has to run at "freq" times the nominal crystal frequency over the corrected
+ *	one; that's "a + b / c" times the crystal frequency.
  */
 
+	num = (uint64_t) freq * xtalNum;
+
 	params->c = 0xFFFFF;
-	params->a = freq / xFreq;			// Adjusted frequency/crystal frequency
+	params->a = num / xtalDen;			// Adjusted frequency/crystal frequency
+
+	rem = num - params->a * xtalDen;
+	params->b = Fraction ( rem, xtalDen );
+
+	if ( params->b == params->c )		// Rounded all the way up
+	{
+		params->a++;
+		params->b = 0;
+	}
 
-	params->b = (long) ( (float) ( freq-params->a*xFreq ) * (float) params->c / (float) xFreq );
 	params->dd = ( 128 * params->b ) / params->c;
 	params->P1 = 128 * params->a + params->dd - 512;
 	params->P2 = 128 * params->b - params->c * params->dd;
@@ -36,12 +36,37 @@ typedef struct
 	uint32_t	P3;
 } SI_math;
 
+
+/*
+ *	"M" and "R" only change when the frequency moves into a different range, so
+ *	"DoTheMath" keeps the ones it picked in an "SI_plan" along with the range of
+ *	frequencies they're good for, and only looks them up again when the frequency
+ *	goes outside that range. The VFO program keeps one for each band.
+ *
+ *	Changing "M" means resetting the PLL, which clicks. "SetBandPlan" picks one "M"
+ *	and "R" that work for a whole band and marks the plan "fixed" so it's kept; only
+ *	the PLL's fractional part changes as the band is tuned.
+ */
+
+typedef struct
+{
+	uint32_t	low;				// Lowest frequency the plan covers
+	uint32_t	high;				// Highest frequency the plan covers
+	uint32_t	mult;				// M << R
+	uint16_t	M;
+	uint8_t		R;
+	uint8_t		fixed;				// Set by "SetBandPlan"
+} SI_plan;
+
 enum clk_drive { CLK_DRIVE_2MA, CLK_DRIVE_4MA, CLK_DRIVE_6MA, CLK_DRIVE_8MA };
 
 void Si5351_Init ( enum clk_drive dr = CLK_DRIVE_8MA );
-void Set_VFO_Freq ( uint32_t freq, enum clk_drive dr = CLK_DRIVE_8MA );
+void Set_VFO_Freq ( uint32_t freq, enum clk_drive dr = CLK_DRIVE_8MA, SI_plan* plan = NULL );
 void Set_Carrier_Freq ( uint32_t freq, uint8_t MODE, enum clk_drive dr = CLK_DRIVE_8MA, uint8_t RST = 0 );
-uint32_t DoTheMath ( uint32_t freq, SI_math* params );
+uint32_t DoTheMath ( uint32_t freq, SI_math* params, SI_plan* plan );
+bool SetBandPlan ( uint32_t low, uint32_t high, SI_plan* plan );
+
+
 void SetXtalFreq ( uint32_t freq );
 void SetCorrection ( int32_t corr );
 #endif
@@ -0,0 +1,496 @@
+/*
+ *	"text.cpp"
+ *
+ *	"text.cpp" looks after the text on the screen that's painted in the same place
+ *	every time; the VFO frequencies, the "[A]" and "[B]", the TX/RX indicators, the
+ *	clarifier offset, the mode, "SPLIT" and the battery voltage. Each of those is a
+ *	"field" that remembers where it is, what font and color it's in and what it said.
+ *
+ *	Painting a screen used to mean clearing the whole thing and painting every string
+ *	again, even though most of the time the only text that changes is the last couple
+ *	of digits of VFO-A. Now "PaintScreen()" goes like this:
+ *
+ *		"TextField()"	Each field is told what it says on this screen
+ *		"TextBlock()"	Anything else that's painted and can change (the dial and the
+ *						underline) says where it is
+ *		"TextClear()"	Clears the screen, except for the characters that are already
+ *						there and don't change
+ *		...				The dial, boxes, etc. are painted
+ *		"TextPaint()"	Each field paints the characters that weren't kept
+ *
+ *	There are two copies of the screen image (see "display.cpp"), and the one being
+ *	painted has the screen from two times ago in it, not the last one. So each field
+ *	remembers what it looked like in each copy ("shown"), and compares what it says
+ *	now with what's in the copy being painted.
+ *
+ *	A character is only kept if it's the same character in the same place, font and
+ *	color, it's all on the screen and nothing else is painted on top of it; so nothing
+ *	under a block (on this screen or the last one in this copy), and nothing in a field
+ *	that overlaps another field. Everything else is cleared and painted, so the screen
+ *	comes out exactly the same as it would be if it was all painted from scratch.
+ *
+ *	The fields still tell "AddDamage()" exactly what "disp_str12()", etc. used to, so
+ *	the parts of the screen that get sent to the display are the same as before.
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include "config.h"							// User customization stuff
+#include "display.h"						// Defines "Nx" and "Ny"
+#include "graph.h"							// For painting the characters
+#include "damage.h"							// Tracks what changed on the screen
+#include "text.h"							// Our function prototypes
+
+extern uint16_t*  GRAM65k;					// The screen image
+
+
+/*
+ *	What's in each copy of the screen image:
+ */
+
+struct text_screen
+{
+	uint16_t*	image;						// Which copy it is
+	damage_rect	block[TEXT_BLOCKS];			// Where other things were painted
+	int			blocks;
+};
+
+static text_screen	screens[2];
+static int			lastScreen = 0;			// The one painted last
+
+static damage_rect	block[TEXT_BLOCKS];		// Blocks for this screen
+static int			blocks = 0;
+
+static text_field*	fields    = NULL;		// Every field that's been used
+static uint32_t		textFrame = 1;			// Screen being set up ("frame" starts at 0)
+
+uint32_t	textKept    = 0;				// Characters kept and painted (for
+uint32_t	textPainted = 0;				// the benchmark)
+
+
+/*
+ *	"CellWidth()" is how far the string functions move along for character "c" in
+ *	font "size"; the character plus the space after it. The "size" of a font is also
+ *	the number of rows it takes up.
+ */
+
+static int CellWidth ( int size, char c )
+{
+	char	s[2] = { c, 0 };
+
+	if ( size == 12 )	return disp_width12 ( s );
+	if ( size == 16 )	return disp_width16 ( s );
+	if ( size == 20 )	return disp_width20 ( s );
+
+	return 6;										// 5x7 font plus 1 space
+}
+
+
+/*
+ *	"Overlap()" says whether two rectangles have any pixels in common, and "Extent()"
+ *	is the rectangle a field covers on a screen.
+ */
+
+static bool Overlap ( const damage_rect& a, const damage_rect& b )
+{
+	return a.x_min <= b.x_max && b.x_min <= a.x_max
+		&& a.y_min <= b.y_max && b.y_min <= a.y_max;
+}
+
+static damage_rect Extent ( const text_look& look )
+{
+	damage_rect	r;
+
+	r.x_min = look.x;		r.y_min = look.y;
+	r.x_max = look.x_max;	r.y_max = look.y + look.size - 1;
+
+	return r;
+}
+
+
+/*
+ *	"TextChanged()" is true if "key" (whatever the field's string is made from, like
+ *	the frequency) isn't what it was last time, so the caller only has to build the
+ *	string in "field->text" again when it's going to be different.
+ */
+
+bool TextChanged ( text_field* field, uint32_t key )
+{
+	if ( field->keyed && ( field->key == key ))
+		return false;
+
+	field->key   = key;
+	field->keyed = true;
+
+	return true;
+}
+
+
+/*
+ *	"TextField()" says what a field says on the screen being set up; string "s" in font
+ *	"size" (8, 12, 16 or 20) with its top left corner at "x", "y". Fields that aren't
+ *	set for a screen aren't on it. A field has to stay around (make it "static") once
+ *	it's been used.
+ */
+
+void TextField ( text_field* field, const char* s, int x, int y, int size, uint32_t color )
+{
+	text_look*	now = &field->now;
+	int			k;
+	int			width = 0;
+
+	if ( field->frame == 0 )						// First time?
+	{
+		field->next = fields;						// Add it to the list
+		fields = field;
+	}
+
+	for ( k = 0; k < TEXT_LEN - 1 && s[k]; k++ )
+	{
+		now->str[k] = s[k];
+		width += CellWidth ( size, s[k] );
+	}
+
+	now->str[k] = 0;
+	now->x      = x;
+	now->y      = y;
+	now->x_max  = x + width - 1;
+	now->size   = size;
+	now->color  = color;
+
+	field->frame = textFrame;
+}
+
+
+/*
+ *	"TextBlock()" says that something other than a field is painted in the rectangle
+ *	on the screen being set up and might not be the same next time, so none of the
+ *	text under it can be kept. If there are too many, nothing is kept.
+ */
+
+void TextBlock ( int x_min, int y_min, int x_max, int y_max )
+{
+	if ( blocks >= TEXT_BLOCKS )
+	{
+		x_min = 0;		y_min = 0;					// Make the last one
+		x_max = Nx - 1;	y_max = Ny - 1;				// the whole screen
+		blocks = TEXT_BLOCKS - 1;
+	}
+
+	block[blocks].x_min = min ( x_min, x_max );	block[blocks].y_min = min ( y_min, y_max );
+	block[blocks].x_max = max ( x_min, x_max );	block[blocks].y_max = max ( y_min, y_max );
+	blocks++;
+}
+
+
+/*
+ *	"Matching()" works out which characters in a field are the same as what's in the
+ *	copy "scr" of the screen image; same character, same place. Each bit in the result
+ *	is one character in "field->now".
+ */
+
+static uint32_t Matching ( text_field* field, int scr )
+{
+	const text_look*	now = &field->now;
+	const text_look*	old = &field->shown[scr];
+	uint32_t			match = 0;
+	int					in = 0, io = 0;				// Characters in each
+	int					xn = now->x, xo = old->x;	// and where they are
+
+	if ( !now->size || ( now->size != old->size )
+			|| ( now->y != old->y ) || ( now->color != old->color ))
+		return 0;
+
+	while ( now->str[in] && old->str[io] )
+	{
+		if ( xn == xo )
+		{
+			if ( now->str[in] == old->str[io] )
+				match |= 1UL << in;
+
+			xn += CellWidth ( now->size, now->str[in++] );
+			xo += CellWidth ( old->size, old->str[io++] );
+		}
+
+		else if ( xn < xo )
+			xn += CellWidth ( now->size, now->str[in++] );
+
+		else
+			xo += CellWidth ( old->size, old->str[io++] );
+	}
+
+	return match;
+}
+
+
+/*
+ *	"Blocked()" is true if there's anything else painted on the screen in "r", now or
+ *	the last time copy "scr" of the screen image was painted, or if "r" isn't all on
+ *	the screen.
+ */
+
+static bool Blocked ( const damage_rect& r, int scr )
+{
+	int		k;
+
+	if ( r.x_min < 0 || r.y_min < 0 || r.x_max >= Nx || r.y_max >= Ny )
+		return true;
+
+	for ( k = 0; k < blocks; k++ )
+		if ( Overlap ( r, block[k] ))
+			return true;
+
+	for ( k = 0; k < screens[scr].blocks; k++ )
+		if ( Overlap ( r, screens[scr].block[k] ))
+			return true;
+
+	return false;
+}
+
+
+/*
+ *	"Crowded()" is true if any other field is, or was, on top of "field" in copy "scr"
+ *	of the screen image.
+ */
+
+static bool Crowded ( text_field* field, int scr )
+{
+	damage_rect	now = Extent ( field->now );
+	damage_rect	old = Extent ( field->shown[scr] );
+	text_field*	other;
+
+	for ( other = fields; other; other = other->next )
+	{
+		if ( other == field )
+			continue;
+
+		if ( other->now.size && ( Overlap ( now, Extent ( other->now ))
+								|| Overlap ( old, Extent ( other->now ))))
+			return true;
+
+		if ( other->shown[scr].size && ( Overlap ( now, Extent ( other->shown[scr] ))
+										|| Overlap ( old, Extent ( other->shown[scr] ))))
+			return true;
+	}
+
+	return false;
+}
+
+
+/*
+ *	"TextClear()" is called once all the fields and blocks have been set for a screen.
+ *	It works out which characters can be kept and paints the rest of the screen in
+ *	"color" (it's what "BoxFill()" on the whole screen used to do). After this, the
+ *	fields have to be painted with "TextPaint()".
+ */
+
+void TextClear ( uint32_t color )
+{
+	text_field*	field;
+	damage_rect	kept[TEXT_KEPT];					// Where the characters are kept
+	damage_rect	r;
+	int			count = 0;							// Number of those
+	int			runs;
+	int			scr;								// Copy being painted
+	int			k, j, x, y;
+	uint16_t*	p;
+	uint16_t	c65k = Color65k ( color );			// Only convert the color once
+
+	if ( screens[0].image == GRAM65k )
+		scr = 0;
+
+	else if ( screens[1].image == GRAM65k )
+		scr = 1;
+
+	else											// Don't know what's in it
+	{
+		scr = lastScreen ^ 1;
+		screens[scr].image  = GRAM65k;
+		screens[scr].blocks = 0;
+
+		for ( field = fields; field; field = field->next )
+			field->shown[scr].size = 0;
+	}
+
+	lastScreen = scr;
+
+
+/*
+ *	Work out what's kept. Each run of kept characters in a field is one rectangle.
+ */
+
+	for ( field = fields; field; field = field->next )
+	{
+		if ( field->frame != textFrame )			// Not on this screen
+		{
+			field->now.str[0] = 0;
+			field->now.size   = 0;
+		}
+
+		field->keep = 0;
+
+		if ( !TEXT_RETAIN || !field->now.size )
+			continue;
+
+		field->keep = Matching ( field, scr );
+
+		if ( field->keep && Crowded ( field, scr ))
+			field->keep = 0;
+
+		x    = field->now.x;
+		r.y_min = field->now.y;
+		r.y_max = field->now.y + field->now.size - 1;
+		runs = count;
+
+		for ( k = 0; field->now.str[k]; k++ )
+		{
+			r.x_min = x;
+			r.x_max = x + CellWidth ( field->now.size, field->now.str[k] ) - 1;
+			x = r.x_max + 1;
+
+			if ( !( field->keep & ( 1UL << k )))
+				continue;
+
+			if ( Blocked ( r, scr ))
+			{
+				field->keep &= ~( 1UL << k );
+				continue;
+			}
+
+			if (( k > 0 ) && ( field->keep & ( 1UL << ( k - 1 ))))
+				kept[runs - 1].x_max = r.x_max;		// Carries on the last run
+
+			else if ( runs < TEXT_KEPT )
+				kept[runs++] = r;
+
+			else									// No room
+			{
+				field->keep = 0;
+				runs = count;
+				break;
+			}
+		}
+
+		count = runs;
+	}
+
+
+/*
+ *	Clear everything else, a column at a time, going round the kept rectangles. Fields
+ *	don't overlap, so neither do the rectangles; in order from the top, there's a gap
+ *	above each one to clear.
+ */
+
+	for ( k = 1; k < count; k++ )					// Put them in order of "y_min"
+	{
+		r = kept[k];
+
+		for ( j = k; j > 0 && kept[j - 1].y_min > r.y_min; j-- )
+			kept[j] = kept[j - 1];
+
+		kept[j] = r;
+	}
+
+	for ( x = 0; x < Nx; x++ )
+	{
+		p = GRAM65k + x * Ny;
+		y = 0;
+
+		for ( k = 0; k < count; k++ )
+		{
+			if ( x < kept[k].x_min || x > kept[k].x_max )
+				continue;
+
+			while ( y < kept[k].y_min )
+				p[y++] = c65k;
+
+			y = kept[k].y_max + 1;
+		}
+
+		while ( y < Ny )
+			p[y++] = c65k;
+	}
+
+	AddDamage ( 0, 0, Nx - 1, Ny - 1, color );	// Same as "BoxFill()"
+
+
+/*
+ *	This is what will be in this copy once the fields have been painted:
+ */
+
+	for ( field = fields; field; field = field->next )
+		field->shown[scr] = field->now;
+
+	memcpy ( screens[scr].block, block, sizeof ( block ));
+	screens[scr].blocks = blocks;
+
+	blocks = 0;
+	textFrame++;
+}
+
+
+/*
+ *	"TextPaint()" paints the characters in a field that "TextClear()" didn't keep. If
+ *	none were kept, it's just "disp_str12()", etc.
+ */
+
+void TextPaint ( text_field* field )
+{
+	text_look*	now = &field->now;
+	int			k;
+	int			x = now->x;
+
+	if ( !now->size )								// Not on this screen
+		return;
+
+	if ( field->keep == 0 )
+	{
+		if ( now->size == 8 )	disp_str8  ( now->str, now->x, now->y, now->color );
+		if ( now->size == 12 )	disp_str12 ( now->str, now->x, now->y, now->color );
+		if ( now->size == 16 )	disp_str16 ( now->str, now->x, now->y, now->color );
+		if ( now->size == 20 )	disp_str20 ( now->str, now->x, now->y, now->color );
+
+		textPainted += strlen ( now->str );
+		return;
+	}
+
+	for ( k = 0; now->str[k]; k++ )
+	{
+		if ( field->keep & ( 1UL << k ))
+			textKept++;
+
+		else
+		{
+			if ( now->size == 8 )	disp_chr8  ( now->str[k], x, now->y, now->color );
+			if ( now->size == 12 )	disp_chr12 ( now->str[k], x, now->y, now->color );
+			if ( now->size == 16 )	disp_chr16 ( now->str[k], x, now->y, now->color );
+			if ( now->size == 20 )	disp_chr20 ( now->str[k], x, now->y, now->color );
+
+			textPainted++;
+		}
+
+		x += CellWidth ( now->size, now->str[k] );
+	}
+
+	AddDamage ( now->x, now->y, now->x_max, now->y + now->size - 1,
+				DamageSig ( now->str, now->color ^ ( now->size << 24 )));
+}
+
+
+/*
+ *	"TextForget()" is for when something other than "PaintScreen()" has painted the
+ *	screen images; nothing is kept the next time each one is painted.
+ */
+
+void TextForget ( void )
+{
+	text_field*	field;
+
+	screens[0].image = NULL;
+	screens[1].image = NULL;
+
+	for ( field = fields; field; field = field->next )
+	{
+		field->shown[0].size = 0;
+		field->shown[1].size = 0;
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ *	"text.h"
+ *
+ *	"text.h" contains the definitions and function prototypes for the "text.cpp"
+ *	module, which keeps the frequencies and indicators on the screen from one screen
+ *	to the next and only paints the characters that changed.
+ */
+
+#ifndef _TEXT_H_
+#define _TEXT_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "TEXT_RETAIN"
+
+
+#define	TEXT_LEN		24				// Longest string in a field (with the 0)
+#define	TEXT_BLOCKS		 4				// Other things that can change, per screen
+#define	TEXT_KEPT		32				// Runs of characters kept, per screen
+
+
+/*
+ *	What a field looks like on one screen. "size" is the font ( 8, 12, 16 or 20); it's
+ *	0 if the field isn't on the screen at all.
+ */
+
+struct text_look
+{
+	char		str[TEXT_LEN];			// What it says
+	int16_t		x, y;					// Top left corner
+	int16_t		x_max;					// Right edge (including the space at the end)
+	uint8_t		size;					// Font
+	uint32_t	color;
+};
+
+
+/*
+ *	A field is one string that's painted in the same place every time, like the
+ *	VFO-A frequency. "text" is for building the string in; "TextChanged()" says
+ *	whether it needs to be built again.
+ */
+
+struct text_field
+{
+	char		text[TEXT_LEN];			// For the caller to build the string in
+	uint32_t	key;					// What "text" was built from
+	bool		keyed;					// "key" has been set
+
+	text_look	now;					// This screen
+	text_look	shown[2];				// What's in each copy of the screen image
+	uint32_t	keep;					// Characters in "now" that are already there
+	uint32_t	frame;					// Screen "now" was set for
+	text_field*	next;					// All the fields that have been used
+};
+
+
+/*
+ *	Function prototypes:
+ */
+
+bool TextChanged ( text_field*, uint32_t );					// Does "text" need building?
+void TextField   ( text_field*, const char*, int, int, int, uint32_t );	// Set a field
+void TextBlock   ( int, int, int, int );					// Something else changes here
+void TextClear   ( uint32_t );								// Clear the screen around the text
+void TextPaint   ( text_field* );							// Paint what changed in a field
+void TextForget  ( void );									// Nothing is on the screen
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ *	"trace.cpp"
+ *
+ *	"trace.cpp" records everything that comes in from the frequency and clarifier
+ *	encoders, the PTT line and CAT control, with the time it happened, so that the
+ *	same operating session can be played back into the host build of the program
+ *	(see "Host/trace_replay.cpp") as many times as needed, to see what a change to
+ *	the program does to it.
+ *
+ *	"PutEvent()" records the encoder steps and PTT changes with the same time stamps
+ *	it puts in the event queue. The CAT library reads the serial port itself, so we
+ *	can't see the bytes it gets; instead "CheckCAT()" records the VFO-A and VFO-B
+ *	frequencies, mode, transmit and split status each time the library says something
+ *	changed, and the host program turns them back into CAT messages.
+ *
+ *	The recording goes into "TRACE_SIZE" slots in the PSRAM and stops when they are
+ *	full, so it always starts with the settings CAT control had when it was started
+ *	and the host program can put the radio in the same state. "TraceDump()" prints it
+ *	in text on "Serial":
+ *
+ *		#TRACE <count> <missed>
+ *		<us> <type> <value>				One line for each thing recorded
+ *		#END <frequency>				"rxFreq" when it was printed
+ *
+ *	The interrupt handlers and "loop()" (which calls "CheckCAT()") all run on core #1,
+ *	but "loop()" can be interrupted in the middle of recording something, so each
+ *	slot is claimed with an atomic add before it's filled in.
+ */
+
+#include <Arduino.h>						// General Arduino definitions
+#include "config.h"							// User customization stuff
+#include "trace.h"							// Our function prototypes
+
+static trace_rec*	recs    = NULL;			// The recording (in PSRAM)
+static uint32_t		used    = 0;			// Slots claimed (can go past TRACE_SIZE)
+static uint32_t		startUs = 0;			// "micros()" when it was started
+static bool			running = false;
+
+
+/*
+ *	"TraceBegin()" throws away anything recorded and starts again.
+ */
+
+void TraceBegin ( void )
+{
+	if ( recs == NULL )
+		recs = (trace_rec*) ps_calloc ( TRACE_SIZE, sizeof ( trace_rec ));
+
+	startUs = micros ();
+	used    = 0;
+	running = ( recs != NULL );
+}
+
+
+/*
+ *	"TraceRecord()" records one thing; "us" is the "micros()" time it happened.
+ */
+
+IRAM_ATTR void TraceRecord ( char type, int32_t value, uint32_t us )
+{
+	if ( !running )
+		return;
+
+	uint32_t	slot = __atomic_fetch_add ( &used, 1, __ATOMIC_RELAXED );
+
+	if ( slot >= TRACE_SIZE )				// Full
+		return;
+
+	recs[slot].us    = us - startUs;
+	recs[slot].value = value;
+	recs[slot].type  = type;
+}
+
+
+/*
+ *	"TraceCAT()" records all the settings CAT control looks after at once.
+ */
+
+void TraceCAT ( uint32_t fa, uint32_t fb, uint8_t mode, uint8_t tx, bool split )
+{
+	uint32_t	us = micros ();
+
+	TraceRecord ( TR_FA,    fa,    us );
+	TraceRecord ( TR_FB,    fb,    us );
+	TraceRecord ( TR_MODE,  mode,  us );
+	TraceRecord ( TR_TX,    tx,    us );
+	TraceRecord ( TR_SPLIT, split, us );
+}
+
+
+/*
+ *	"TraceDump()" stops the recording and prints it. "freq" is the current receive
+ *	frequency, which the host program checks it ends up on too. This takes a good
+ *	while at 115200 baud with a full recording, and nothing gets painted meanwhile!
+ */
+
+void TraceDump ( uint32_t freq )
+{
+	running = false;
+
+	uint32_t	count  = min ( used, (uint32_t) TRACE_SIZE );
+	uint32_t	missed = used - count;
+
+	Serial.printf ( "#TRACE %u %u\n", count, missed );
+
+	for ( uint32_t ix = 0; ix < count; ix++ )
+		Serial.printf ( "%u %c %d\n", recs[ix].us, recs[ix].type, recs[ix].value );
+
+	Serial.printf ( "#END %u\n", freq );
+}
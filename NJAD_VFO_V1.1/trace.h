@@ -0,0 +1,53 @@
+/*
+ *	"trace.h"
+ *
+ *	"trace.h" contains the definitions and function prototypes for the "trace.cpp"
+ *	module, which records what the encoders, the PTT line and CAT control do so it
+ *	can be played back in the host build.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <Arduino.h>					// General Arduino definitions
+#include "config.h"						// For "TRACE_SIZE"
+
+
+/*
+ *	The kinds of things recorded. These are also what's printed for each one by
+ *	"TraceDump()":
+ */
+
+#define	TR_FREQ		'F'					// Frequency encoder step ("value" is +1 or -1)
+#define	TR_CLAR		'C'					// Clarifier encoder step ("value" is +1 or -1)
+#define	TR_PTT		'P'					// PTT line changed ("value" is the pin level)
+#define	TR_FA		'A'					// CAT VFO-A frequency
+#define	TR_FB		'B'					// CAT VFO-B frequency
+#define	TR_MODE		'M'					// CAT mode (the FT-891 mode number)
+#define	TR_TX		'T'					// CAT transmit status
+#define	TR_SPLIT	'S'					// CAT split status
+
+
+/*
+ *	One thing recorded:
+ */
+
+struct trace_rec
+{
+	uint32_t	us;						// "micros()" since the recording started
+	int32_t		value;
+	char		type;					// TR_FREQ, etc.
+};
+
+
+/*
+ *	Function prototypes:
+ */
+
+void TraceBegin ( void );								// Start a new recording
+void TraceRecord ( char type, int32_t value, uint32_t us );	// From the interrupt handlers
+void TraceCAT ( uint32_t fa, uint32_t fb, uint8_t mode,	// What CAT control has now
+				uint8_t tx, bool split );
+void TraceDump ( uint32_t freq );						// Print it on "Serial"
+
+#endif